@@ -128,10 +128,18 @@ double rand_range(double min, double max)
 /* generate a random value based on CDF distribution */
 //基于CDF产生一个value值，随机产生一个介于0-1的cdf值，然后找到其对应的value值。
 double gen_random_cdf(struct cdf_table *table)
+{
+    if (!table)
+        return 0;
+
+    return gen_cdf_value(table, rand_range(table->min_cdf, table->max_cdf));
+}
+
+/* map a cdf value x in [min_cdf, max_cdf] to its value */
+//由调用者提供cdf值（例如来自ns-3的随机流），返回其对应的value值
+double gen_cdf_value(struct cdf_table *table, double x)
 {
     int i = 0;
-    double x = rand_range(table->min_cdf, table->max_cdf);
-    /* printf("%f %f %f\n", x, table->min_cdf, table->max_cdf); */
 
     if (!table)
         return 0;
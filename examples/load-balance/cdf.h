@@ -40,4 +40,7 @@ double avg_cdf(struct cdf_table *table);
 /* Generate a random value based on CDF distribution */
 double gen_random_cdf(struct cdf_table *table);
 
+/* Get the value whose CDF is x, x drawn by the caller from [min_cdf, max_cdf] */
+double gen_cdf_value(struct cdf_table *table, double x);
+
 #endif
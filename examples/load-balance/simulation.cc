@@ -13,6 +13,7 @@
 #include "ns3/ipv4-tlb.h"
 #include "ns3/ipv4-clove.h"
 #include "ns3/ipv4-tlb-probing.h"
+#include "ns3/ipv4-tor-probing.h"
 #include "ns3/link-monitor-module.h"
 #include "ns3/traffic-control-module.h"
 #include "ns3/tcp-resequence-buffer.h"
@@ -105,7 +106,7 @@ double START_TIME = 0.0;
 double END_TIME = 0.2;
 double FLOW_LAUNCH_END_TIME = 0.1;
 
-double smartTrans_thres[3][5][3] =  {
+static const uint64_t smartTrans_thres[3][5][3] =  {
                       {4983384, 11563497, 21365111, 
 7926412, 9241434, 16346272, 
 7237834, 8909791, 15038425, 
@@ -124,6 +125,12 @@ double smartTrans_thres[3][5][3] =  {
                             
 };
 
+//由smartTrans_thres与PIAS阀值建立的size rank策略，开始时建立一次，由所有应用共享
+Ptr<SizeRankPolicy> m_smartTransPolicy;
+Ptr<SizeRankPolicy> m_piasPolicy;
+//由应用直接报告流完成时间与丢包，可不依赖FlowMonitor
+Ptr<FlowCompletionCollector> m_fctCollector;
+
 struct FlowInfo
 {
     double time;
@@ -255,22 +262,6 @@ void RBTrace(void)
     Config::ConnectWithoutContext("/NodeList/*/$ns3::TcpL4Protocol/SocketList/*/ResequenceBufferPointer/Flush", MakeCallback(&RBTraceFlush));
 }
 
-// Port from Traffic Generator
-// Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
-double poission_gen_interval(double avg_rate)
-{
-    if (avg_rate > 0)
-        return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
-    else
-        return 0;
-}
-
-template <typename T>
-T rand_range(T min, T max)
-{
-    return min + ((double)max - min) * rand() / RAND_MAX;
-}
-
 std::string getStr(int value)
 {
     std::string s="";
@@ -319,18 +310,10 @@ void install_applications(int srcLeafId, NodeContainer servers, double requestRa
             sizeRank = 0;
             if(m_scheduler == 0)
             {
-                int inx_load = int(load*10)/2;
-                for(uint8_t i=2;i>=0;i--)
-                {
-                    if(flowSize >= smartTrans_thres[m_cdfType][inx_load][i]) 
-                    {
-                        sizeRank = i+1;
-                        break;
-                    }
-                }
+                sizeRank = m_smartTransPolicy->GetRank(flowSize);
             }
 
-            printf("%d %d %d %d\n",destServerIndex,port,flowSize,rtoRank);
+            NS_EVENT_TRACE("Simulation", "FlowInstalled", destServerIndex, port, flowSize, rtoRank);
             flowCount++;
             m_flows.push(FlowInfo(startTime, flowSize));
             totalFlowSize += flowSize;
@@ -357,6 +340,14 @@ void install_applications(int srcLeafId, NodeContainer servers, double requestRa
             source.SetAttribute("ReTxThre", UintegerValue(m_reTxThre));
             source.SetAttribute("CDFType", UintegerValue(m_cdfType));
             source.SetAttribute("Load", UintegerValue(uint32_t(load*10)));
+            if (m_piasPolicy)
+            {
+                source.SetAttribute("SizeRankPolicy", PointerValue(m_piasPolicy));
+            }
+            if (m_fctCollector)
+            {
+                source.SetAttribute("FlowCollector", PointerValue(m_fctCollector));
+            }
 
             // Install apps
             ApplicationContainer sourceApp = source.Install(servers.Get(srcServerIndex));
@@ -370,6 +361,10 @@ void install_applications(int srcLeafId, NodeContainer servers, double requestRa
             //如果使用GetAny()也可以，但是为了查找Sink这里必须使用地址。
             PacketSinkHelper sink("ns3::TcpSocketFactory",
                                   InetSocketAddress(destAddress,port));//Ipv4Address::GetAny(), port));
+            if (m_fctCollector)
+            {
+                sink.SetAttribute("FlowCollector", PointerValue(m_fctCollector));
+            }
             //给节点安装应用
             ApplicationContainer sinkApp = sink.Install(servers.Get(destServerIndex));
             sinkApp.Start(Seconds(START_TIME));
@@ -419,6 +414,7 @@ int main(int argc, char *argv[])
 
     uint32_t congaFlowletTimeout = 500;
     uint32_t letFlowFlowletTimeout = 500;
+    uint32_t flowletTableSize = 4096; // CONGA、LetFlow、Clove的flowlet表与TLB的acklet表的桶数
 
     bool resequenceBuffer = false;           //是否有buffer用来防止乱序，这个参数有效下面三个才有效
     uint32_t resequenceInOrderTimer = 5;    // MicroSeconds
@@ -438,6 +434,7 @@ int main(int argc, char *argv[])
     uint32_t TLBRunMode = 12;
     bool TLBProbingEnable = true;
     uint32_t TLBProbingInterval = 50;
+    bool torProbingEnable = false; // 每个叶结点只由一个服务器为整个机架探测
     bool TLBSmooth = true;
     bool TLBRerouting = true;
     uint32_t TLBDREMultiply = 3;
@@ -474,6 +471,22 @@ int main(int argc, char *argv[])
     bool tcpPause = false;
     uint32_t quantifyRTTBase = 10;
 
+    std::string schedulerType = "Auto";
+    std::string schedulerTraceFile = "";
+
+    bool virtualPayload = true; //Whether the TCP buffers only track sequence ranges of the dummy payload
+
+    std::string piasThresholdFile = ""; // PIAS阀值文件，为空时使用内置的阀值表
+    uint32_t piasCdfRanks = 0;          // 由流大小的CDF划分出的PIAS等级数，0时使用内置的阀值表
+    bool piasOptimize = false;          // 在预热期间收集流大小，在线求解PIAS阀值
+    double piasWarmup = 0.05;           // 预热期，单位为秒
+    std::string piasObjective = "Mean"; // 阀值最小化的目标: Mean或Tail
+    uint32_t piasBands = 8;             // PrioSubqueueDisc的子队列数，也是在线求解的等级数
+
+    bool enableFlowMonitor = true;      // 是否在所有节点上安装FlowMonitor并输出xml
+    bool enableFctCollector = false;    // 是否由应用直接统计流完成时间与丢包，输出-fct.txt
+    bool profile = false;               // 按事件类型统计墙钟时间，采样内存与待处理事件数
+
     CommandLine cmd;
     cmd.AddValue("ID", " Running ID", id);
     cmd.AddValue("StartTime", "Start time of the simulation", START_TIME);
@@ -518,6 +531,7 @@ int main(int argc, char *argv[])
     cmd.AddValue("TLBRunMode", "The running mode of TLB, 0 for minimize counter, 1 for minimize RTT, 2 for random, 11 for RTT counter, 12 for RTT DRE", TLBRunMode);
     cmd.AddValue("TLBProbingEnable", "Whether the TLB probing is enable", TLBProbingEnable);
     cmd.AddValue("TLBProbingInterval", "Probing interval for TLB probing", TLBProbingInterval);
+    cmd.AddValue("torProbingEnable", "Whether TLB or Clove probing is done once per ToR and shared by the servers under it", torProbingEnable);
     cmd.AddValue("TLBSmooth", "Whether the RTT calculation is smooth", TLBSmooth);
     cmd.AddValue("TLBRerouting", "Whether the rerouting is enabled in TLB", TLBRerouting);
     cmd.AddValue("TLBDREMultiply", "DRE multiply factor in TLB", TLBDREMultiply);
@@ -537,6 +551,7 @@ int main(int argc, char *argv[])
     cmd.AddValue("cloveDisToUncongestedPath", "Whether Clove will distribute the weight to uncongested path (no ECN) or all paths", cloveDisToUncongestedPath);
 
     cmd.AddValue("letFlowFlowletTimeout", "Flowlet timeout in LetFlow", letFlowFlowletTimeout);
+    cmd.AddValue("flowletTableSize", "Number of buckets in the Conga, LetFlow and Clove flowlet tables and the TLB acklet table", flowletTableSize);
 
     cmd.AddValue("enableRandomDrop", "Whether the Spine-0 to other leaves has the random drop problem", enableRandomDrop);
     cmd.AddValue("randomDropRate", "The random drop rate when the random drop is enabled", randomDropRate);
@@ -554,8 +569,48 @@ int main(int argc, char *argv[])
 
     cmd.AddValue("enableMFQ", "Whether enable the large cache in the spine switch", enableMFQ);
 
+    cmd.AddValue("schedulerType", "Event scheduler: Map, Heap, List, Calendar, AdaptiveCalendar or Auto", schedulerType);
+    cmd.AddValue("schedulerTraceFile", "Record the scheduler operations to this file for bench-simulator --replay, empty to disable", schedulerTraceFile);
+    cmd.AddValue("virtualPayload", "Whether the TCP buffers only track the sequence ranges of the dummy payload", virtualPayload);
+
+    cmd.AddValue("piasThresholdFile", "File holding the PIAS thresholds in bytes, empty for the built-in table", piasThresholdFile);
+    cmd.AddValue("piasCdfRanks", "Number of PIAS ranks derived from the flow-size CDF, 0 for the built-in table", piasCdfRanks);
+    cmd.AddValue("piasOptimize", "Whether the PIAS thresholds are solved from the flow sizes seen during the warm-up", piasOptimize);
+    cmd.AddValue("piasWarmup", "Warm-up before the PIAS thresholds are solved, in seconds", piasWarmup);
+    cmd.AddValue("piasObjective", "What the solved PIAS thresholds minimize: Mean or Tail FCT", piasObjective);
+    cmd.AddValue("piasBands", "Number of size rank sub-bands in the switch queues, and of solved PIAS ranks", piasBands);
+    cmd.AddValue("flowMonitor", "Whether FlowMonitor probes every node and writes the xml", enableFlowMonitor);
+    cmd.AddValue("fctCollector", "Whether the applications report the flow completion times and drops to a -fct.txt file", enableFctCollector);
+    cmd.AddValue("profile", "Whether the simulator reports the wall time per event type, the events per second and a memory timeline at the end", profile);
+
     cmd.Parse(argc, argv);
 
+    // 须在SetScheduler创建模拟器实现之前设置
+    if (profile)
+    {
+        Config::SetDefault("ns3::DefaultSimulatorImpl::Profile", BooleanValue(true));
+    }
+
+    // Auto: the std::map is fine for small fabrics, large fabrics keep
+    // millions of per-packet events pending within a few microseconds.
+    if (schedulerType.compare("Auto") == 0)
+    {
+        schedulerType = (LEAF_COUNT * PER_LEAF_SERVER_COUNT >= 32) ? "AdaptiveCalendar" : "Map";
+    }
+    ObjectFactory schedulerFactory;
+    if (schedulerTraceFile.empty())
+    {
+        schedulerFactory.SetTypeId("ns3::" + schedulerType + "Scheduler");
+    }
+    else
+    {
+        schedulerFactory.SetTypeId("ns3::RecordingScheduler");
+        schedulerFactory.Set("Scheduler", StringValue("ns3::" + schedulerType + "Scheduler"));
+        schedulerFactory.Set("FileName", StringValue(schedulerTraceFile));
+    }
+    Simulator::SetScheduler(schedulerFactory);
+    NS_LOG_INFO("Event scheduler: " << schedulerType);
+
     uint64_t SPINE_LEAF_CAPACITY = spineLeafCapacity * LINK_CAPACITY_BASE;
     uint64_t LEAF_SERVER_CAPACITY = leafServerCapacity * LINK_CAPACITY_BASE;
     Time LINK_LATENCY = MicroSeconds(linkLatency);
@@ -717,6 +772,10 @@ int main(int argc, char *argv[])
     }
 
     NS_LOG_INFO("Config parameters");
+    Config::SetDefault("ns3::Ipv4CongaRouting::FlowletTableSize", UintegerValue(flowletTableSize));
+    Config::SetDefault("ns3::Ipv4LetFlowRouting::FlowletTableSize", UintegerValue(flowletTableSize));
+    Config::SetDefault("ns3::Ipv4Clove::FlowletTableSize", UintegerValue(flowletTableSize));
+    Config::SetDefault("ns3::Ipv4TLB::AckletTableSize", UintegerValue(flowletTableSize));
     Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(PACKET_SIZE));
     Config::SetDefault("ns3::TcpSocket::DelAckCount", UintegerValue(0));
     Config::SetDefault("ns3::TcpSocket::InitialCwnd", UintegerValue(10));
@@ -726,6 +785,8 @@ int main(int argc, char *argv[])
     Config::SetDefault("ns3::RttEstimator::InitialEstimation", TimeValue(MicroSeconds(80)));
     Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue(160000000));
     Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue(160000000));
+    Config::SetDefault("ns3::TcpTxBuffer::VirtualPayload", BooleanValue(virtualPayload));
+    Config::SetDefault("ns3::TcpRxBuffer::VirtualPayload", BooleanValue(virtualPayload));
     if (enableFastReConnection)
     {
         Config::SetDefault("ns3::TcpSocket::ConnTimeout", TimeValue(MicroSeconds(40)));
@@ -766,6 +827,7 @@ int main(int argc, char *argv[])
         Config::SetDefault("ns3::Ipv4TLB::ECNPortionLow", DoubleValue(TLBECNPortionLow));
         Config::SetDefault("ns3::Ipv4TLB::RunMode", UintegerValue(TLBRunMode));
         Config::SetDefault("ns3::Ipv4TLBProbing::ProbeInterval", TimeValue(MicroSeconds(TLBProbingInterval)));
+        Config::SetDefault("ns3::Ipv4TorProbing::ProbeInterval", TimeValue(MicroSeconds(TLBProbingInterval)));
         Config::SetDefault("ns3::Ipv4TLB::IsSmooth", BooleanValue(TLBSmooth));
         Config::SetDefault("ns3::Ipv4TLB::Rerouting", BooleanValue(TLBRerouting));
         Config::SetDefault("ns3::Ipv4TLB::DREMultiply", UintegerValue(TLBDREMultiply));
@@ -785,7 +847,15 @@ int main(int argc, char *argv[])
     }
 
     /*************************************************************************************************************************************/
-    
+
+    //随机数种子必须在创建任何随机变量之前设定，randomSeed作为ns-3的run编号
+    NS_LOG_INFO("Initialize random seed: " << randomSeed);
+    if (randomSeed == 0)
+    {
+        randomSeed = (unsigned)time(NULL);
+    }
+    RngSeedManager::SetRun(randomSeed);
+
     //创建节点
     NodeContainer spines;
     spines.Create(SPINE_COUNT);
@@ -1010,6 +1080,7 @@ int main(int argc, char *argv[])
         Config::SetDefault("ns3::PrioQueueDisc::CacheBand", UintegerValue(m_cacheBand));
         Config::SetDefault("ns3::PrioQueueDisc::MarkThre", DoubleValue(m_markThre));
         Config::SetDefault("ns3::PrioQueueDisc::Scheduler", UintegerValue(m_scheduler));
+        Config::SetDefault("ns3::PrioSubqueueDisc::Bands", UintegerValue(piasBands));
         m_reTxThre = 3;
         tc.SetRootQueueDisc("ns3::PrioQueueDisc");
         tc.AddPacketFilter(0, "ns3::PrioQueueDiscFilter");
@@ -1048,6 +1119,8 @@ int main(int argc, char *argv[])
 
     //用于TLB算法中，//TODO
     std::vector<Ptr<Ipv4TLBProbing>> probings(PER_LEAF_SERVER_COUNT * LEAF_COUNT);
+    //ToR级探测时每个叶结点的探测代理
+    std::vector<Ptr<Ipv4TorProbing>> torProbings(LEAF_COUNT);
 
     //配置所有叶结点与服务器的地址
     for (int i = 0; i < LEAF_COUNT; i++)
@@ -1172,6 +1245,9 @@ int main(int argc, char *argv[])
     /*************************************Added***********************************/
     // 存储非对称路径对
     std::set<std::pair<uint32_t, uint32_t>> asymLink; // set< (A, B) > Leaf A -> Spine B is asymmetric
+    //不对称链路的选择固定使用0号流，其余流编号在仿真开始前统一分配
+    Ptr<UniformRandomVariable> asymCapacityRand = CreateObject<UniformRandomVariable>();
+    asymCapacityRand->SetStream(0);
     //设置骨干结点与叶结点间的连接，不对称，随意丢包和包黑洞都在这里设置，也即都发生在core->leave之间
     for (int i = 0; i < LEAF_COUNT; i++)
     {
@@ -1208,7 +1284,7 @@ int main(int argc, char *argv[])
                 bool isAsymCapacity = false;
 
                 //如果指定了会不对称，即只有1/10的容量，则按指定的不对称概率来确定是否不对称
-                if (asymCapacity && static_cast<uint32_t>(rand() % 100) < asymCapacityPoss)
+                if (asymCapacity && asymCapacityRand->GetInteger(0, 99) < asymCapacityPoss)
                 {
                     isAsymCapacity = true;
                 }
@@ -1540,7 +1616,7 @@ int main(int argc, char *argv[])
             }
         }
 
-        if (runMode == TLB && TLBProbingEnable)
+        if (runMode == TLB && TLBProbingEnable && !torProbingEnable)
         {
             NS_LOG_INFO("Configuring TLB Probing");
             for (int i = 0; i < PER_LEAF_SERVER_COUNT * LEAF_COUNT; i++)
@@ -1580,6 +1656,50 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (torProbingEnable && ((runMode == TLB && TLBProbingEnable) || runMode == Clove))
+    {
+        NS_LOG_INFO("Configuring ToR probing");
+        //每个服务器都回复探测包
+        for (int i = 0; i < PER_LEAF_SERVER_COUNT * LEAF_COUNT; i++)
+        {
+            servers.Get(i)->AggregateObject(CreateObject<Ipv4TorProbing>());
+        }
+        for (int i = 0; i < LEAF_COUNT; i++)
+        {
+            //叶结点i下的第一个服务器为整个机架探测其它叶结点下的第一个服务器，结果分发给机架内所有服务器
+            int agentIndex = i * PER_LEAF_SERVER_COUNT;
+            Ptr<Ipv4TorProbing> torProbing = servers.Get(agentIndex)->GetObject<Ipv4TorProbing>();
+            torProbings[i] = torProbing;
+            torProbing->SetSourceAddress(serverAddresses[agentIndex]);
+            for (int j = agentIndex; j < agentIndex + PER_LEAF_SERVER_COUNT; j++)
+            {
+                if (runMode == TLB)
+                {
+                    torProbing->AddConsumer(servers.Get(j)->GetObject<Ipv4TLB>());
+                }
+                else
+                {
+                    torProbing->AddConsumer(servers.Get(j)->GetObject<Ipv4Clove>());
+                }
+            }
+            for (int k = 0; k < SPINE_COUNT; k++)
+            {
+                int path = leafToSpinePath[std::make_pair(i, k)];
+                for (int l = 0; l < LEAF_COUNT; l++)
+                {
+                    if (i == l)
+                    {
+                        continue;
+                    }
+                    int newPath = spineToLeafPath[std::make_pair(k, l)] * 100 + path;
+                    torProbing->AddPath(serverAddresses[l * PER_LEAF_SERVER_COUNT], newPath);
+                }
+            }
+            torProbing->StartProbe();
+            torProbing->StopProbe(Seconds(END_TIME));
+        }
+    }
+
     /*************************************************************************************************************************************/
 
     //求得oversubRatio之
@@ -1595,14 +1715,62 @@ int main(int argc, char *argv[])
     double requestRate = load * LEAF_SERVER_CAPACITY * PER_LEAF_SERVER_COUNT / oversubRatio / (8 * avg_cdf(cdfTable)) / PER_LEAF_SERVER_COUNT;
     NS_LOG_INFO("Average request rate: " << requestRate << "Byte per second");//*/
 
-    NS_LOG_INFO("Initialize random seed: " << randomSeed);
-    if (randomSeed == 0)
+    NS_LOG_INFO("Create size rank policies");
+    //只有NTcp按smartTrans的阀值划分size rank
+    if (m_scheduler == 0)
     {
-        srand((unsigned)time(NULL));
+        int smartTransLoad = int(load*10)/2;
+        const uint64_t *smartTransThresholds = smartTrans_thres[m_cdfType][smartTransLoad];
+        m_smartTransPolicy = CreateObject<SizeRankPolicy>();
+        m_smartTransPolicy->SetThresholds(std::vector<uint64_t>(smartTransThresholds, smartTransThresholds + 3));
     }
-    else
+    if (!piasThresholdFile.empty())
+    {
+        m_piasPolicy = CreateObject<SizeRankPolicy>();
+        if (!m_piasPolicy->LoadThresholds(piasThresholdFile))
+        {
+            std::cout << "Error open file: " << piasThresholdFile << '\n';
+            return 0;
+        }
+    }
+    else if (piasCdfRanks > 0)
+    {
+        std::vector<std::pair<double, double> > cdf;
+        for (int i = 0; i < cdfTable->num_entry; i++)
+        {
+            cdf.push_back(std::make_pair(cdfTable->entries[i].value, cdfTable->entries[i].cdf));
+        }
+        m_piasPolicy = CreateObject<SizeRankPolicy>();
+        m_piasPolicy->DeriveFromCdf(cdf, piasCdfRanks);
+    }
+
+    Ptr<PiasThresholdOptimizer> piasOptimizer;
+    if (piasOptimize)
     {
-        srand(randomSeed);
+        // 预热期间先使用CDF的等概率划分
+        if (!m_piasPolicy)
+        {
+            std::vector<std::pair<double, double> > cdf;
+            for (int i = 0; i < cdfTable->num_entry; i++)
+            {
+                cdf.push_back(std::make_pair(cdfTable->entries[i].value, cdfTable->entries[i].cdf));
+            }
+            m_piasPolicy = CreateObject<SizeRankPolicy>();
+            m_piasPolicy->DeriveFromCdf(cdf, piasBands);
+        }
+        piasOptimizer = CreateObject<PiasThresholdOptimizer>();
+        piasOptimizer->SetAttribute("WarmupTime", TimeValue(Seconds(piasWarmup)));
+        piasOptimizer->SetAttribute("Ranks", UintegerValue(piasBands));
+        piasOptimizer->SetAttribute("Load", DoubleValue(load));
+        piasOptimizer->SetAttribute("Objective", StringValue(piasObjective));
+        piasOptimizer->AddPolicy(m_piasPolicy);
+        piasOptimizer->Start();
+    }
+
+    if (enableFctCollector)
+    {
+        m_fctCollector = CreateObject<FlowCompletionCollector>();
+        m_fctCollector->ConnectQueueDiscDrops();
     }
 
     NS_LOG_INFO("Create applications");
@@ -1628,17 +1796,19 @@ int main(int argc, char *argv[])
             FlowInfo fi=m_flows.top();
             m_flows.pop();
             int packetNum=ceil(fi.flowsize/1400.0)+3;
-            printf("Flow size %8d %8d %8.4lf\n",fi.flowsize,packetNum,fi.time);
+            NS_EVENT_TRACE("Simulation", "FlowSize", fi.flowsize, packetNum, static_cast<uint32_t>(fi.time * 1e6));
         }//*/
     }
 
-    NS_LOG_INFO("Enabling flow monitor");
-
     //FlowMonitor用于在仿真期间监视流
     Ptr<FlowMonitor> flowMonitor;
     FlowMonitorHelper flowHelper;
-    // 在所有节点上开启流监控
-    flowMonitor = flowHelper.InstallAll();
+    if (enableFlowMonitor)
+    {
+        NS_LOG_INFO("Enabling flow monitor");
+        // 在所有节点上开启流监控
+        flowMonitor = flowHelper.InstallAll();
+    }
 
     NS_LOG_INFO("Enabling link monitor");
 
@@ -1668,7 +1838,10 @@ int main(int argc, char *argv[])
     linkMonitor->Start(Seconds(START_TIME));
     linkMonitor->Stop(Seconds(END_TIME));
 
-    flowMonitor->CheckForLostPackets();
+    if (flowMonitor)
+    {
+        flowMonitor->CheckForLostPackets();
+    }
 
     /*************************************************************************************************************************************/
     //设置输出的文件名称，第一个是runningID,
@@ -1832,27 +2005,90 @@ int main(int argc, char *argv[])
         Simulator::Schedule(Seconds(START_TIME) + MicroSeconds(1), &RBTrace);
     }
 
+    //为所有负载均衡器与探测器分配固定的随机流，使相同randomSeed下的结果可复现
+    int64_t stream = 1;
+    stream += internet.AssignStreams(spines, stream);
+    stream += internet.AssignStreams(leaves, stream);
+    stream += internet.AssignStreams(servers, stream);
+    if (runMode == CONGA || runMode == CONGA_FLOW || runMode == CONGA_ECMP)
+    {
+        stream += congaRoutingHelper.AssignStreams(spines, stream);
+        stream += congaRoutingHelper.AssignStreams(leaves, stream);
+    }
+    else if (runMode == PRESTO || runMode == DRB || runMode == WEIGHTED_PRESTO)
+    {
+        stream += drbRoutingHelper.AssignStreams(servers, stream);
+    }
+    else if (runMode == DRILL)
+    {
+        stream += drillRoutingHelper.AssignStreams(spines, stream);
+        stream += drillRoutingHelper.AssignStreams(leaves, stream);
+    }
+    else if (runMode == LetFlow)
+    {
+        stream += letFlowRoutingHelper.AssignStreams(spines, stream);
+        stream += letFlowRoutingHelper.AssignStreams(leaves, stream);
+    }
+    for (uint32_t i = 0; i < probings.size(); i++)
+    {
+        if (probings[i] != 0)
+        {
+            stream += probings[i]->AssignStreams(stream);
+        }
+    }
+    for (uint32_t i = 0; i < torProbings.size(); i++)
+    {
+        if (torProbings[i] != 0)
+        {
+            stream += torProbings[i]->AssignStreams(stream);
+        }
+    }
+
     NS_LOG_INFO("Start simulation");
     Simulator::Stop(Seconds(END_TIME));
     Simulator::Run();
 
+    Ptr<DefaultSimulatorImpl> simImpl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    if (simImpl)
+    {
+        NS_LOG_INFO("Events pending: " << simImpl->GetPendingEventCount()
+                                       << ", live: " << simImpl->GetLiveEventCount()
+                                       << ", cancelled: " << simImpl->GetCancelledEventCount()
+                                       << ", compactions: " << simImpl->GetCompactionCount());
+    }
+
     //输出内容至设定好文件名称中
-    flowMonitor->SerializeToXmlFile(flowMonitorFilename.str(), true, true);
     linkMonitor->OutputToFile(linkMonitorFilename.str(), &LinkMonitor::DefaultFormat);
-    int flowIdSize = (flowMonitor->GetFlowStats()).size();
-    if (flowCount != flowIdSize)
+    if (m_fctCollector)
     {
-        printf("统计数与设置数不符\n");
+        // 与xml同名，以-fct.txt结尾
+        std::string fctFilename = flowMonitorFilename.str();
+        fctFilename.replace(fctFilename.size() - 4, 4, "-fct.txt");
+        m_fctCollector->OutputToFile(fctFilename);
+        NS_LOG_INFO("Completed flows: " << m_fctCollector->GetNCompletedFlows() << " of " << m_fctCollector->GetNFlows());
+    }
+    if (flowMonitor)
+    {
+        flowMonitor->SerializeToXmlFile(flowMonitorFilename.str(), true, true);
+        int flowIdSize = (flowMonitor->GetFlowStats()).size();
+        if (flowCount != flowIdSize)
+        {
+            printf("统计数与设置数不符\n");
+        }
+        std::stringstream doubleToStr;
+        doubleToStr << "./xml " << flowMonitorFilename.str().c_str() << " " << load << " " << id << " ";
+        if (transportProt == "Tcp")
+            doubleToStr << 0;
+        else
+            doubleToStr << 1;
+        system(doubleToStr.str().c_str());
     }
-    std::stringstream doubleToStr;
-    doubleToStr << "./xml " << flowMonitorFilename.str().c_str() << " " << load << " " << id << " ";
-    if (transportProt == "Tcp")
-        doubleToStr << 0;
-    else
-        doubleToStr << 1;
-    system(doubleToStr.str().c_str());
 
     Simulator::Destroy();
     free_cdf(cdfTable);
+    m_smartTransPolicy = 0;
+    m_piasPolicy = 0;
+    m_fctCollector = 0;
     NS_LOG_INFO("Stop simulation");
 }
@@ -32,6 +32,11 @@
 #include "bulk-send-application.h"
 
 #include "ns3/rto-pri-tag.h"
+#include "ns3/size-rank-policy.h"
+#include "flow-completion-collector.h"
+#include "flow-completion-tag.h"
+#include "ns3/pointer.h"
+#include "ns3/abort.h"
 #include "ns3/tcp-socket-base.h"
 
 namespace ns3
@@ -41,6 +46,44 @@ NS_LOG_COMPONENT_DEFINE("BulkSendApplication");
 
 NS_OBJECT_ENSURE_REGISTERED(BulkSendApplication);
 
+// Built-in PIAS thresholds, [CDFType][Load - 1][threshold], used when no
+// SizeRankPolicy is given
+//1314000, 1898000, 2336000 , 2628000, 2920000, 3212000, 3358000,
+//2e4, 5e4, 8e4, 2e5, 1e6, 2e6, 5e6,
+//1175300, 1606000, 2117000, 17762360, 18980000, 30952000, 37960000
+
+// uniform seed: 1575299868
+//                           0.5       0.6       0.7        0.8        0.9
+static const uint64_t g_piasThresholds[3][9][7] = {
+                        {1059*1460, 1412*1460, 1643*1460, 1869*1460, 2008*1460, 2115*1460, 2184*1460, 
+                          956*1460, 1381*1460, 1718*1460, 2028*1460, 2297*1460, 2551*1460, 2660*1460, 
+                          999*1460, 1305*1460, 1564*1460, 1763*1460, 1956*1460, 2149*1460, 2309*1460, 
+                          909*1460, 1329*1460, 1648*1460, 1960*1460, 2143*1460, 2337*1460, 2484*1460, 
+                          1059*1460, 1412*1460, 1643*1460, 1869*1460, 2008*1460, 2115*1460, 2184*1460, 
+                          956*1460, 1381*1460, 1718*1460, 2028*1460, 2297*1460, 2551*1460, 2660*1460, 
+                          999*1460, 1305*1460, 1564*1460, 1763*1460, 1956*1460, 2149*1460, 2309*1460, 
+                          909*1460, 1329*1460, 1648*1460, 1960*1460, 2143*1460, 2337*1460, 2484*1460, 
+                          759*1460, 1132*1460, 1456*1460, 1737*1460, 2010*1460, 2199*1460, 2325*1460}, 
+                        {805*1460, 1106*1460, 1401*1460, 10693*1460, 11970*1460, 21162*1460, 22272*1460, 
+                          840*1460, 1232*1460, 1617*1460, 11950*1460, 12238*1460, 21494*1460, 25720*1460, 
+                          907*1460, 1301*1460, 1619*1460, 12166*1460, 12915*1460, 21313*1460, 26374*1460, 
+                          745*1460, 1083*1460, 1391*1460, 13689*1460, 14936*1460, 21149*1460, 27245*1460, 
+                          805*1460, 1106*1460, 1401*1460, 10693*1460, 11970*1460, 21162*1460, 22272*1460, 
+                          840*1460, 1232*1460, 1617*1460, 11950*1460, 12238*1460, 21494*1460, 25720*1460, 
+                          907*1460, 1301*1460, 1619*1460, 12166*1460, 12915*1460, 21313*1460, 26374*1460, 
+                          745*1460, 1083*1460, 1391*1460, 13689*1460, 14936*1460, 21149*1460, 27245*1460, 
+                          750*1460, 1083*1460, 1416*1460, 13705*1460, 14952*1460, 21125*1460, 28253*1460}, 
+                        {347*1460, 2860*1460, 3662*1460, 5450*1460, 6820*1460, 6820*1460, 6850*1460, 
+                          1420*1460, 3117*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
+                          1246*1460, 3632*1460, 5869*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
+                          2234*1460, 3417*1460, 4886*1460, 5857*1460, 5857*1460, 6850*1460, 6850*1460, 
+                          347*1460, 2860*1460, 3662*1460, 5450*1460, 6820*1460, 6820*1460, 6850*1460, 
+                          1420*1460, 3117*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
+                          1246*1460, 3632*1460, 5869*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
+                          2234*1460, 3417*1460, 4886*1460, 5857*1460, 5857*1460, 6850*1460, 6850*1460, 
+                          3243*1460, 4527*1460, 6239*1460, 6239*1460, 6239*1460, 6850*1460, 6850*1460} //uniform seed: 1575299868
+};
+
 TypeId
 BulkSendApplication::GetTypeId(void)
 {
@@ -120,7 +163,19 @@ BulkSendApplication::GetTypeId(void)
                           .AddAttribute("Load", "LOAD",
                                         UintegerValue(1),
                                         MakeUintegerAccessor(&BulkSendApplication::m_load),
-                                        MakeUintegerChecker<uint32_t>());
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("SizeRankPolicy",
+                                        "The PIAS thresholds shared by the senders, "
+                                        "null for the built-in table of CDFType and Load",
+                                        PointerValue(),
+                                        MakePointerAccessor(&BulkSendApplication::m_sizeRankPolicy),
+                                        MakePointerChecker<SizeRankPolicy>())
+                          .AddAttribute("FlowCollector",
+                                        "The collector the flow is registered with for its completion time "
+                                        "and drops, null for none",
+                                        PointerValue(),
+                                        MakePointerAccessor(&BulkSendApplication::m_flowCollector),
+                                        MakePointerChecker<FlowCompletionCollector>());
   return tid;
 }
 
@@ -136,7 +191,10 @@ BulkSendApplication::BulkSendApplication()
       m_sizeRank(0),
       m_cacheBand(2),
       m_reTxThre(1000),
-      m_load(1)
+      m_load(1),
+      m_nextRankBytes(0),
+      m_rankGeneration(0),
+      m_flowId(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -164,6 +222,8 @@ void BulkSendApplication::DoDispose(void)
   NS_LOG_FUNCTION(this);
 
   m_socket = 0;
+  m_sizeRankPolicy = 0;
+  m_flowCollector = 0;
   // chain up
   Application::DoDispose();
 }
@@ -173,10 +233,25 @@ void BulkSendApplication::StartApplication(void) // Called at time specified by
 {
   NS_LOG_FUNCTION(this);
 
+  //PIAS的阀值只在开始时准备一次
+  if (m_enableSizeRank && m_scheduler == 1 && !m_sizeRankPolicy)
+  {
+    NS_ABORT_MSG_IF(m_cdfType >= 3 || m_load < 1 || m_load > 9,
+                    "No built-in PIAS thresholds for CDFType " << m_cdfType << " and Load " << m_load);
+    const uint64_t *thresholds = g_piasThresholds[m_cdfType][m_load - 1];
+    m_sizeRankPolicy = CreateObject<SizeRankPolicy>();
+    m_sizeRankPolicy->SetThresholds(std::vector<uint64_t>(thresholds, thresholds + 7));
+  }
+
   // Create the socket if not already
   //如果不存在则创建Socket
   if (!m_socket)
   {
+    //向策略报告流的大小，供在线阀值优化使用
+    if (m_sizeRankPolicy && m_maxBytes > 0)
+    {
+      m_sizeRankPolicy->NotifyFlowSize(m_maxBytes);
+    }
     m_socket = Socket::CreateSocket(GetNode(), m_tid);
     /*********************************************************************************/
     if (m_scheduler == 0 && m_enableRTORank)
@@ -211,6 +286,13 @@ void BulkSendApplication::StartApplication(void) // Called at time specified by
     }
 
     m_socket->Connect(m_peer);
+    //连接后本端地址已确定，以两端地址登记流，接收端接受连接时据此找到流
+    if (m_flowCollector)
+    {
+      Address local;
+      m_socket->GetSockName(local);
+      m_flowId = m_flowCollector->StartFlow(local, m_peer, m_maxBytes);
+    }
     //关闭接收数据
     m_socket->ShutdownRecv();
     //分别设置成功连接与连接失败时的调用
@@ -251,42 +333,6 @@ void BulkSendApplication::StopApplication(void) // Called at time specified by S
 void BulkSendApplication::SendData(void)
 {
   NS_LOG_FUNCTION(this);
-  //1314000, 1898000, 2336000 , 2628000, 2920000, 3212000, 3358000,
-  //2e4, 5e4, 8e4, 2e5, 1e6, 2e6, 5e6,
-  //1175300, 1606000, 2117000, 17762360, 18980000, 30952000, 37960000
-
-  // uniform seed: 1575299868
-  //                           0.5       0.6       0.7        0.8        0.9
-  double pias_thresh[3][9][7] = {
-                        {1059*1460, 1412*1460, 1643*1460, 1869*1460, 2008*1460, 2115*1460, 2184*1460, 
-                          956*1460, 1381*1460, 1718*1460, 2028*1460, 2297*1460, 2551*1460, 2660*1460, 
-                          999*1460, 1305*1460, 1564*1460, 1763*1460, 1956*1460, 2149*1460, 2309*1460, 
-                          909*1460, 1329*1460, 1648*1460, 1960*1460, 2143*1460, 2337*1460, 2484*1460, 
-                          1059*1460, 1412*1460, 1643*1460, 1869*1460, 2008*1460, 2115*1460, 2184*1460, 
-                          956*1460, 1381*1460, 1718*1460, 2028*1460, 2297*1460, 2551*1460, 2660*1460, 
-                          999*1460, 1305*1460, 1564*1460, 1763*1460, 1956*1460, 2149*1460, 2309*1460, 
-                          909*1460, 1329*1460, 1648*1460, 1960*1460, 2143*1460, 2337*1460, 2484*1460, 
-                          759*1460, 1132*1460, 1456*1460, 1737*1460, 2010*1460, 2199*1460, 2325*1460}, 
-                        {805*1460, 1106*1460, 1401*1460, 10693*1460, 11970*1460, 21162*1460, 22272*1460, 
-                          840*1460, 1232*1460, 1617*1460, 11950*1460, 12238*1460, 21494*1460, 25720*1460, 
-                          907*1460, 1301*1460, 1619*1460, 12166*1460, 12915*1460, 21313*1460, 26374*1460, 
-                          745*1460, 1083*1460, 1391*1460, 13689*1460, 14936*1460, 21149*1460, 27245*1460, 
-                          805*1460, 1106*1460, 1401*1460, 10693*1460, 11970*1460, 21162*1460, 22272*1460, 
-                          840*1460, 1232*1460, 1617*1460, 11950*1460, 12238*1460, 21494*1460, 25720*1460, 
-                          907*1460, 1301*1460, 1619*1460, 12166*1460, 12915*1460, 21313*1460, 26374*1460, 
-                          745*1460, 1083*1460, 1391*1460, 13689*1460, 14936*1460, 21149*1460, 27245*1460, 
-                          750*1460, 1083*1460, 1416*1460, 13705*1460, 14952*1460, 21125*1460, 28253*1460}, 
-                        {347*1460, 2860*1460, 3662*1460, 5450*1460, 6820*1460, 6820*1460, 6850*1460, 
-                          1420*1460, 3117*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
-                          1246*1460, 3632*1460, 5869*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
-                          2234*1460, 3417*1460, 4886*1460, 5857*1460, 5857*1460, 6850*1460, 6850*1460, 
-                          347*1460, 2860*1460, 3662*1460, 5450*1460, 6820*1460, 6820*1460, 6850*1460, 
-                          1420*1460, 3117*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
-                          1246*1460, 3632*1460, 5869*1460, 6850*1460, 6850*1460, 6850*1460, 6850*1460, 
-                          2234*1460, 3417*1460, 4886*1460, 5857*1460, 5857*1460, 6850*1460, 6850*1460, 
-                          3243*1460, 4527*1460, 6239*1460, 6239*1460, 6239*1460, 6850*1460, 6850*1460} //uniform seed: 1575299868
-                            
-  };
 
   //如果允许一直发送或还没达到最大的发送量，则继续发送。
   while (m_maxBytes == 0 || m_totBytes < m_maxBytes)
@@ -312,21 +358,13 @@ void BulkSendApplication::SendData(void)
     //回调
     m_txTrace(packet);
     /*********************************************************************************/
-    int inx = m_cdfType;
-    if (m_enableSizeRank)
+    //发送字节数越过下一个阀值或阀值被更新时才重新计算size rank
+    if (m_enableSizeRank && m_scheduler == 1
+        && (m_totBytes >= m_nextRankBytes || m_rankGeneration != m_sizeRankPolicy->GetGeneration()))
     {
-      if(m_scheduler == 1)
-      {
-        for(uint8_t i = 6;i>=0;i--)
-        {
-          if(m_totBytes >= pias_thresh[inx][m_load-1][i])
-          {
-            m_sizeRank = i+1;
-            break;
-          }
-          if(i==0) m_sizeRank = 0;
-        }
-      }
+      m_sizeRank = m_sizeRankPolicy->GetRank(m_totBytes);
+      m_nextRankBytes = m_sizeRankPolicy->GetNextThreshold(m_totBytes);
+      m_rankGeneration = m_sizeRankPolicy->GetGeneration();
     }
     if (m_enableRTORank || m_enableSizeRank)
     {
@@ -334,6 +372,11 @@ void BulkSendApplication::SendData(void)
       RtoPriTag rtoPriTag(m_rtoRank, m_sizeRank);
       packet->AddPacketTag(rtoPriTag);
     }
+    //与RtoPriTag一样用包标签，虚拟负载的发送缓存只保留包标签，分段与重传都会带上
+    if (m_flowCollector)
+    {
+      packet->AddPacketTag(FlowCompletionTag(m_flowId));
+    }
     /*********************************************************************************/
     //返回发送包的字节数
     int actual = m_socket->Send(packet);
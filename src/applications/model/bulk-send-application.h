@@ -31,6 +31,8 @@ namespace ns3 {
 
 class Address;
 class Socket;
+class SizeRankPolicy;
+class FlowCompletionCollector;
 
 /**
  * \ingroup applications
@@ -140,6 +142,11 @@ private:
   uint32_t        m_reTxThre;
   uint32_t        m_cdfType;
   uint32_t        m_load;
+  Ptr<SizeRankPolicy> m_sizeRankPolicy; //!< PIAS thresholds
+  uint64_t        m_nextRankBytes;      //!< Bytes at which the size rank changes next
+  uint32_t        m_rankGeneration;     //!< Policy generation m_nextRankBytes was taken from
+  Ptr<FlowCompletionCollector> m_flowCollector; //!< Collector the flow is registered with
+  uint32_t        m_flowId;             //!< Id of the flow in m_flowCollector
 
 
   /// Traced Callback: sent packets
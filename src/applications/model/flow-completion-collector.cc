@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flow-completion-collector.h"
+#include "flow-completion-tag.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/trace-source-accessor.h"
+
+#include <fstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowCompletionCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (FlowCompletionCollector);
+
+TypeId
+FlowCompletionCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowCompletionCollector")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FlowCompletionCollector> ()
+    .AddTraceSource ("FlowCompleted",
+                     "A flow has been completely received",
+                     MakeTraceSourceAccessor (&FlowCompletionCollector::m_flowCompletedTrace),
+                     "ns3::FlowCompletionCollector::FlowCompletedCallback")
+  ;
+  return tid;
+}
+
+FlowCompletionCollector::FlowCompletionCollector ()
+  : m_nCompleted (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FlowCompletionCollector::~FlowCompletionCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+FlowCompletionCollector::StartFlow (const Address &sender, const Address &receiver, uint64_t size)
+{
+  NS_LOG_FUNCTION (this << sender << receiver << size);
+  uint32_t flowId = m_flows.size ();
+  FlowRecord record = { size, Simulator::Now (), Seconds (-1), 0, 0 };
+  m_flows.push_back (record);
+  // 同一对地址上的新流取代旧流，接收端在接受连接时才查找
+  m_flowIds[std::make_pair (sender, receiver)] = flowId;
+  return flowId;
+}
+
+bool
+FlowCompletionCollector::LookupFlow (const Address &sender, const Address &receiver,
+                                     uint32_t &flowId, uint64_t &size) const
+{
+  std::map<std::pair<Address, Address>, uint32_t>::const_iterator it
+    = m_flowIds.find (std::make_pair (sender, receiver));
+  if (it == m_flowIds.end ())
+    {
+      return false;
+    }
+  flowId = it->second;
+  size = m_flows[flowId].size;
+  return true;
+}
+
+void
+FlowCompletionCollector::CompleteFlow (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown flow " << flowId);
+  FlowRecord &record = m_flows[flowId];
+  if (record.finish.IsPositive ())
+    {
+      return;
+    }
+  record.finish = Simulator::Now ();
+  m_nCompleted++;
+  NS_LOG_INFO ("Flow " << flowId << " of " << record.size << " bytes completed in "
+               << (record.finish - record.start).GetSeconds () << "s");
+  m_flowCompletedTrace (flowId, record.size, record.finish - record.start);
+}
+
+void
+FlowCompletionCollector::NotifyDrop (Ptr<const Packet> packet)
+{
+  FlowCompletionTag tag;
+  if (packet->PeekPacketTag (tag) && tag.GetFlowId () < m_flows.size ())
+    {
+      FlowRecord &record = m_flows[tag.GetFlowId ()];
+      record.drops++;
+      record.dropBytes += packet->GetSize ();
+    }
+}
+
+void
+FlowCompletionCollector::ConnectQueueDiscDrops (void)
+{
+  NS_LOG_FUNCTION (this);
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/Drop",
+                                 MakeCallback (&FlowCompletionCollector::NotifyDrop, this));
+}
+
+uint32_t
+FlowCompletionCollector::GetNFlows (void) const
+{
+  return m_flows.size ();
+}
+
+uint32_t
+FlowCompletionCollector::GetNCompletedFlows (void) const
+{
+  return m_nCompleted;
+}
+
+Time
+FlowCompletionCollector::GetFct (uint32_t flowId) const
+{
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown flow " << flowId);
+  const FlowRecord &record = m_flows[flowId];
+  return record.finish.IsPositive () ? record.finish - record.start : Seconds (-1);
+}
+
+uint32_t
+FlowCompletionCollector::GetDrops (uint32_t flowId) const
+{
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown flow " << flowId);
+  return m_flows[flowId].drops;
+}
+
+void
+FlowCompletionCollector::OutputToFile (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream out (filename.c_str (), std::ios::out);
+  if (!out)
+    {
+      NS_LOG_ERROR ("Cannot open " << filename);
+      return;
+    }
+  out << "# flowId size start fct drops dropBytes" << std::endl;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      const FlowRecord &record = m_flows[i];
+      out << i << " " << record.size << " " << record.start.GetSeconds () << " "
+          << (record.finish.IsPositive () ? (record.finish - record.start).GetSeconds () : -1) << " "
+          << record.drops << " " << record.dropBytes << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOW_COMPLETION_COLLECTOR_H
+#define FLOW_COMPLETION_COLLECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/address.h"
+#include "ns3/packet.h"
+#include "ns3/traced-callback.h"
+
+#include <map>
+#include <vector>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Flow completion times and drops reported by the applications
+ *
+ * A sender registers its flow under the addresses of both ends of its
+ * socket right after connecting, which gives the flow its id and start
+ * time.  The receiver looks the flow up under the same addresses when it
+ * accepts the connection, learns its size, and reports the completion
+ * once it has read that many bytes.  The sender tags its data with the
+ * flow id (FlowCompletionTag, a packet tag, which the TCP send buffer
+ * copies to every segment in both payload modes), so the drops of the
+ * queue discs can be charged to the flows from their Drop trace.  The
+ * segments carrying no data (SYN, FIN and pure ACKs) are not charged.
+ *
+ * No packet is probed on its way, so FlowMonitor can be left out of the
+ * runs that only need the completion times.
+ */
+class FlowCompletionCollector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FlowCompletionCollector ();
+  virtual ~FlowCompletionCollector ();
+
+  /**
+   * \brief Register a flow starting now
+   * \param sender the address of the sending socket
+   * \param receiver the address the flow is sent to
+   * \param size the size of the flow in bytes, 0 if unbounded
+   * \returns the id of the flow
+   */
+  uint32_t StartFlow (const Address &sender, const Address &receiver, uint64_t size);
+
+  /**
+   * \brief Look a flow up from the receiving end
+   * \param sender the address of the sending socket
+   * \param receiver the address of the receiving socket
+   * \param flowId the id of the flow, if found
+   * \param size the size of the flow, if found
+   * \returns true if the flow was registered
+   */
+  bool LookupFlow (const Address &sender, const Address &receiver, uint32_t &flowId, uint64_t &size) const;
+
+  /**
+   * \brief Record the completion of a flow now
+   * \param flowId the id of the flow
+   */
+  void CompleteFlow (uint32_t flowId);
+
+  /**
+   * \brief Charge a dropped packet to its flow, if it carries a
+   *        FlowCompletionTag
+   * \param packet the dropped packet
+   */
+  void NotifyDrop (Ptr<const Packet> packet);
+
+  /**
+   * \brief Follow the drops of the root queue discs of every node
+   *
+   * To be called once the traffic control layers are installed.
+   */
+  void ConnectQueueDiscDrops (void);
+
+  /**
+   * \returns the number of registered flows
+   */
+  uint32_t GetNFlows (void) const;
+
+  /**
+   * \returns the number of completed flows
+   */
+  uint32_t GetNCompletedFlows (void) const;
+
+  /**
+   * \param flowId the id of the flow
+   * \returns the completion time of the flow, or a negative time if it
+   *          has not completed
+   */
+  Time GetFct (uint32_t flowId) const;
+
+  /**
+   * \param flowId the id of the flow
+   * \returns the packets of the flow dropped so far
+   */
+  uint32_t GetDrops (uint32_t flowId) const;
+
+  /**
+   * \brief Write one line per flow: id, size, start, completion time
+   *        (-1 if not completed) and drops, in seconds and bytes
+   * \param filename the output file
+   */
+  void OutputToFile (std::string filename) const;
+
+  /**
+   * TracedCallback signature for flow completions.
+   *
+   * \param [in] flowId the id of the flow
+   * \param [in] size the size of the flow in bytes
+   * \param [in] fct the completion time of the flow
+   */
+  typedef void (* FlowCompletedCallback)(uint32_t flowId, uint64_t size, Time fct);
+
+private:
+  /**
+   * \brief What is known about a flow
+   */
+  struct FlowRecord
+  {
+    uint64_t size;     //!< Size in bytes, 0 if unbounded
+    Time start;        //!< Registration time
+    Time finish;       //!< Completion time, negative until completed
+    uint32_t drops;    //!< Packets dropped
+    uint64_t dropBytes; //!< Bytes dropped
+  };
+
+  std::vector<FlowRecord> m_flows;                               //!< Flows, indexed by id
+  std::map<std::pair<Address, Address>, uint32_t> m_flowIds;     //!< Flow ids by sender and receiver
+  uint32_t m_nCompleted;                                         //!< Completed flows
+  TracedCallback<uint32_t, uint64_t, Time> m_flowCompletedTrace; //!< Fired on completion
+};
+
+} // namespace ns3
+
+#endif /* FLOW_COMPLETION_COLLECTOR_H */
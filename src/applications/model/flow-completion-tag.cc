@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flow-completion-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FlowCompletionTag);
+
+TypeId
+FlowCompletionTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FlowCompletionTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FlowCompletionTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+FlowCompletionTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+FlowCompletionTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+FlowCompletionTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_flowId);
+}
+
+void
+FlowCompletionTag::Deserialize (TagBuffer buf)
+{
+  m_flowId = buf.ReadU32 ();
+}
+
+void
+FlowCompletionTag::Print (std::ostream &os) const
+{
+  os << "FlowId=" << m_flowId;
+}
+
+FlowCompletionTag::FlowCompletionTag ()
+  : Tag (),
+    m_flowId (0)
+{
+}
+
+FlowCompletionTag::FlowCompletionTag (uint32_t flowId)
+  : Tag (),
+    m_flowId (flowId)
+{
+}
+
+void
+FlowCompletionTag::SetFlowId (uint32_t flowId)
+{
+  m_flowId = flowId;
+}
+
+uint32_t
+FlowCompletionTag::GetFlowId (void) const
+{
+  return m_flowId;
+}
+
+} // namespace ns3
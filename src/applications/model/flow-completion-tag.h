@@ -0,0 +1,53 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOW_COMPLETION_TAG_H
+#define FLOW_COMPLETION_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Id given to a flow by its FlowCompletionCollector
+ *
+ * Carried as a packet tag on the data a sender writes to its socket.  The
+ * TCP send buffer copies the packet tags of the data to the segments cut
+ * from it, including retransmissions, whether it keeps the payload or only
+ * its size (TcpTxBuffer::VirtualPayload), so a dropped packet can be
+ * charged to its flow.  Byte tags are lost with a virtual payload.
+ */
+class FlowCompletionTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  FlowCompletionTag ();
+
+  /**
+   * \brief Constructs a FlowCompletionTag with the given flow id
+   * \param flowId the flow id
+   */
+  FlowCompletionTag (uint32_t flowId);
+  /**
+   * \param flowId the flow id
+   */
+  void SetFlowId (uint32_t flowId);
+  /**
+   * \returns the flow id
+   */
+  uint32_t GetFlowId (void) const;
+private:
+  uint32_t m_flowId; //!< Flow id
+};
+
+} // namespace ns3
+
+#endif /* FLOW_COMPLETION_TAG_H */
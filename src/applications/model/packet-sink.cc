@@ -30,7 +30,9 @@
 #include "ns3/packet.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/pointer.h"
 #include "packet-sink.h"
+#include "flow-completion-collector.h"
 
 namespace ns3 {
 
@@ -55,6 +57,12 @@ PacketSink::GetTypeId (void)
                    TypeIdValue (UdpSocketFactory::GetTypeId ()),
                    MakeTypeIdAccessor (&PacketSink::m_tid),
                    MakeTypeIdChecker ())
+    .AddAttribute ("FlowCollector",
+                   "The collector the completion of the flows registered by their "
+                   "senders is reported to, null for none",
+                   PointerValue (),
+                   MakePointerAccessor (&PacketSink::m_flowCollector),
+                   MakePointerChecker<FlowCompletionCollector> ())
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&PacketSink::m_rxTrace),
@@ -100,6 +108,8 @@ void PacketSink::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_socket = 0;
   m_socketList.clear ();
+  m_rxFlows.clear ();
+  m_flowCollector = 0;
 
   // chain up
   Application::DoDispose ();
@@ -175,6 +185,19 @@ void PacketSink::HandleRead (Ptr<Socket> socket)
           break;
         }
       m_totalRx += packet->GetSize ();
+      if (!m_rxFlows.empty ())
+        {
+          std::map<Ptr<Socket>, RxFlow>::iterator it = m_rxFlows.find (socket);
+          if (it != m_rxFlows.end ())
+            {
+              it->second.received += packet->GetSize ();
+              if (it->second.received >= it->second.size)
+                {
+                  m_flowCollector->CompleteFlow (it->second.flowId);
+                  m_rxFlows.erase (it);
+                }
+            }
+        }
       //是IPv4地址还是IPV6地址 
       if (InetSocketAddress::IsMatchingType (from))
         {
@@ -215,6 +238,17 @@ void PacketSink::HandleAccept (Ptr<Socket> s, const Address& from)
   NS_LOG_FUNCTION (this << s << from);
   s->SetRecvCallback (MakeCallback (&PacketSink::HandleRead, this));
   m_socketList.push_back (s);
+  // 发送端已用两端地址登记了流，由此得到流的大小
+  if (m_flowCollector)
+    {
+      Address local;
+      s->GetSockName (local);
+      RxFlow flow = { 0, 0, 0 };
+      if (m_flowCollector->LookupFlow (from, local, flow.flowId, flow.size) && flow.size > 0)
+        {
+          m_rxFlows[s] = flow;
+        }
+    }
 }
 
 } // Namespace ns3
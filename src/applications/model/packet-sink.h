@@ -27,8 +27,12 @@
 #include "ns3/traced-callback.h"
 #include "ns3/address.h"
 
+#include <map>
+
 namespace ns3 {
 
+class FlowCompletionCollector;
+
 class Address;
 class Socket;
 class Packet;
@@ -130,6 +134,19 @@ private:
   uint32_t        m_totalRx;      //!< Total bytes received
   TypeId          m_tid;          //!< Protocol TypeId
 
+  /**
+   * \brief Progress of a flow registered with m_flowCollector
+   */
+  struct RxFlow
+  {
+    uint32_t flowId;   //!< Id of the flow
+    uint64_t size;     //!< Bytes the flow completes at
+    uint64_t received; //!< Bytes received so far
+  };
+
+  Ptr<FlowCompletionCollector> m_flowCollector;  //!< Collector the flows are reported to
+  std::map<Ptr<Socket>, RxFlow> m_rxFlows;       //!< Flows of the accepted sockets, until complete
+
   /// Traced Callback: received packets, source address.
   TracedCallback<Ptr<const Packet>, const Address &, const Address &> m_rxTrace;
 
@@ -0,0 +1,296 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "pias-threshold-optimizer.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PiasThresholdOptimizer");
+
+NS_OBJECT_ENSURE_REGISTERED (PiasThresholdOptimizer);
+
+// 候选阀值取样本流大小的这么多个分位点
+static const uint32_t PIAS_CANDIDATES = 256;
+// 坐标下降的最多轮数
+static const uint32_t PIAS_MAX_PASSES = 50;
+
+TypeId
+PiasThresholdOptimizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PiasThresholdOptimizer")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<PiasThresholdOptimizer> ()
+    .AddAttribute ("WarmupTime",
+                   "How long flow sizes are sampled before the thresholds are solved",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&PiasThresholdOptimizer::m_warmup),
+                   MakeTimeChecker ())
+    .AddAttribute ("Ranks",
+                   "Number of ranks, one more than the thresholds",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&PiasThresholdOptimizer::m_ranks),
+                   MakeUintegerChecker<uint32_t> (1, 255))
+    .AddAttribute ("Load",
+                   "Offered load of the bottleneck link",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&PiasThresholdOptimizer::m_load),
+                   MakeDoubleChecker<double> (0.0, 0.999))
+    .AddAttribute ("Objective",
+                   "What the thresholds minimize",
+                   EnumValue (MEAN_FCT),
+                   MakeEnumAccessor (&PiasThresholdOptimizer::m_objective),
+                   MakeEnumChecker (MEAN_FCT, "Mean",
+                                    TAIL_FCT, "Tail"))
+    .AddAttribute ("TailPercentile",
+                   "Percentile of the flow completion time minimized by the Tail objective",
+                   DoubleValue (0.99),
+                   MakeDoubleAccessor (&PiasThresholdOptimizer::m_tailPercentile),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("MaxSamples",
+                   "Sampling stops at this many flows",
+                   UintegerValue (100000),
+                   MakeUintegerAccessor (&PiasThresholdOptimizer::m_maxSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+PiasThresholdOptimizer::PiasThresholdOptimizer ()
+  : m_warmup (MilliSeconds (50)),
+    m_ranks (8),
+    m_load (0.5),
+    m_objective (MEAN_FCT),
+    m_tailPercentile (0.99),
+    m_maxSamples (100000),
+    m_collecting (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PiasThresholdOptimizer::~PiasThresholdOptimizer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PiasThresholdOptimizer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_optimizeEvent.Cancel ();
+  for (std::vector<Ptr<SizeRankPolicy> >::iterator it = m_policies.begin ();
+       it != m_policies.end (); ++it)
+    {
+      (*it)->TraceDisconnectWithoutContext ("FlowSize",
+                                            MakeCallback (&PiasThresholdOptimizer::RecordFlowSize, this));
+    }
+  m_policies.clear ();
+  Object::DoDispose ();
+}
+
+void
+PiasThresholdOptimizer::AddPolicy (Ptr<SizeRankPolicy> policy)
+{
+  NS_LOG_FUNCTION (this << policy);
+  policy->TraceConnectWithoutContext ("FlowSize",
+                                      MakeCallback (&PiasThresholdOptimizer::RecordFlowSize, this));
+  m_policies.push_back (policy);
+}
+
+void
+PiasThresholdOptimizer::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_samples.clear ();
+  m_collecting = true;
+  m_optimizeEvent.Cancel ();
+  m_optimizeEvent = Simulator::Schedule (m_warmup, &PiasThresholdOptimizer::Optimize, this);
+}
+
+void
+PiasThresholdOptimizer::RecordFlowSize (uint64_t bytes)
+{
+  if (m_collecting && m_samples.size () < m_maxSamples)
+    {
+      m_samples.push_back (bytes);
+    }
+}
+
+uint32_t
+PiasThresholdOptimizer::GetNSamples (void) const
+{
+  return m_samples.size ();
+}
+
+void
+PiasThresholdOptimizer::Optimize (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_collecting = false;
+  std::vector<uint64_t> thresholds = Solve ();
+  if (thresholds.empty ())
+    {
+      NS_LOG_WARN ("Too few flows (" << m_samples.size () << ") in the warm-up window, keeping the thresholds");
+      return;
+    }
+  NS_LOG_INFO ("Solved " << thresholds.size () << " thresholds from " << m_samples.size () << " flows");
+  for (std::vector<Ptr<SizeRankPolicy> >::iterator it = m_policies.begin ();
+       it != m_policies.end (); ++it)
+    {
+      (*it)->SetThresholds (thresholds);
+    }
+}
+
+double
+PiasThresholdOptimizer::Cost (const std::vector<uint32_t> &cuts,
+                              const std::vector<Candidate> &candidates,
+                              double meanSize, double meanSquare, double tailSize) const
+{
+  // 以字节为时间单位，流到达率为load / E[S]
+  double rate = m_load / meanSize;
+  double cost = 0;
+  double lowServed = 0;
+  double lowSquare = 0;
+  double lowSigma = 0;
+  double lowThreshold = 0;
+  double lowAbove = 1;
+  double residual = 0;
+  for (uint32_t i = 0; i <= cuts.size (); i++)
+    {
+      bool last = i == cuts.size ();
+      double highServed = last ? meanSize : candidates[cuts[i]].served;
+      double highSquare = last ? meanSquare : candidates[cuts[i]].servedSquare;
+      double highThreshold = last ? std::numeric_limits<double>::max () : candidates[cuts[i]].threshold;
+      // 第i级是流在lowThreshold之后发送的部分，E[b]与E[b^2]由min(S, a)的矩得到
+      double bandServed = highServed - lowServed;
+      double bandSquare = highSquare - lowSquare - 2 * lowThreshold * bandServed;
+      double sigma = lowSigma + rate * bandServed;
+      if (sigma >= 1)
+        {
+          return std::numeric_limits<double>::max ();
+        }
+      // 抢占式优先级M/G/1：在更高优先级剩下的带宽上服务，并等待同级与更高级的剩余工作
+      residual += rate * bandSquare / 2;
+      double wait = residual / ((1 - lowSigma) * (1 - sigma));
+      if (m_objective == MEAN_FCT)
+        {
+          cost += bandServed / (1 - lowSigma) + lowAbove * wait;
+        }
+      else if (tailSize > lowThreshold)
+        {
+          cost += (std::min (tailSize, highThreshold) - lowThreshold) / (1 - lowSigma) + wait;
+        }
+      lowServed = highServed;
+      lowSquare = highSquare;
+      lowSigma = sigma;
+      lowThreshold = highThreshold;
+      lowAbove = last ? 0 : candidates[cuts[i]].above;
+    }
+  return cost;
+}
+
+std::vector<uint64_t>
+PiasThresholdOptimizer::Solve (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint64_t> thresholds;
+  if (m_samples.size () < 2 || m_ranks < 2)
+    {
+      return thresholds;
+    }
+
+  std::vector<uint64_t> sizes (m_samples);
+  std::sort (sizes.begin (), sizes.end ());
+  uint32_t n = sizes.size ();
+  std::vector<double> prefix (n + 1, 0);
+  std::vector<double> prefixSquare (n + 1, 0);
+  for (uint32_t k = 0; k < n; k++)
+    {
+      prefix[k + 1] = prefix[k] + sizes[k];
+      prefixSquare[k + 1] = prefixSquare[k] + static_cast<double> (sizes[k]) * sizes[k];
+    }
+  double meanSize = prefix[n] / n;
+  if (meanSize <= 0)
+    {
+      return thresholds;
+    }
+  double meanSquare = prefixSquare[n] / n;
+  double tailSize = sizes[std::min<uint32_t> (n - 1, m_tailPercentile * n)];
+
+  // 候选阀值为样本的分位点，并记下每个候选阀值处min(S, a)的一二阶矩
+  std::vector<Candidate> candidates;
+  uint32_t quantiles = std::min (n, PIAS_CANDIDATES);
+  for (uint32_t j = 1; j < quantiles; j++)
+    {
+      uint64_t threshold = sizes[static_cast<uint64_t> (j) * n / quantiles];
+      if (threshold > 0 && (candidates.empty () || candidates.back ().threshold != threshold))
+        {
+          Candidate candidate;
+          candidate.threshold = threshold;
+          candidates.push_back (candidate);
+        }
+    }
+  if (candidates.empty ())
+    {
+      return thresholds;
+    }
+  for (uint32_t j = 0; j < candidates.size (); j++)
+    {
+      double a = candidates[j].threshold;
+      uint32_t below = std::lower_bound (sizes.begin (), sizes.end (), candidates[j].threshold) - sizes.begin ();
+      uint32_t upTo = std::upper_bound (sizes.begin (), sizes.end (), candidates[j].threshold) - sizes.begin ();
+      candidates[j].served = (prefix[below] + a * (n - below)) / n;
+      candidates[j].servedSquare = (prefixSquare[below] + a * a * (n - below)) / n;
+      candidates[j].above = static_cast<double> (n - upTo) / n;
+    }
+
+  // 从等概率划分开始，逐个阀值在相邻阀值之间寻找最优位置
+  uint32_t nCuts = std::min<uint32_t> (m_ranks - 1, candidates.size ());
+  std::vector<uint32_t> cuts (nCuts);
+  for (uint32_t i = 0; i < nCuts; i++)
+    {
+      cuts[i] = static_cast<uint64_t> (i + 1) * candidates.size () / (nCuts + 1);
+    }
+  double best = Cost (cuts, candidates, meanSize, meanSquare, tailSize);
+  for (uint32_t pass = 0; pass < PIAS_MAX_PASSES; pass++)
+    {
+      bool improved = false;
+      for (uint32_t i = 0; i < nCuts; i++)
+        {
+          uint32_t low = i > 0 ? cuts[i - 1] + 1 : 0;
+          uint32_t high = i + 1 < nCuts ? cuts[i + 1] - 1 : candidates.size () - 1;
+          uint32_t bestCut = cuts[i];
+          for (uint32_t j = low; j <= high; j++)
+            {
+              cuts[i] = j;
+              double cost = Cost (cuts, candidates, meanSize, meanSquare, tailSize);
+              if (cost < best * (1 - 1e-9))
+                {
+                  best = cost;
+                  bestCut = j;
+                  improved = true;
+                }
+            }
+          cuts[i] = bestCut;
+        }
+      if (!improved)
+        {
+          break;
+        }
+    }
+
+  for (uint32_t i = 0; i < nCuts; i++)
+    {
+      thresholds.push_back (candidates[cuts[i]].threshold);
+    }
+  return thresholds;
+}
+
+} // namespace ns3
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PIAS_THRESHOLD_OPTIMIZER_H
+#define PIAS_THRESHOLD_OPTIMIZER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/size-rank-policy.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Derives PIAS demotion thresholds from the live workload
+ *
+ * The optimizer listens to the flow sizes reported to its SizeRankPolicy
+ * objects during a warm-up window.  At the end of the window it solves
+ * for the thresholds of the configured number of ranks and pushes them to
+ * every policy, so all the senders sharing a policy switch to them at
+ * once.
+ *
+ * The thresholds are chosen under an M/G/1 model of the multi-level
+ * queue, with the part of each flow sent in rank i as a job of priority
+ * class i.  Such a part of b bytes takes b / (1 - load(0..i-1)) to be
+ * served at the capacity the higher ranks leave, plus the preemptive
+ * priority wait R(0..i) / ((1 - load(0..i-1)) (1 - load(0..i))), where R
+ * is the mean residual work of the ranks up to i.  Coordinate descent
+ * over the quantiles of the sampled sizes minimizes the mean over the
+ * flows of the sum of these times, or its value at a percentile.
+ */
+class PiasThresholdOptimizer : public Object
+{
+public:
+  /**
+   * \brief What the thresholds minimize
+   */
+  enum Objective
+  {
+    MEAN_FCT, //!< Mean flow completion time
+    TAIL_FCT  //!< Flow completion time at the TailPercentile
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PiasThresholdOptimizer ();
+  virtual ~PiasThresholdOptimizer ();
+
+  /**
+   * \brief Sample the flow sizes reported to a policy and push the
+   *        solved thresholds to it
+   * \param policy the policy
+   */
+  void AddPolicy (Ptr<SizeRankPolicy> policy);
+
+  /**
+   * \brief Start the warm-up window
+   */
+  void Start (void);
+
+  /**
+   * \brief Add a flow size to the samples, during the warm-up window
+   * \param bytes the flow size in bytes
+   */
+  void RecordFlowSize (uint64_t bytes);
+
+  /**
+   * \returns the number of flow sizes sampled so far
+   */
+  uint32_t GetNSamples (void) const;
+
+  /**
+   * \brief Solve for the thresholds of the samples taken so far
+   * \returns the thresholds in bytes, ascending; empty if there are too
+   *          few samples
+   */
+  std::vector<uint64_t> Solve (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief End the warm-up window, solve and push the thresholds
+   */
+  void Optimize (void);
+
+  /**
+   * \brief A candidate threshold a and the flow sizes S around it
+   */
+  struct Candidate
+  {
+    uint64_t threshold;   //!< a
+    double served;        //!< E[min (S, a)]
+    double servedSquare;  //!< E[min (S, a)^2]
+    double above;         //!< P (S > a)
+  };
+
+  /**
+   * \param cuts the thresholds, as ascending indexes into candidates
+   * \param candidates the candidate thresholds
+   * \param meanSize E[S]
+   * \param meanSquare E[S^2]
+   * \param tailSize the flow size at the TailPercentile
+   * \returns the completion time objective, in bytes of service
+   */
+  double Cost (const std::vector<uint32_t> &cuts,
+               const std::vector<Candidate> &candidates,
+               double meanSize, double meanSquare, double tailSize) const;
+
+  Time m_warmup;              //!< Warm-up window
+  uint32_t m_ranks;           //!< Number of ranks to solve for
+  double m_load;              //!< Offered load of the bottleneck
+  Objective m_objective;      //!< What the thresholds minimize
+  double m_tailPercentile;    //!< Percentile of TAIL_FCT
+  uint32_t m_maxSamples;      //!< Sampling stops at this many flows
+
+  std::vector<uint64_t> m_samples;               //!< Sampled flow sizes
+  bool m_collecting;                             //!< Whether the warm-up window is open
+  EventId m_optimizeEvent;                       //!< End of the warm-up window
+  std::vector<Ptr<SizeRankPolicy> > m_policies;  //!< Policies fed by the optimizer
+};
+
+} // namespace ns3
+
+#endif /* PIAS_THRESHOLD_OPTIMIZER_H */
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/queue-disc.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/flow-completion-collector.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief Check that the drops and the completion time of a TCP flow are
+ *        charged to it, whether the TCP buffers keep the payload or not
+ *
+ * A BulkSend flow of 200KB crosses a router from 100Mbps to 10Mbps, whose
+ * queue disc holds 8 packets, so slow start overflows it and the flow
+ * recovers through retransmissions.  Every drop of
+ * the queue discs must be charged to the flow, and the flow must complete
+ * at the same time in both payload modes.
+ */
+class FlowCompletionCollectorTestCase : public TestCase
+{
+public:
+  FlowCompletionCollectorTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Run the flow
+   * \param virtualPayload the value of TcpTxBuffer::VirtualPayload and
+   *        TcpRxBuffer::VirtualPayload
+   * \param fct the completion time of the flow
+   * \param drops the drops charged to the flow
+   * \param qdiscDrops the drops of the queue discs of the bottleneck
+   */
+  void RunFlow (bool virtualPayload, Time &fct, uint32_t &drops, uint32_t &qdiscDrops);
+};
+
+FlowCompletionCollectorTestCase::FlowCompletionCollectorTestCase ()
+  : TestCase ("FlowCompletionCollector charges the drops and completion time to the flow in both payload modes")
+{
+}
+
+void
+FlowCompletionCollectorTestCase::RunFlow (bool virtualPayload, Time &fct, uint32_t &drops, uint32_t &qdiscDrops)
+{
+  Config::SetDefault ("ns3::TcpTxBuffer::VirtualPayload", BooleanValue (virtualPayload));
+  Config::SetDefault ("ns3::TcpRxBuffer::VirtualPayload", BooleanValue (virtualPayload));
+  // the TCP settings of the load balancing simulations
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (10));
+  Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (10)));
+
+  // sender, router and receiver
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("10us"));
+  NetDeviceContainer accessDevices = access.Install (nodes.Get (0), nodes.Get (1));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10us"));
+  // a single packet in the device keeps the backlog in the queue disc
+  bottleneck.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (1));
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (nodes.Get (1), nodes.Get (2));
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", UintegerValue (8));
+  QueueDiscContainer qdiscs = tch.Install (bottleneckDevices);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  ipv4.Assign (accessDevices);
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4Address receiver = ipv4.Assign (bottleneckDevices).GetAddress (1);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<FlowCompletionCollector> collector = CreateObject<FlowCompletionCollector> ();
+  collector->ConnectQueueDiscDrops ();
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink.SetAttribute ("FlowCollector", PointerValue (collector));
+  sink.Install (nodes.Get (2));
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (receiver, 9));
+  source.SetAttribute ("MaxBytes", UintegerValue (200000));
+  source.SetAttribute ("FlowCollector", PointerValue (collector));
+  source.Install (nodes.Get (0)).Start (MilliSeconds (1));
+
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (collector->GetNFlows (), 1, "Wrong number of flows registered");
+  NS_TEST_EXPECT_MSG_EQ (collector->GetNCompletedFlows (), 1, "The flow did not complete");
+  fct = collector->GetNFlows () == 1 ? collector->GetFct (0) : Seconds (-1);
+  drops = collector->GetNFlows () == 1 ? collector->GetDrops (0) : 0;
+  qdiscDrops = qdiscs.Get (0)->GetTotalDroppedPackets () + qdiscs.Get (1)->GetTotalDroppedPackets ();
+
+  Simulator::Destroy ();
+}
+
+void
+FlowCompletionCollectorTestCase::DoRun (void)
+{
+  Time fct[2];
+  uint32_t drops[2];
+  uint32_t qdiscDrops[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      bool virtualPayload = (i == 1);
+      RunFlow (virtualPayload, fct[i], drops[i], qdiscDrops[i]);
+      NS_TEST_EXPECT_MSG_GT (fct[i], Seconds (0), "No completion time with VirtualPayload " << virtualPayload);
+      NS_TEST_EXPECT_MSG_GT (qdiscDrops[i], 0, "The bottleneck dropped nothing with VirtualPayload " << virtualPayload);
+      NS_TEST_EXPECT_MSG_EQ (drops[i], qdiscDrops[i],
+                             "Drops not charged to the flow with VirtualPayload " << virtualPayload);
+    }
+  NS_TEST_EXPECT_MSG_EQ (fct[1], fct[0], "The payload mode changed the completion time");
+  NS_TEST_EXPECT_MSG_EQ (drops[1], drops[0], "The payload mode changed the drops");
+
+  Config::Reset ();
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief FlowCompletionCollector TestSuite
+ */
+static class FlowCompletionCollectorTestSuite : public TestSuite
+{
+public:
+  FlowCompletionCollectorTestSuite ()
+    : TestSuite ("flow-completion-collector", UNIT)
+  {
+    AddTestCase (new FlowCompletionCollectorTestCase, TestCase::QUICK);
+  }
+} g_flowCompletionCollectorTestSuite;
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/size-rank-policy.h"
+#include "ns3/pias-threshold-optimizer.h"
+
+using namespace ns3;
+
+/**
+ * \brief Report the sample workload to a policy: 40 flows, half of them
+ *        of 1KB and two of 1MB
+ * \param policy the policy
+ */
+static void
+NotifyWorkload (Ptr<SizeRankPolicy> policy)
+{
+  static const uint64_t sizes[] = { 1000, 5000, 20000, 100000, 1000000 };
+  static const uint32_t counts[] = { 20, 8, 6, 4, 2 };
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      for (uint32_t j = 0; j < counts[i]; j++)
+        {
+          policy->NotifyFlowSize (sizes[i]);
+        }
+    }
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief Check the thresholds solved for the sample workload
+ *
+ * The expected thresholds minimize the cost model over every choice of
+ * candidates, found by exhaustive search outside of ns-3.
+ */
+class PiasThresholdSolveTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param ranks the number of ranks
+   * \param load the offered load
+   * \param objective the objective, "Mean" or "Tail"
+   * \param expected the expected thresholds
+   */
+  PiasThresholdSolveTestCase (uint32_t ranks, double load, std::string objective,
+                              std::vector<uint64_t> expected);
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_ranks;                 //!< the number of ranks
+  double m_load;                    //!< the offered load
+  std::string m_objective;          //!< the objective
+  std::vector<uint64_t> m_expected; //!< the expected thresholds
+};
+
+PiasThresholdSolveTestCase::PiasThresholdSolveTestCase (uint32_t ranks, double load, std::string objective,
+                                                        std::vector<uint64_t> expected)
+  : TestCase ("Solve thresholds for " + objective + " FCT"),
+    m_ranks (ranks),
+    m_load (load),
+    m_objective (objective),
+    m_expected (expected)
+{
+}
+
+void
+PiasThresholdSolveTestCase::DoRun (void)
+{
+  Ptr<SizeRankPolicy> policy = CreateObject<SizeRankPolicy> ();
+  Ptr<PiasThresholdOptimizer> optimizer = CreateObject<PiasThresholdOptimizer> ();
+  optimizer->SetAttribute ("Ranks", UintegerValue (m_ranks));
+  optimizer->SetAttribute ("Load", DoubleValue (m_load));
+  optimizer->SetAttribute ("Objective", StringValue (m_objective));
+  optimizer->AddPolicy (policy);
+  optimizer->Start ();
+  NotifyWorkload (policy);
+  NS_TEST_ASSERT_MSG_EQ (optimizer->GetNSamples (), 40, "The optimizer missed flow sizes");
+
+  std::vector<uint64_t> thresholds = optimizer->Solve ();
+  NS_TEST_ASSERT_MSG_EQ (thresholds.size (), m_expected.size (),
+                         "Wrong number of thresholds for " << m_ranks << " ranks at load " << m_load);
+  for (uint32_t i = 0; i < thresholds.size (); i++)
+    {
+      if (i > 0)
+        {
+          NS_TEST_EXPECT_MSG_GT (thresholds[i], thresholds[i - 1], "The thresholds are not ascending");
+        }
+      NS_TEST_EXPECT_MSG_EQ (thresholds[i], m_expected[i],
+                             "Wrong threshold " << i << " for " << m_ranks << " ranks at load " << m_load);
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief Check that the end of the warm-up pushes the solved thresholds
+ *        to the policies, and that a single rank or too few flows keep
+ *        the thresholds
+ */
+class PiasThresholdOptimizeTestCase : public TestCase
+{
+public:
+  PiasThresholdOptimizeTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Run a warm-up window of 1ms over the flows
+   * \param ranks the number of ranks
+   * \param workload whether the sample workload starts, rather than a
+   *        single flow
+   * \param policy the policy fed by the optimizer
+   * \returns the number of flow sizes sampled
+   */
+  uint32_t Warmup (uint32_t ranks, bool workload, Ptr<SizeRankPolicy> policy);
+};
+
+PiasThresholdOptimizeTestCase::PiasThresholdOptimizeTestCase ()
+  : TestCase ("Push the solved thresholds at the end of the warm-up")
+{
+}
+
+uint32_t
+PiasThresholdOptimizeTestCase::Warmup (uint32_t ranks, bool workload, Ptr<SizeRankPolicy> policy)
+{
+  Ptr<PiasThresholdOptimizer> optimizer = CreateObject<PiasThresholdOptimizer> ();
+  optimizer->SetAttribute ("WarmupTime", TimeValue (MilliSeconds (1)));
+  optimizer->SetAttribute ("Ranks", UintegerValue (ranks));
+  optimizer->AddPolicy (policy);
+  optimizer->Start ();
+  if (workload)
+    {
+      Simulator::Schedule (MicroSeconds (500), &NotifyWorkload, policy);
+    }
+  else
+    {
+      Simulator::Schedule (MicroSeconds (500), &SizeRankPolicy::NotifyFlowSize, policy, 1000);
+    }
+  // flows starting after the warm-up are not sampled
+  Simulator::Schedule (MilliSeconds (2), &SizeRankPolicy::NotifyFlowSize, policy, 7000);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  uint32_t samples = optimizer->GetNSamples ();
+  optimizer->Dispose ();
+  return samples;
+}
+
+void
+PiasThresholdOptimizeTestCase::DoRun (void)
+{
+  std::vector<uint64_t> initial;
+  initial.push_back (3000);
+
+  Ptr<SizeRankPolicy> policy = CreateObject<SizeRankPolicy> ();
+  policy->SetThresholds (initial);
+  uint32_t generation = policy->GetGeneration ();
+  NS_TEST_ASSERT_MSG_EQ (Warmup (3, true, policy), 40, "Wrong number of flow sizes sampled");
+  NS_TEST_ASSERT_MSG_EQ (policy->GetThresholds ().size (), 2, "The solved thresholds were not pushed");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetThresholds ()[0], 20000, "Wrong first threshold pushed");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetThresholds ()[1], 100000, "Wrong second threshold pushed");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetGeneration (), generation + 1, "The policy generation was not bumped");
+
+  // a single queue has no threshold to solve
+  policy = CreateObject<SizeRankPolicy> ();
+  policy->SetThresholds (initial);
+  generation = policy->GetGeneration ();
+  NS_TEST_ASSERT_MSG_EQ (Warmup (1, true, policy), 40, "Wrong number of flow sizes sampled");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetThresholds ().size (), 1, "A single rank replaced the thresholds");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetGeneration (), generation, "A single rank changed the policy");
+
+  policy = CreateObject<SizeRankPolicy> ();
+  policy->SetThresholds (initial);
+  generation = policy->GetGeneration ();
+  NS_TEST_ASSERT_MSG_EQ (Warmup (3, false, policy), 1, "Wrong number of flow sizes sampled");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetThresholds ().size (), 1, "A single flow replaced the thresholds");
+  NS_TEST_EXPECT_MSG_EQ (policy->GetGeneration (), generation, "A single flow changed the policy");
+}
+
+/**
+ * \ingroup applications
+ * \ingroup tests
+ *
+ * \brief PiasThresholdOptimizer TestSuite
+ */
+static class PiasThresholdOptimizerTestSuite : public TestSuite
+{
+public:
+  PiasThresholdOptimizerTestSuite ()
+    : TestSuite ("pias-threshold-optimizer", UNIT)
+  {
+    std::vector<uint64_t> expected;
+    expected.push_back (20000);
+    expected.push_back (100000);
+    AddTestCase (new PiasThresholdSolveTestCase (3, 0.5, "Mean", expected), TestCase::QUICK);
+
+    expected.clear ();
+    expected.push_back (1000);
+    expected.push_back (1000000);
+    AddTestCase (new PiasThresholdSolveTestCase (3, 0.5, "Tail", expected), TestCase::QUICK);
+
+    expected.clear ();
+    expected.push_back (5000);
+    expected.push_back (20000);
+    expected.push_back (100000);
+    AddTestCase (new PiasThresholdSolveTestCase (4, 0.5, "Mean", expected), TestCase::QUICK);
+
+    // near saturation, the highest load the attribute accepts
+    AddTestCase (new PiasThresholdSolveTestCase (4, 0.999, "Mean", expected), TestCase::QUICK);
+
+    expected.clear ();
+    expected.push_back (100000);
+    AddTestCase (new PiasThresholdSolveTestCase (2, 0.999, "Mean", expected), TestCase::QUICK);
+
+    // a single queue has no threshold
+    expected.clear ();
+    AddTestCase (new PiasThresholdSolveTestCase (1, 0.5, "Mean", expected), TestCase::QUICK);
+
+    AddTestCase (new PiasThresholdOptimizeTestCase, TestCase::QUICK);
+  }
+} g_piasThresholdOptimizerTestSuite;
@@ -5,6 +5,7 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 
 namespace ns3 {
 
@@ -20,15 +21,18 @@ Ipv4Clove::Ipv4Clove () :
     m_disToUncongestedPath (false)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Clove::Ipv4Clove (const Ipv4Clove &other) :
     m_flowletTimeout (other.m_flowletTimeout),
     m_runMode (other.m_runMode),
+    m_flowletTable (other.m_flowletTable.GetSize (), other.m_flowletTable.GetCollisionPolicy ()),
     m_halfRTT (other.m_halfRTT),
     m_disToUncongestedPath (other.m_disToUncongestedPath)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 //得到TypeId
@@ -55,6 +59,18 @@ Ipv4Clove::GetTypeId (void)
                        BooleanValue (false),
                        MakeBooleanAccessor (&Ipv4Clove::m_disToUncongestedPath),
                        MakeBooleanChecker ())
+        .AddAttribute ("FlowletTableSize", "Number of buckets in the flowlet table",
+                       UintegerValue (4096),
+                       MakeUintegerAccessor (&Ipv4Clove::SetFlowletTableSize,
+                                             &Ipv4Clove::GetFlowletTableSize),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("FlowletCollision",
+                       "What a new flowlet does when its bucket holds another active flow",
+                       EnumValue (FLOWLET_COLLISION_REPLACE),
+                       MakeEnumAccessor (&Ipv4Clove::SetFlowletCollisionPolicy,
+                                         &Ipv4Clove::GetFlowletCollisionPolicy),
+                       MakeEnumChecker (FLOWLET_COLLISION_REPLACE, "Replace",
+                                        FLOWLET_COLLISION_BYPASS, "Bypass"))
     ;
 
     return tid;
@@ -103,6 +119,14 @@ Ipv4Clove::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
     return true;
 }
 
+int64_t
+Ipv4Clove::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 uint32_t
 Ipv4Clove::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
@@ -120,28 +144,60 @@ Ipv4Clove::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    //查询flowLet如果是第一次就先选择路
-    struct CloveFlowlet flowlet;
-    std::map<uint32_t, CloveFlowlet>::iterator flowletItr = m_flowletMap.find (flowId);
-    if (flowletItr != m_flowletMap.end ())
+    //查询flowlet，未过期则沿用原路径
+    bool flowletActive = false;
+    FlowletTable<uint32_t>::Entry *flowlet = m_flowletTable.Lookup (flowId, m_flowletTimeout, flowletActive);
+    if (flowletActive)
     {
-        flowlet = flowletItr->second;
+        //最后一次看到时间更新为现在
+        flowlet->activeTime = Simulator::Now ();
+        return flowlet->value;
     }
-    else
+
+    //第一次或过了timeout时间则重新计算路径
+    uint32_t path = Ipv4Clove::CalPath (destTor);
+    if (flowlet == 0)
     {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
+        flowlet = m_flowletTable.Insert (flowId, m_flowletTimeout);
     }
-    //如果过了timeout时间也重新计算路径
-    if (Simulator::Now () - flowlet.lastSeen >= m_flowletTimeout)
+    //存储到表中，冲突时可能不缓存
+    if (flowlet != 0)
     {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
+        flowlet->value = path;
+        flowlet->activeTime = Simulator::Now ();
     }
-    //最后一次看到时间更新为现在
-    flowlet.lastSeen = Simulator::Now ();
-    //存储到表中
-    m_flowletMap[flowId] = flowlet;
 
-    return flowlet.path;
+    return path;
+}
+
+const FlowletTable<uint32_t> &
+Ipv4Clove::GetFlowletTable (void) const
+{
+    return m_flowletTable;
+}
+
+void
+Ipv4Clove::SetFlowletTableSize (uint32_t size)
+{
+    m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4Clove::GetFlowletTableSize (void) const
+{
+    return m_flowletTable.GetSize ();
+}
+
+void
+Ipv4Clove::SetFlowletCollisionPolicy (FlowletCollisionPolicy policy)
+{
+    m_flowletTable.SetCollisionPolicy (policy);
+}
+
+FlowletCollisionPolicy
+Ipv4Clove::GetFlowletCollisionPolicy (void) const
+{
+    return m_flowletTable.GetCollisionPolicy ();
 }
 
 
@@ -160,12 +216,12 @@ Ipv4Clove::CalPath (uint32_t destTor)
     if (m_runMode == CLOVE_RUNMODE_EDGE_FLOWLET)
     {
         //随机选择一个路径
-        return paths[rand() % paths.size ()];
+        return paths[m_rand->GetInteger (0, paths.size () - 1)];
     }
     else if (m_runMode == CLOVE_RUNMODE_ECN)
     {
         //产生一个随机浮点数
-        double r = ((double) rand () / RAND_MAX);
+        double r = m_rand->GetValue (0.0, 1.0);
         std::vector<uint32_t>::iterator itr = paths.begin ();
         double weightSum = 0.0;
         for ( ; itr != paths.end (); ++itr)
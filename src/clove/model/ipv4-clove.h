@@ -5,6 +5,8 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
 #include <vector>
 #include <map>
@@ -16,12 +18,6 @@
 
 namespace ns3 {
 
-//Clove的flowlet路由表
-struct CloveFlowlet {
-    Time lastSeen;
-    uint32_t path;
-};
-
 class Ipv4Clove : public Object {
 
 public:
@@ -39,9 +35,20 @@ public:
 
     bool FindTorId (Ipv4Address daddr, uint32_t &torId);
 
+    //指定路径选择所用随机变量的流编号，返回使用的流数量
+    int64_t AssignStreams (int64_t stream);
+
+    //flowlet表的命中、未命中与冲突计数
+    const FlowletTable<uint32_t> &GetFlowletTable (void) const;
+
 private:
     uint32_t CalPath (uint32_t destTor);
 
+    void SetFlowletTableSize (uint32_t size);
+    uint32_t GetFlowletTableSize (void) const;
+    void SetFlowletCollisionPolicy (FlowletCollisionPolicy policy);
+    FlowletCollisionPolicy GetFlowletCollisionPolicy (void) const;
+
     Time m_flowletTimeout;
     uint32_t m_runMode;
 
@@ -49,7 +56,10 @@ private:
     std::map<uint32_t, std::vector<uint32_t> > m_availablePath; 
     //从IP到Tor的映射
     std::map<Ipv4Address, uint32_t> m_ipTorMap;
-    std::map<uint32_t, CloveFlowlet> m_flowletMap;
+    //Clove的flowlet表，表项的值为路径
+    FlowletTable<uint32_t> m_flowletTable;
+    //新flowlet的随机路径与按权重选路
+    Ptr<UniformRandomVariable> m_rand;
 
     // Clove ECN
     //过了半个RTT还没再次见到ECN则认为这个路径不再拥塞
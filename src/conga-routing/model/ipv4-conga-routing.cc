@@ -8,9 +8,12 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ipv4-conga-tag.h"
 
 #include <algorithm>
+#include <sstream>
 
 #define LOOPBACK_PORT 0
 
@@ -38,6 +41,7 @@ Ipv4CongaRouting::Ipv4CongaRouting() : // Parameters
                                        m_ipv4(0)
 {
   NS_LOG_FUNCTION(this);
+  m_rand = CreateObject<UniformRandomVariable>();
 }
 
 Ipv4CongaRouting::~Ipv4CongaRouting()
@@ -51,7 +55,20 @@ Ipv4CongaRouting::GetTypeId(void)
   static TypeId tid = TypeId("ns3::Ipv4CongaRouting")
                           .SetParent<Object>()
                           .SetGroupName("Internet")
-                          .AddConstructor<Ipv4CongaRouting>();
+                          .AddConstructor<Ipv4CongaRouting>()
+                          .AddAttribute("FlowletTableSize",
+                                        "Number of buckets in the flowlet table",
+                                        UintegerValue(4096),
+                                        MakeUintegerAccessor(&Ipv4CongaRouting::SetFlowletTableSize,
+                                                             &Ipv4CongaRouting::GetFlowletTableSize),
+                                        MakeUintegerChecker<uint32_t>(1))
+                          .AddAttribute("FlowletCollision",
+                                        "What a new flowlet does when its bucket holds another active flow",
+                                        EnumValue(FLOWLET_COLLISION_REPLACE),
+                                        MakeEnumAccessor(&Ipv4CongaRouting::SetFlowletCollisionPolicy,
+                                                         &Ipv4CongaRouting::GetFlowletCollisionPolicy),
+                                        MakeEnumChecker(FLOWLET_COLLISION_REPLACE, "Replace",
+                                                        FLOWLET_COLLISION_BYPASS, "Bypass"));
 
   return tid;
 }
@@ -69,6 +86,35 @@ void Ipv4CongaRouting::SetFlowletTimeout(Time timeout)
   m_flowletTimeout = timeout;
 }
 
+//设置flowlet表的大小，已有的表项会被清空
+void Ipv4CongaRouting::SetFlowletTableSize(uint32_t size)
+{
+  m_flowletTable.SetSize(size);
+}
+
+uint32_t
+Ipv4CongaRouting::GetFlowletTableSize(void) const
+{
+  return m_flowletTable.GetSize();
+}
+
+void Ipv4CongaRouting::SetFlowletCollisionPolicy(FlowletCollisionPolicy policy)
+{
+  m_flowletTable.SetCollisionPolicy(policy);
+}
+
+FlowletCollisionPolicy
+Ipv4CongaRouting::GetFlowletCollisionPolicy(void) const
+{
+  return m_flowletTable.GetCollisionPolicy();
+}
+
+const FlowletTable<uint32_t> &
+Ipv4CongaRouting::GetFlowletTable(void) const
+{
+  return m_flowletTable;
+}
+
 //设置DRE算法中参数
 void Ipv4CongaRouting::SetAlpha(double alpha)
 {
@@ -138,6 +184,13 @@ void Ipv4CongaRouting::AddRoute(Ipv4Address network, Ipv4Mask networkMask, uint3
   m_routeEntryList.push_back(congaRouteEntry);
 }
 
+int64_t Ipv4CongaRouting::AssignStreams(int64_t stream)
+{
+  NS_LOG_FUNCTION(this << stream);
+  m_rand->SetStream(stream);
+  return 1;
+}
+
 //查找路由表
 std::vector<CongaRouteEntry>
 Ipv4CongaRouting::LookupCongaRouteEntries(Ipv4Address dest)
@@ -352,49 +405,42 @@ bool Ipv4CongaRouting::RouteInput(Ptr<const Packet> p, const Ipv4Header &header,
       // If not hit, determine the port based on the congestion degree of the link
 
       // Flowlet table look up
-      struct Flowlet *flowlet = NULL;
-
       // If the flowlet table entry is valid, return the port
-      //查询flowlet表
-      std::map<uint32_t, struct Flowlet *>::iterator flowletItr = m_flowletTable.find(flowId);
-      if (flowletItr != m_flowletTable.end())
+      //查询flowlet表，表项过期时仍返回，用于倾向已缓存的端口
+      bool flowletActive = false;
+      FlowletTable<uint32_t>::Entry *flowlet = m_flowletTable.Lookup(flowId, m_flowletTimeout, flowletActive);
+      //如果表项还有效
+      if (flowletActive)
       {
-        //如果hit，得到flowlet的结构体，其实即端口和时间，也即flowlet表中元素
-        flowlet = flowletItr->second;
-        //如果表项还有效
-        if (flowlet != NULL && // Impossible in normal cases
-            now - flowlet->activeTime <= m_flowletTimeout)
-        {
-          //更新时间
-          // Do not forget to update the flowlet active time
-          flowlet->activeTime = now;
+        //更新时间
+        // Do not forget to update the flowlet active time
+        flowlet->activeTime = now;
 
-          //返回选择的端口信息
-          // Return the port information used for routing routine to select the port
-          selectedPort = flowlet->port;
+        //返回选择的端口信息
+        // Return the port information used for routing routine to select the port
+        selectedPort = flowlet->value;
 
-          // Construct Conga Header for the packet
-          //LbTag表示了选择的port，CE表示了CE位
-          ipv4CongaTag.SetLbTag(selectedPort);
-          ipv4CongaTag.SetCe(0);
+        // Construct Conga Header for the packet
+        //LbTag表示了选择的port，CE表示了CE位
+        ipv4CongaTag.SetLbTag(selectedPort);
+        ipv4CongaTag.SetCe(0);
 
-          // Piggyback the feedback information
-          //要带给另一端路由的信息
-          ipv4CongaTag.SetFbLbTag(fbLbTag);
-          ipv4CongaTag.SetFbMetric(fbMetric);
-          packet->AddPacketTag(ipv4CongaTag); //加入packet的tag
+        // Piggyback the feedback information
+        //要带给另一端路由的信息
+        ipv4CongaTag.SetFbLbTag(fbLbTag);
+        ipv4CongaTag.SetFbMetric(fbMetric);
+        packet->AddPacketTag(ipv4CongaTag); //加入packet的tag
 
-          // Update local dre
-          //更新这个端口的DRE信息
-          Ipv4CongaRouting::UpdateLocalDre(header, packet, selectedPort);
-          //构建一个路由条目
-          Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route(selectedPort, destAddress);
-          ucb(route, packet, header);//单播Callback
+        // Update local dre
+        //更新这个端口的DRE信息
+        Ipv4CongaRouting::UpdateLocalDre(header, packet, selectedPort);
+        //构建一个路由条目
+        Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route(selectedPort, destAddress);
+        ucb(route, packet, header);//单播Callback
 
-          NS_LOG_LOGIC(this << " Sending Conga on leaf switch (flowlet hit): " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
+        NS_LOG_LOGIC(this << " Sending Conga on leaf switch (flowlet hit): " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
 
-          return true;
-        }
+        return true;
       }
       //如果没有hit到flowlet表中的条目
       NS_LOG_LOGIC(this << " Flowlet expires, calculate the new port");
@@ -456,28 +502,25 @@ bool Ipv4CongaRouting::RouteInput(Ptr<const Packet> p, const Ipv4Header &header,
       //从其中选择一个端口并且倾向于已缓存的端口
       // 3. Select one port from all those candidate ports
       if (flowlet != NULL &&
-          std::find(portCandidates.begin(), portCandidates.end(), flowlet->port) != portCandidates.end())
+          std::find(portCandidates.begin(), portCandidates.end(), flowlet->value) != portCandidates.end())
       {
         // Prefer the port cached in flowlet table
-        selectedPort = flowlet->port;
+        selectedPort = flowlet->value;
         // Activate the flowlet entry again
         flowlet->activeTime = now;
       }
       else //如果已缓存的端口不在候选中，则随机选择一个端口
       {
         // If there are no cached ports, we randomly choose a good port
-        selectedPort = portCandidates[rand() % portCandidates.size()];
-        //如果flowlet表中没有表项则新建立一个
+        selectedPort = portCandidates[m_rand->GetInteger(0, portCandidates.size() - 1)];
+        //如果flowlet表中没有表项则占用其桶，冲突时可能不缓存
         if (flowlet == NULL)
         {
-          struct Flowlet *newFlowlet = new Flowlet;
-          newFlowlet->port = selectedPort;
-          newFlowlet->activeTime = now;
-          m_flowletTable[flowId] = newFlowlet;
+          flowlet = m_flowletTable.Insert(flowId, m_flowletTimeout);
         }
-        else //否则只更改端口与时间即可
+        if (flowlet != NULL) //否则只更改端口与时间即可
         {
-          flowlet->port = selectedPort;
+          flowlet->value = selectedPort;
           flowlet->activeTime = now;
         }
       }
@@ -677,11 +720,7 @@ void Ipv4CongaRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream) const
 //删除flowlet表并取消各种事件
 void Ipv4CongaRouting::DoDispose(void)
 {
-  std::map<uint32_t, Flowlet *>::iterator itr = m_flowletTable.begin();
-  for (; itr != m_flowletTable.end(); ++itr)
-  {
-    delete (itr->second);
-  }
+  m_flowletTable.Clear();
   m_dreEvent.Cancel();
   m_agingEvent.Cancel();
   m_ipv4 = 0;
@@ -767,25 +806,31 @@ void Ipv4CongaRouting::AgingEvent()
   //老化congetsionFromLeaf表，feedbackinfo中是包含时间信息的
   std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr2 =
       m_congaFromLeafTable.begin();
-  for (; itr2 != m_congaFromLeafTable.end(); ++itr2)
+  while (itr2 != m_congaFromLeafTable.end())
   {
     std::map<uint32_t, FeedbackInfo>::iterator innerItr2 =
         (itr2->second).begin();
-    for (; innerItr2 != (itr2->second).end(); ++innerItr2)
+    while (innerItr2 != (itr2->second).end())
     {
       if (Simulator::Now() - (innerItr2->second).updateTime > m_agingTime)
       {
-        (itr2->second).erase(innerItr2);
-        if ((itr2->second).empty())
-        {
-          m_congaFromLeafTable.erase(itr2);
-        }
+        (itr2->second).erase(innerItr2++);
       }
       else
       {
         moveToIdleStatus = false;
+        ++innerItr2;
       }
     }
+    //表项全部老化后删除这个叶结点
+    if ((itr2->second).empty())
+    {
+      m_congaFromLeafTable.erase(itr2++);
+    }
+    else
+    {
+      ++itr2;
+    }
   }
 
   //如果还没到IDLE状态，继续调用函数
@@ -814,86 +859,103 @@ Ipv4CongaRouting::QuantizingX(uint32_t interface, uint32_t X)
   return static_cast<uint32_t>(ratio * std::pow(2, m_Q));
 }
 
+// The table printers only feed NS_LOG_LOGIC: they are compiled out of
+// optimized builds and return at once while the log level is disabled,
+// so the per-packet calls in RouteInput cost nothing in normal runs.
 void Ipv4CongaRouting::PrintCongaToLeafTable()
 {
-  /*
+#ifdef NS3_LOG_ENABLE
+  if (!g_log.IsEnabled(LOG_LOGIC))
+  {
+    return;
+  }
   std::ostringstream oss;
-  oss << "===== CongaToLeafTable For Leaf: " << m_leafId <<"=====" << std::endl;
-  std::map<uint32_t, std::map<uint32_t, uint32_t> >::iterator itr = m_congaToLeafTable.begin ();
-  for ( ; itr != m_congaToLeafTable.end (); ++itr )
+  oss << "===== CongaToLeafTable For Leaf: " << m_leafId << "=====" << std::endl;
+  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t>>>::iterator itr = m_congaToLeafTable.begin();
+  for (; itr != m_congaToLeafTable.end(); ++itr)
   {
-    oss << "Leaf ID: " << itr->first << std::endl<<"\t";
-    std::map<uint32_t, uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    oss << "Leaf ID: " << itr->first << std::endl
+        << "\t";
+    std::map<uint32_t, std::pair<Time, uint32_t>>::iterator innerItr = (itr->second).begin();
+    for (; innerItr != (itr->second).end(); ++innerItr)
     {
       oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second)
+          << innerItr->first << ", ce: " << (innerItr->second).second
+          << ", updated: " << (innerItr->second).first
           << " } ";
     }
     oss << std::endl;
   }
   oss << "============================";
-  NS_LOG_LOGIC (oss.str ());
-*/
+  NS_LOG_LOGIC(oss.str());
+#endif
 }
 
 void Ipv4CongaRouting::PrintCongaFromLeafTable()
 {
-  /*
+#ifdef NS3_LOG_ENABLE
+  if (!g_log.IsEnabled(LOG_LOGIC))
+  {
+    return;
+  }
   std::ostringstream oss;
-  oss << "===== CongaFromLeafTable For Leaf: " << m_leafId << "=====" <<std::endl;
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr = m_congaFromLeafTable.begin ();
-  for ( ; itr != m_congaFromLeafTable.end (); ++itr )
+  oss << "===== CongaFromLeafTable For Leaf: " << m_leafId << "=====" << std::endl;
+  std::map<uint32_t, std::map<uint32_t, FeedbackInfo>>::iterator itr = m_congaFromLeafTable.begin();
+  for (; itr != m_congaFromLeafTable.end(); ++itr)
   {
-    oss << "Leaf ID: " << itr->first << std::endl << "\t";
-    std::map<uint32_t, FeedbackInfo>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    oss << "Leaf ID: " << itr->first << std::endl
+        << "\t";
+    std::map<uint32_t, FeedbackInfo>::iterator innerItr = (itr->second).begin();
+    for (; innerItr != (itr->second).end(); ++innerItr)
     {
       oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second).ce
+          << innerItr->first << ", ce: " << (innerItr->second).ce
           << ", change: " << (innerItr->second).change
           << " } ";
     }
     oss << std::endl;
   }
   oss << "==============================";
-  NS_LOG_LOGIC (oss.str ());
-*/
+  NS_LOG_LOGIC(oss.str());
+#endif
 }
 
 void Ipv4CongaRouting::PrintFlowletTable()
 {
-  /*
-  std::ostringstream oss;
-  oss << "===== Flowlet For Leaf: " << m_leafId << "=====" << std::endl;
-  std::map<uint32_t, Flowlet*>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end(); ++itr )
+#ifdef NS3_LOG_ENABLE
+  if (!g_log.IsEnabled(LOG_LOGIC))
   {
-    oss << "flowId: " << itr->first << std::endl << "\t"
-        << "port: " << (itr->second)->port << "\t"
-        << "activeTime" << (itr->second)->activeTime << std::endl;
+    return;
   }
+  std::ostringstream oss;
+  oss << "===== Flowlet For Leaf: " << m_leafId << "=====" << std::endl;
+  oss << "size: " << m_flowletTable.GetSize() << "\t"
+      << "hits: " << m_flowletTable.GetHits() << "\t"
+      << "misses: " << m_flowletTable.GetMisses() << "\t"
+      << "collisions: " << m_flowletTable.GetCollisions() << std::endl;
   oss << "===================";
-  NS_LOG_LOGIC (oss.str ());
-*/
+  NS_LOG_LOGIC(oss.str());
+#endif
 }
 
 void Ipv4CongaRouting::PrintDreTable()
 {
-  /*
+#ifdef NS3_LOG_ENABLE
+  if (!g_log.IsEnabled(LOG_LOGIC))
+  {
+    return;
+  }
   std::ostringstream oss;
   std::string switchType = m_isLeaf == true ? "leaf switch" : "spine switch";
-  oss << "==== Local Dre for " << switchType << " ====" <<std::endl;
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr)
+  oss << "==== Local Dre for " << switchType << " ====" << std::endl;
+  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin();
+  for (; itr != m_XMap.end(); ++itr)
   {
-    oss << "port: " << itr->first <<
-      ", X: " << itr->second <<
-      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (itr->second) <<std::endl;
+    oss << "port: " << itr->first << ", X: " << itr->second << ", Quantized X: " << Ipv4CongaRouting::QuantizingX(itr->first, itr->second) << std::endl;
   }
   oss << "=================================";
-  NS_LOG_LOGIC (oss.str ());
-*/
+  NS_LOG_LOGIC(oss.str());
+#endif
 }
 
 } // namespace ns3
@@ -10,18 +10,14 @@
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
 #include <map>
 #include <vector>
 
 namespace ns3 {
 
-//构建的Flowlet
-struct Flowlet {
-  uint32_t port;
-  Time activeTime;
-};
-
 //返回的路由信息
 struct FeedbackInfo {
   uint32_t ce;
@@ -58,6 +54,16 @@ public:
 
   void SetFlowletTimeout (Time timeout);
 
+  // Flowlet table size and collision behavior, setting the size drops all flowlets
+  //设置flowlet表的大小（会清空表）与冲突时的处理方式
+  void SetFlowletTableSize (uint32_t size);
+  uint32_t GetFlowletTableSize (void) const;
+  void SetFlowletCollisionPolicy (FlowletCollisionPolicy policy);
+  FlowletCollisionPolicy GetFlowletCollisionPolicy (void) const;
+
+  // Hit, miss and collision counters live in the table
+  const FlowletTable<uint32_t> &GetFlowletTable (void) const;
+
   void AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId);
 
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
@@ -66,6 +72,9 @@ public:
 
   void EnableEcmpMode ();
 
+  // Assign a fixed stream to the port selection random variable
+  int64_t AssignStreams (int64_t stream);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -126,6 +135,9 @@ private:
   // Ipv4 associated with this router
   //这个路由器的IPV4地址
   Ptr<Ipv4> m_ipv4;
+
+  // Picks one of the equally good candidate ports
+  Ptr<UniformRandomVariable> m_rand;
   //路由表
   // Route table
   std::vector<CongaRouteEntry> m_routeEntryList;
@@ -142,9 +154,9 @@ private:
 
   // Congestion From Leaf Table
   std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;
-  //Flowlet表
-  // Flowlet Table
-  std::map<uint32_t, Flowlet *> m_flowletTable;
+  //Flowlet表，表项的值为端口
+  // Flowlet Table, the value of an entry is the port
+  FlowletTable<uint32_t> m_flowletTable;
 
   // Parameters
   // DRE
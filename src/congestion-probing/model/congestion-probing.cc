@@ -53,13 +53,6 @@ CongestionProbing::GetTypeId (void)
     return tid;
 }
 
-//产生一个介于min到max间的值
-template<typename T>
-T rand_range (T min, T max)
-{
-    return min + ((double)max - min) * rand () / RAND_MAX;
-}
-
 TypeId
 CongestionProbing::GetInstanceTypeId () const
 {
@@ -77,6 +70,7 @@ CongestionProbing::CongestionProbing ()
       m_probeTimeout (Seconds (0.1))
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 CongestionProbing::CongestionProbing (const CongestionProbing &other)
@@ -92,6 +86,7 @@ CongestionProbing::CongestionProbing (const CongestionProbing &other)
       m_probingTimeoutCallback (other.m_probingTimeoutCallback)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 CongestionProbing::~CongestionProbing ()
@@ -134,6 +129,15 @@ CongestionProbing::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+//设置随机变量的流编号
+int64_t
+CongestionProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 //开始探测，调用DoStartProbe
 void
 CongestionProbing::StartProbe ()
@@ -206,7 +210,7 @@ CongestionProbing::ProbeEvent ()
     m_probingTimeoutMap[m_id] = Simulator::Schedule (m_probeTimeout, &CongestionProbing::ProbeEventTimeout, this, m_id);
     
     //加入噪声后的探测时间，根据噪声时间调用探测事件
-    double noise = rand_range (0.0, m_probeTimeout.GetSeconds ());
+    double noise = m_rand->GetValue (0.0, m_probeTimeout.GetSeconds ());
     Time noiseTime = Seconds (noise);
 
     m_probeEvent = Simulator::Schedule (m_probeInterval + noiseTime, &CongestionProbing::ProbeEvent, this);
@@ -8,6 +8,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 #include <vector>
 #include <map>
 
@@ -39,6 +40,8 @@ public:
     void SetPathId (uint32_t pathId);
     void SetNode (Ptr<Node> node);
 
+    int64_t AssignStreams (int64_t stream);
+
     void DoStartProbe ();
     void StartProbe ();
     void DoStopProbe ();
@@ -76,6 +79,9 @@ private:
 
     Time m_probeTimeout;
 
+    //探测间隔上的随机扰动
+    Ptr<UniformRandomVariable> m_rand;
+
     // Trace source
     TracedCallback <uint32_t, Ptr<Packet>, Ipv4Header ,Time, bool> m_probingCallback;
 
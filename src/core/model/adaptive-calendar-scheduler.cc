@@ -0,0 +1,440 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adaptive-calendar-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::AdaptiveCalendarScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AdaptiveCalendarScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (AdaptiveCalendarScheduler);
+
+namespace {
+
+/** Number of nodes allocated at once when the pool runs dry. */
+const uint32_t NODE_CHUNK_SIZE = 1024;
+/** Smallest number of buckets. */
+const uint32_t MIN_BUCKETS = 2;
+/** Largest number of buckets. */
+const uint32_t MAX_BUCKETS = 1 << 22;
+/** Minimum number of operations between two bucket width checks. */
+const uint64_t COST_WINDOW = 4096;
+/** Average buckets scanned or nodes walked per operation that triggers a new width. */
+const uint64_t COST_THRESHOLD = 4;
+
+} // anonymous namespace
+
+TypeId
+AdaptiveCalendarScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::AdaptiveCalendarScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<AdaptiveCalendarScheduler> ()
+  ;
+  return tid;
+}
+
+AdaptiveCalendarScheduler::AdaptiveCalendarScheduler ()
+  : m_mask (MIN_BUCKETS - 1),
+    m_shift (0),
+    m_lastBucket (0),
+    m_bucketTop (1),
+    m_qSize (0),
+    m_nextValid (false),
+    m_nextBucket (0),
+    m_nextTop (0),
+    m_scanCost (0),
+    m_insertCost (0),
+    m_nOps (0),
+    m_free (0)
+{
+  NS_LOG_FUNCTION (this);
+  Bucket empty = { 0, 0 };
+  m_buckets.assign (MIN_BUCKETS, empty);
+}
+
+AdaptiveCalendarScheduler::~AdaptiveCalendarScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Node *>::iterator i = m_chunks.begin (); i != m_chunks.end (); ++i)
+    {
+      delete [] *i;
+    }
+  m_chunks.clear ();
+  m_free = 0;
+}
+
+AdaptiveCalendarScheduler::Node *
+AdaptiveCalendarScheduler::AllocNode (void)
+{
+  if (m_free == 0)
+    {
+      Node *chunk = new Node [NODE_CHUNK_SIZE];
+      m_chunks.push_back (chunk);
+      for (uint32_t i = 0; i < NODE_CHUNK_SIZE; i++)
+        {
+          chunk[i].next = m_free;
+          m_free = &chunk[i];
+        }
+    }
+  Node *node = m_free;
+  m_free = node->next;
+  return node;
+}
+
+void
+AdaptiveCalendarScheduler::FreeNode (Node *node)
+{
+  node->next = m_free;
+  m_free = node;
+}
+
+uint32_t
+AdaptiveCalendarScheduler::Hash (uint64_t ts) const
+{
+  return (ts >> m_shift) & m_mask;
+}
+
+void
+AdaptiveCalendarScheduler::DoInsert (Node *node)
+{
+  Bucket &bucket = m_buckets[Hash (node->ev.key.m_ts)];
+  if (bucket.head == 0)
+    {
+      node->next = 0;
+      bucket.head = node;
+      bucket.tail = node;
+      return;
+    }
+  if (bucket.tail->ev.key < node->ev.key)
+    {
+      // events are mostly scheduled in timestamp order
+      node->next = 0;
+      bucket.tail->next = node;
+      bucket.tail = node;
+      return;
+    }
+  if (node->ev.key < bucket.head->ev.key)
+    {
+      node->next = bucket.head;
+      bucket.head = node;
+      return;
+    }
+  Node *prev = bucket.head;
+  while (prev->next->ev.key < node->ev.key)
+    {
+      prev = prev->next;
+      m_insertCost++;
+    }
+  node->next = prev->next;
+  prev->next = node;
+}
+
+void
+AdaptiveCalendarScheduler::FindNext (void) const
+{
+  if (m_nextValid)
+    {
+      return;
+    }
+  NS_ASSERT (!IsEmpty ());
+  uint32_t nBuckets = m_mask + 1;
+  uint64_t width = uint64_t (1) << m_shift;
+  uint32_t i = m_lastBucket;
+  uint64_t bucketTop = m_bucketTop;
+  const Node *minNode = 0;
+  uint32_t minBucket = 0;
+  for (uint32_t n = 0; n < nBuckets; n++)
+    {
+      const Node *head = m_buckets[i].head;
+      if (head != 0)
+        {
+          if (head->ev.key.m_ts < bucketTop)
+            {
+              m_scanCost += n;
+              m_nextBucket = i;
+              m_nextTop = bucketTop;
+              m_nextValid = true;
+              return;
+            }
+          if (minNode == 0 || head->ev.key < minNode->ev.key)
+            {
+              minNode = head;
+              minBucket = i;
+            }
+        }
+      i = (i + 1) & m_mask;
+      bucketTop += width;
+    }
+  // Nothing in the coming year: jump straight to the earliest event.
+  m_scanCost += nBuckets;
+  m_nextBucket = minBucket;
+  m_nextTop = ((minNode->ev.key.m_ts >> m_shift) + 1) << m_shift;
+  m_nextValid = true;
+}
+
+AdaptiveCalendarScheduler::Node *
+AdaptiveCalendarScheduler::DoRemoveNext (void)
+{
+  FindNext ();
+  Bucket &bucket = m_buckets[m_nextBucket];
+  Node *node = bucket.head;
+  bucket.head = node->next;
+  if (bucket.head == 0)
+    {
+      bucket.tail = 0;
+    }
+  m_lastBucket = m_nextBucket;
+  m_bucketTop = m_nextTop;
+  m_nextValid = false;
+  return node;
+}
+
+void
+AdaptiveCalendarScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  Node *node = AllocNode ();
+  node->ev = ev;
+  DoInsert (node);
+  if (m_nextValid && ev.key < m_buckets[m_nextBucket].head->ev.key)
+    {
+      m_nextValid = false;
+    }
+  m_qSize++;
+  m_nOps++;
+  CheckResize ();
+}
+
+bool
+AdaptiveCalendarScheduler::IsEmpty (void) const
+{
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+AdaptiveCalendarScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FindNext ();
+  return m_buckets[m_nextBucket].head->ev;
+}
+
+Scheduler::Event
+AdaptiveCalendarScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Node *node = DoRemoveNext ();
+  Scheduler::Event ev = node->ev;
+  FreeNode (node);
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts <<
+                ", key=" << ev.key.m_uid <<
+                ", from bucket=" << m_lastBucket);
+  m_qSize--;
+  m_nOps++;
+  CheckResize ();
+  return ev;
+}
+
+void
+AdaptiveCalendarScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint32_t index = Hash (ev.key.m_ts);
+  Bucket &bucket = m_buckets[index];
+  Node *prev = 0;
+  for (Node *node = bucket.head; node != 0; prev = node, node = node->next)
+    {
+      if (node->ev.key.m_uid != ev.key.m_uid)
+        {
+          continue;
+        }
+      NS_ASSERT (ev.impl == node->ev.impl);
+      if (prev == 0)
+        {
+          bucket.head = node->next;
+          if (m_nextValid && m_nextBucket == index)
+            {
+              m_nextValid = false;
+            }
+        }
+      else
+        {
+          prev->next = node->next;
+        }
+      if (bucket.tail == node)
+        {
+          bucket.tail = prev;
+        }
+      FreeNode (node);
+      m_qSize--;
+      CheckResize ();
+      return;
+    }
+  NS_ASSERT (false);
+}
+
+uint32_t
+AdaptiveCalendarScheduler::CalculateNewShift (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_qSize < 2)
+    {
+      return m_shift;
+    }
+  uint32_t nSamples;
+  if (m_qSize <= 5)
+    {
+      nSamples = m_qSize;
+    }
+  else
+    {
+      nSamples = 5 + m_qSize / 10;
+    }
+  if (nSamples > 25)
+    {
+      nSamples = 25;
+    }
+
+  // take the first nSamples events out and put them back.
+  Node *samples[25];
+  uint32_t lastBucket = m_lastBucket;
+  uint64_t bucketTop = m_bucketTop;
+  for (uint32_t i = 0; i < nSamples; i++)
+    {
+      samples[i] = DoRemoveNext ();
+    }
+  for (uint32_t i = 0; i < nSamples; i++)
+    {
+      DoInsert (samples[i]);
+    }
+  m_lastBucket = lastBucket;
+  m_bucketTop = bucketTop;
+  m_nextValid = false;
+
+  // Brown's estimate: three times the average separation, leaving
+  // out separations larger than twice the average.
+  uint64_t totalSeparation = 0;
+  for (uint32_t i = 1; i < nSamples; i++)
+    {
+      totalSeparation += samples[i]->ev.key.m_ts - samples[i - 1]->ev.key.m_ts;
+    }
+  uint64_t twiceAvg = totalSeparation / (nSamples - 1) * 2;
+  totalSeparation = 0;
+  for (uint32_t i = 1; i < nSamples; i++)
+    {
+      uint64_t diff = samples[i]->ev.key.m_ts - samples[i - 1]->ev.key.m_ts;
+      if (diff <= twiceAvg)
+        {
+          totalSeparation += diff;
+        }
+    }
+  uint64_t width = totalSeparation * 3 / (nSamples - 1);
+  if (width == 0)
+    {
+      // all samples share one timestamp, they tell nothing about the width.
+      return m_shift;
+    }
+  uint32_t shift = 0;
+  while (shift < 62 && (uint64_t (2) << shift) <= width)
+    {
+      shift++;
+    }
+  return shift;
+}
+
+void
+AdaptiveCalendarScheduler::DoResize (uint32_t nBuckets, uint32_t shift)
+{
+  NS_LOG_FUNCTION (this << nBuckets << shift);
+
+  // every pending event is at or after the start of the current bucket.
+  uint64_t start = m_bucketTop - (uint64_t (1) << m_shift);
+
+  std::vector<Bucket> oldBuckets;
+  oldBuckets.swap (m_buckets);
+  Bucket empty = { 0, 0 };
+  m_buckets.assign (nBuckets, empty);
+  m_mask = nBuckets - 1;
+  m_shift = shift;
+  m_lastBucket = Hash (start);
+  m_bucketTop = ((start >> m_shift) + 1) << m_shift;
+
+  for (std::vector<Bucket>::iterator i = oldBuckets.begin (); i != oldBuckets.end (); ++i)
+    {
+      Node *node = i->head;
+      while (node != 0)
+        {
+          Node *next = node->next;
+          DoInsert (node);
+          node = next;
+        }
+    }
+  m_nextValid = false;
+  m_scanCost = 0;
+  m_insertCost = 0;
+  m_nOps = 0;
+}
+
+void
+AdaptiveCalendarScheduler::CheckResize (void)
+{
+  uint32_t nBuckets = m_mask + 1;
+  if (m_qSize > nBuckets * 2 && nBuckets < MAX_BUCKETS)
+    {
+      DoResize (nBuckets * 2, CalculateNewShift ());
+    }
+  else if (m_qSize < nBuckets / 4 && nBuckets > MIN_BUCKETS)
+    {
+      DoResize (nBuckets / 2, CalculateNewShift ());
+    }
+  else if (m_nOps >= std::max<uint64_t> (COST_WINDOW, nBuckets))
+    {
+      if (m_scanCost > COST_THRESHOLD * m_nOps && m_shift < 62)
+        {
+          // too many empty buckets: widen them.
+          DoResize (nBuckets, std::max (CalculateNewShift (), m_shift + 1));
+        }
+      else if (m_insertCost > COST_THRESHOLD * m_nOps && m_shift > 0)
+        {
+          // too many events per bucket: narrow them.
+          DoResize (nBuckets, std::min (CalculateNewShift (), m_shift - 1));
+        }
+      else
+        {
+          m_scanCost = 0;
+          m_insertCost = 0;
+          m_nOps = 0;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ADAPTIVE_CALENDAR_SCHEDULER_H
+#define ADAPTIVE_CALENDAR_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::AdaptiveCalendarScheduler class.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a calendar queue event scheduler with adaptive bucket width
+ *
+ * This is a calendar queue in the spirit of ns3::CalendarScheduler,
+ * tuned for event sets where millions of events are clustered within a
+ * few microseconds (per-packet transmit and receive events) while a
+ * long tail of timers sits milliseconds away:
+ *  - the number of buckets and the bucket width are powers of two, so
+ *    hashing an event to its bucket is a shift and a mask;
+ *  - each bucket is a sorted singly linked list with a tail pointer, so
+ *    events scheduled in timestamp order are appended in O(1);
+ *  - list nodes come from a pool owned by the scheduler, so Insert and
+ *    RemoveNext do not hit the allocator in steady state;
+ *  - besides resizing when the population doubles or shrinks, the
+ *    scheduler monitors the number of empty buckets it scans per dequeue
+ *    and the number of nodes it walks per enqueue, and re-computes the
+ *    bucket width when either gets too high;
+ *  - the event found by PeekNext is remembered, so the following
+ *    RemoveNext does not search for it again.
+ */
+class AdaptiveCalendarScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  AdaptiveCalendarScheduler ();
+  /** Destructor. */
+  virtual ~AdaptiveCalendarScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A pooled list node holding one Event. */
+  struct Node
+  {
+    Scheduler::Event ev;   /**< The event. */
+    Node *next;            /**< Next node in the bucket or in the free list. */
+  };
+  /** A calendar bucket: sorted list of nodes. */
+  struct Bucket
+  {
+    Node *head;            /**< Earliest event of the bucket. */
+    Node *tail;            /**< Latest event of the bucket. */
+  };
+
+  /**
+   * Get a node from the pool, growing the pool if it is empty.
+   * \returns A free node.
+   */
+  Node *AllocNode (void);
+  /**
+   * Give a node back to the pool.
+   * \param [in] node The node.
+   */
+  void FreeNode (Node *node);
+  /**
+   * Hash the dimensionless time to a bucket.
+   *
+   * \param [in] ts The dimensionless time.
+   * \returns The bucket index.
+   */
+  inline uint32_t Hash (uint64_t ts) const;
+  /**
+   * Link a node in its bucket, keeping the bucket sorted.
+   * \param [in] node The node.
+   */
+  void DoInsert (Node *node);
+  /**
+   * Find the bucket holding the earliest event and cache it.
+   */
+  void FindNext (void) const;
+  /**
+   * Unlink the earliest event and advance the calendar to it.
+   * \returns The node of the earliest event.
+   */
+  Node *DoRemoveNext (void);
+  /**
+   * Compute the bucket width from the separation of the earliest events.
+   * \returns The log2 of the new width.
+   */
+  uint32_t CalculateNewShift (void);
+  /**
+   * Re-hash all events in a new calendar.
+   * \param [in] nBuckets The new number of buckets, a power of two.
+   * \param [in] shift The log2 of the new bucket width.
+   */
+  void DoResize (uint32_t nBuckets, uint32_t shift);
+  /** Resize the calendar if the population or the access costs call for it. */
+  void CheckResize (void);
+
+  /** Calendar buckets. */
+  std::vector<Bucket> m_buckets;
+  /** Number of buckets minus one. */
+  uint32_t m_mask;
+  /** log2 of the bucket width, in dimensionless time units. */
+  uint32_t m_shift;
+  /** Bucket index from which the last event was dequeued. */
+  uint32_t m_lastBucket;
+  /** Priority at the top of the bucket from which last event was dequeued. */
+  uint64_t m_bucketTop;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+
+  /** Whether m_nextBucket and m_nextTop locate the earliest event. */
+  mutable bool m_nextValid;
+  /** Bucket holding the earliest event. */
+  mutable uint32_t m_nextBucket;
+  /** Priority at the top of m_nextBucket's current year. */
+  mutable uint64_t m_nextTop;
+
+  /** Buckets scanned by FindNext since the last width check. */
+  mutable uint64_t m_scanCost;
+  /** Nodes walked by DoInsert since the last width check. */
+  uint64_t m_insertCost;
+  /** Insert and RemoveNext operations since the last width check. */
+  uint64_t m_nOps;
+
+  /** Chunks of nodes owned by the pool. */
+  std::vector<Node *> m_chunks;
+  /** Free nodes. */
+  Node *m_free;
+};
+
+} // namespace ns3
+
+#endif /* ADAPTIVE_CALENDAR_SCHEDULER_H */
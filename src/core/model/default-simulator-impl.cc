@@ -22,13 +22,18 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "nstime.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <iostream>
+#include <vector>
 
 
 /**
@@ -46,6 +51,12 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+/**
+ * Minimum number of cancelled events in the queue before it is
+ * compacted; below this the purge would not pay for itself.
+ */
+static const uint32_t COMPACTION_MIN_CANCELLED = 1024;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +64,19 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("Profile",
+                   "Attribute the wall time to the scheduled event types, "
+                   "sample the memory and the event queue, and print a report "
+                   "at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfileInterval",
+                   "The simulated time between two samples of the memory and "
+                   "the event queue when profiling.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&DefaultSimulatorImpl::m_profileInterval),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -71,13 +95,18 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
+  m_compactions = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profile = false;
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -108,6 +137,12 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      m_profiler->Report (std::cout, m_currentTs, m_unscheduledEvents);
+      delete m_profiler;
+      m_profiler = 0;
+    }
 }
 
 void
@@ -141,12 +176,23 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
+  if (next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Invoke (next.impl, m_currentTs, m_unscheduledEvents);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -196,6 +242,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profile && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler (m_profileInterval.GetTimeStep ());
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -363,7 +413,46 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () == 2)
+        {
+          // destroy events are not in the event queue.
+          return;
+        }
+      m_cancelledEvents++;
+      if (m_cancelledEvents >= COMPACTION_MIN_CANCELLED
+          && m_cancelledEvents * 2 > (uint32_t)m_unscheduledEvents)
+        {
+          CompactEvents ();
+        }
+    }
+}
+
+void
+DefaultSimulatorImpl::CompactEvents (void)
+{
+  NS_LOG_FUNCTION (this << m_unscheduledEvents << m_cancelledEvents);
+  std::vector<Scheduler::Event> live;
+  live.reserve (m_unscheduledEvents - m_cancelledEvents);
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          // whenever we remove an event from the event list, we have to unref it.
+          next.impl->Unref ();
+          m_unscheduledEvents--;
+        }
+      else
+        {
+          live.push_back (next);
+        }
     }
+  for (std::vector<Scheduler::Event>::const_iterator i = live.begin (); i != live.end (); i++)
+    {
+      m_events->Insert (*i);
+    }
+  m_cancelledEvents = 0;
+  m_compactions++;
 }
 
 bool
@@ -414,4 +503,28 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint32_t
+DefaultSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetCancelledEventCount (void) const
+{
+  return m_cancelledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetLiveEventCount (void) const
+{
+  return m_unscheduledEvents - m_cancelledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetCompactionCount (void) const
+{
+  return m_compactions;
+}
+
 } // namespace ns3
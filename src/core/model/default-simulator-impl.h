@@ -26,6 +26,7 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
+#include "nstime.h"
 
 #include "ptr.h"
 
@@ -39,6 +40,8 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
@@ -78,6 +81,26 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \returns The number of events held by the event queue, including
+   *          the cancelled events which have not been purged yet.
+   */
+  uint32_t GetPendingEventCount (void) const;
+  /**
+   * \returns The number of cancelled events still held by the event
+   *          queue.
+   */
+  uint32_t GetCancelledEventCount (void) const;
+  /**
+   * \returns The number of events in the event queue which will
+   *          actually be run.
+   */
+  uint32_t GetLiveEventCount (void) const;
+  /**
+   * \returns The number of times the event queue has been compacted.
+   */
+  uint32_t GetCompactionCount (void) const;
+
 private:
   virtual void DoDispose (void);
 
@@ -85,6 +108,16 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Purge the cancelled events from the event queue.
+   *
+   * Cancel() only flags an event, so timers which are rescheduled
+   * over and over leave their cancelled events behind until their
+   * timestamp is reached.  Once these make up most of the queue they
+   * are all dropped in one pass, which keeps the queue size bounded
+   * by the number of live events.
+   */
+  void CompactEvents (void);
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -129,9 +162,20 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /** Number of cancelled events still in the event queue. */
+  uint32_t m_cancelledEvents;
+  /** Number of calls to CompactEvents(). */
+  uint32_t m_compactions;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Profile the events run, see EventProfiler. */
+  bool m_profile;
+  /** Simulated time between two profiler samples. */
+  Time m_profileInterval;
+  /** The profiler, created by Run() when profiling. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
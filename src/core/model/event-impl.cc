@@ -21,6 +21,8 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +33,72 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the event size classes, in bytes. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes; larger events use the global heap. */
+const std::size_t EVENT_POOL_CLASSES = 16;
+/** Maximum number of free blocks kept per size class and thread. */
+const uint32_t EVENT_POOL_MAX_FREE = 65536;
+
+/** A free block, linked into the freelist of its size class. */
+struct EventPoolBlock
+{
+  EventPoolBlock *next; //!< Next free block of the same size class.
+};
+
+/**
+ * The per-thread event freelists.
+ *
+ * This is a plain aggregate so that it is constant-initialized and
+ * remains usable while other thread-local and static objects are being
+ * destroyed: once \c dead is set, blocks go straight back to the heap.
+ */
+struct EventPool
+{
+  EventPoolBlock *free[EVENT_POOL_CLASSES]; //!< Freelist heads.
+  uint32_t count[EVENT_POOL_CLASSES];       //!< Freelist lengths.
+  bool dead;                                //!< Thread is exiting.
+};
+
+thread_local EventPool g_eventPool;
+
+/** Releases the cached blocks of a thread when it exits. */
+struct EventPoolReaper
+{
+  bool armed; //!< Touched to register the destructor.
+  ~EventPoolReaper ()
+  {
+    for (std::size_t i = 0; i < EVENT_POOL_CLASSES; i++)
+      {
+        while (g_eventPool.free[i] != 0)
+          {
+            EventPoolBlock *block = g_eventPool.free[i];
+            g_eventPool.free[i] = block->next;
+            ::operator delete (block);
+          }
+        g_eventPool.count[i] = 0;
+      }
+    g_eventPool.dead = true;
+  }
+};
+
+thread_local EventPoolReaper g_eventPoolReaper;
+
+/**
+ * \param [in] size The size of an event.
+ * \returns The size class of the event, or EVENT_POOL_CLASSES if it
+ *          is too large to be pooled.
+ */
+inline std::size_t
+EventPoolClass (std::size_t size)
+{
+  return (size + EVENT_POOL_GRANULARITY - 1) / EVENT_POOL_GRANULARITY - 1;
+}
+
+} // unnamed namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +134,45 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t cls = EventPoolClass (size);
+  if (cls < EVENT_POOL_CLASSES && g_eventPool.free[cls] != 0)
+    {
+      EventPoolBlock *block = g_eventPool.free[cls];
+      g_eventPool.free[cls] = block->next;
+      g_eventPool.count[cls]--;
+      return block;
+    }
+  if (cls < EVENT_POOL_CLASSES)
+    {
+      // allocate the whole size class so that the block can be
+      // reused by any event of the same class.
+      return ::operator new ((cls + 1) * EVENT_POOL_GRANULARITY);
+    }
+  return ::operator new (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t cls = EventPoolClass (size);
+  if (cls < EVENT_POOL_CLASSES && !g_eventPool.dead
+      && g_eventPool.count[cls] < EVENT_POOL_MAX_FREE)
+    {
+      g_eventPoolReaper.armed = true;
+      EventPoolBlock *block = static_cast<EventPoolBlock *> (p);
+      block->next = g_eventPool.free[cls];
+      g_eventPool.free[cls] = block;
+      g_eventPool.count[cls]++;
+      return;
+    }
+  ::operator delete (p);
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,11 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated and released at a very high rate, so EventImpl
+ * provides class-specific allocation functions: the storage of small
+ * events is recycled through per-thread, per-size freelists instead of
+ * going back to the global heap each time.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +72,23 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the storage of an event from the per-thread freelist
+   * matching its size.
+   *
+   * \param [in] size The size of the concrete event type.
+   * \returns The event storage.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the storage of an event to the per-thread freelist
+   * matching its size.
+   *
+   * \param [in] p The event storage.
+   * \param [in] size The size of the concrete event type.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "event-profiler.h"
+#include "nstime.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <string>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#include <sys/resource.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler definitions.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/** Number of rows of the memory timeline in the report. */
+const uint32_t EVENT_PROFILER_TIMELINE_ROWS = 20;
+
+/**
+ * \returns The resident set size of the process in bytes, or 0 where
+ *          it cannot be read.
+ */
+uint64_t
+GetResidentSetSize (void)
+{
+#ifdef __linux__
+  FILE *statm = std::fopen ("/proc/self/statm", "r");
+  if (statm == 0)
+    {
+      return 0;
+    }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int n = std::fscanf (statm, "%lu %lu", &size, &resident);
+  std::fclose (statm);
+  return n == 2 ? static_cast<uint64_t> (resident) * sysconf (_SC_PAGESIZE) : 0;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * \returns The peak resident set size of the process in bytes.
+ */
+uint64_t
+GetPeakResidentSetSize (void)
+{
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    {
+      return 0;
+    }
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return static_cast<uint64_t> (usage.ru_maxrss) * 1024;
+#endif
+}
+
+/**
+ * Get a readable name for an EventImpl type.
+ *
+ * The events made by MakeEvent are local classes of its instantiations,
+ * so their name is reduced to the MakeEvent template arguments, i.e. the
+ * scheduled function type and the bound argument types.
+ *
+ * \param [in] type The type.
+ * \returns The name.
+ */
+std::string
+GetEventTypeName (const std::type_info &type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), 0, 0, &status);
+  if (status == 0 && demangled != 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  std::string::size_type begin = name.find ("MakeEvent<");
+  if (begin != std::string::npos)
+    {
+      uint32_t depth = 0;
+      for (std::string::size_type i = begin + 9; i < name.size (); i++)
+        {
+          if (name[i] == '<')
+            {
+              depth++;
+            }
+          else if (name[i] == '>' && --depth == 0)
+            {
+              return name.substr (begin, i + 1 - begin);
+            }
+        }
+    }
+  return name;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler (uint64_t interval)
+  : m_interval (std::max<uint64_t> (interval, 1)),
+    m_nextSample (0),
+    m_invoked (0),
+    m_cancelled (0),
+    m_start (std::chrono::steady_clock::now ())
+{
+  NS_LOG_FUNCTION (this << interval);
+}
+
+void
+EventProfiler::Sample (uint64_t ts, uint32_t pending)
+{
+  EventSample sample;
+  sample.ts = ts;
+  sample.wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+  sample.events = m_invoked;
+  sample.rss = GetResidentSetSize ();
+  sample.pending = pending;
+  m_samples.push_back (sample);
+  m_nextSample = (ts / m_interval + 1) * m_interval;
+}
+
+void
+EventProfiler::Report (std::ostream &os, uint64_t ts, uint32_t pending)
+{
+  NS_LOG_FUNCTION (this << ts << pending);
+  Sample (ts, pending);
+  double wall = m_samples.back ().wall;
+
+  // 同名的类型在不同的共享库中可能有不同的type_info
+  std::map<std::string, EventCost> costs;
+  uint64_t eventNs = 0;
+  for (std::unordered_map<const std::type_info *, EventCost>::const_iterator it = m_costs.begin ();
+       it != m_costs.end (); ++it)
+    {
+      EventCost &cost = costs[GetEventTypeName (*it->first)];
+      cost.count += it->second.count;
+      cost.ns += it->second.ns;
+      eventNs += it->second.ns;
+    }
+  std::vector<std::pair<uint64_t, std::string> > ranked;
+  for (std::map<std::string, EventCost>::const_iterator it = costs.begin (); it != costs.end (); ++it)
+    {
+      ranked.push_back (std::make_pair (it->second.ns, it->first));
+    }
+  std::sort (ranked.rbegin (), ranked.rend ());
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::setprecision (3);
+  os << "Event profile: " << m_invoked << " events in " << wall << " s of wall time ("
+     << (wall > 0 ? m_invoked / wall : 0) << " events/s), "
+     << TimeStep (ts).GetSeconds () << " s simulated, "
+     << m_cancelled << " cancelled events skipped" << std::endl;
+  os << "  time in events " << eventNs / 1e9 << " s, in the scheduler and the profiler "
+     << std::max (wall - eventNs / 1e9, 0.0) << " s" << std::endl;
+  os << std::setw (9) << "wall%" << std::setw (12) << "total(s)" << std::setw (12) << "events"
+     << std::setw (12) << "ns/event" << "  type" << std::endl;
+  for (uint32_t i = 0; i < ranked.size (); i++)
+    {
+      const EventCost &cost = costs[ranked[i].second];
+      os << std::setw (9) << (eventNs > 0 ? 100.0 * cost.ns / eventNs : 0)
+         << std::setw (12) << cost.ns / 1e9
+         << std::setw (12) << cost.count
+         << std::setw (12) << std::setprecision (1) << (cost.count > 0 ? double (cost.ns) / cost.count : 0)
+         << std::setprecision (3) << "  " << ranked[i].second << std::endl;
+    }
+
+  os << "Memory timeline: peak rss " << GetPeakResidentSetSize () / 1048576.0 << " MB" << std::endl;
+  os << std::setw (12) << "time(s)" << std::setw (12) << "wall(s)" << std::setw (12) << "events"
+     << std::setw (12) << "pending" << std::setw (12) << "rss(MB)" << std::endl;
+  uint32_t step = (m_samples.size () + EVENT_PROFILER_TIMELINE_ROWS - 1) / EVENT_PROFILER_TIMELINE_ROWS;
+  for (uint32_t i = 0; i < m_samples.size (); i++)
+    {
+      if (i % step != 0 && i + 1 != m_samples.size ())
+        {
+          continue;
+        }
+      const EventSample &sample = m_samples[i];
+      os << std::setw (12) << TimeStep (sample.ts).GetSeconds ()
+         << std::setw (12) << sample.wall
+         << std::setw (12) << sample.events
+         << std::setw (12) << sample.pending
+         << std::setw (12) << sample.rss / 1048576.0 << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+} // namespace ns3
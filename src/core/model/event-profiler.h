@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef NS3_EVENT_PROFILER_H
+#define NS3_EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Attribute the wall time of a simulation to the scheduled events
+ *
+ * The simulator hands every event it runs to Invoke(), which counts it
+ * and measures its wall time under the dynamic type of its EventImpl:
+ * one type per MakeEvent instantiation, i.e. per signature of the
+ * scheduled member function or function.  Every sampling interval of
+ * simulated time it also records the resident set size and the number
+ * of pending events.
+ *
+ * Enabled through the DefaultSimulatorImpl::Profile attribute, which
+ * prints the report at Simulator::Destroy.
+ */
+class EventProfiler
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] interval The sampling interval, in simulator time steps.
+   */
+  EventProfiler (uint64_t interval);
+
+  /**
+   * Run an event and account for it.
+   *
+   * \param [in] event The event.
+   * \param [in] ts The timestamp of the event, in time steps.
+   * \param [in] pending The number of events left in the event queue.
+   */
+  void Invoke (EventImpl *event, uint64_t ts, uint32_t pending)
+  {
+    if (ts >= m_nextSample)
+      {
+        Sample (ts, pending);
+      }
+    if (event->IsCancelled ())
+      {
+        m_cancelled++;
+        return;
+      }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+    event->Invoke ();
+    m_invoked++;
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+    EventCost &cost = m_costs[&typeid (*event)];
+    cost.count++;
+    cost.ns += std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ();
+  }
+
+  /**
+   * Print the events per second, the events ranked by wall time and the
+   * memory timeline.
+   *
+   * \param [in] os The output stream.
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of events left in the event queue.
+   */
+  void Report (std::ostream &os, uint64_t ts, uint32_t pending);
+
+private:
+  /**
+   * Record the memory and event queue state.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   * \param [in] pending The number of events in the event queue.
+   */
+  void Sample (uint64_t ts, uint32_t pending);
+
+  /** The events of one type. */
+  struct EventCost
+  {
+    uint64_t count; //!< Events run.
+    uint64_t ns;    //!< Wall time spent in them.
+    EventCost ()
+      : count (0),
+        ns (0)
+    {
+    }
+  };
+
+  /** The state at a sampling point. */
+  struct EventSample
+  {
+    uint64_t ts;      //!< Simulation time, in time steps.
+    double wall;      //!< Wall time since the profiler started, in seconds.
+    uint64_t events;  //!< Events run so far.
+    uint64_t rss;     //!< Resident set size, in bytes.
+    uint32_t pending; //!< Events in the event queue.
+  };
+
+  /** The costs, by EventImpl type. */
+  std::unordered_map<const std::type_info *, EventCost> m_costs;
+  std::vector<EventSample> m_samples; //!< The samples, in time order.
+  uint64_t m_interval;                //!< Sampling interval, in time steps.
+  uint64_t m_nextSample;              //!< Time of the next sample.
+  uint64_t m_invoked;                 //!< Events run.
+  uint64_t m_cancelled;               //!< Cancelled events skipped.
+  /** When the profiler was created. */
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace ns3
+
+#endif /* NS3_EVENT_PROFILER_H */
@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "event-trace.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup eventtrace
+ * ns3::EventTrace definitions.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventTrace");
+
+bool EventTrace::m_enabled = false;
+
+namespace {
+
+/** Number of records a thread buffers before writing them out. */
+const uint32_t EVENT_TRACE_BUFFER_SIZE = 4096;
+/** Chunk kind naming an event. */
+const uint32_t EVENT_TRACE_CHUNK_NAME = 1;
+/** Chunk kind holding records. */
+const uint32_t EVENT_TRACE_CHUNK_RECORDS = 2;
+
+/** An event, as written to the file. */
+struct EventTraceRecord
+{
+  int64_t time;      //!< Simulation time, in nanoseconds.
+  uint32_t context;  //!< Simulator context.
+  uint16_t id;       //!< Event id.
+  uint16_t n;        //!< Number of values.
+  uint32_t value[4]; //!< Values.
+};
+
+/** The records of a thread not written out yet. */
+struct EventTraceBuffer
+{
+  uint32_t thread;                                   //!< Thread index.
+  uint32_t count;                                    //!< Buffered records.
+  EventTraceRecord records[EVENT_TRACE_BUFFER_SIZE]; //!< Records.
+};
+
+/** The output file and the registered events, shared by the threads. */
+struct EventTraceFile
+{
+  std::mutex mutex;                 //!< Guards the members below.
+  bool initialized;                 //!< NS_EVENT_TRACE has been read.
+  std::ofstream out;                //!< Output file.
+  std::vector<std::string> names;   //!< Registered "component\0event\0", by id.
+  uint32_t threads;                 //!< Threads that recorded so far.
+
+  EventTraceFile ()
+    : initialized (false),
+      threads (0)
+  {
+  }
+};
+
+/**
+ * \returns The shared output file, constructed on first use so that it
+ *          outlives the thread buffers of the main thread.
+ */
+EventTraceFile &
+GetEventTraceFile (void)
+{
+  static EventTraceFile file;
+  return file;
+}
+
+/**
+ * Write the buffered records of a thread and empty its buffer.
+ *
+ * \param [in] buffer The buffer of the thread.
+ */
+void
+SpillEventTraceBuffer (EventTraceBuffer *buffer)
+{
+  EventTraceFile &file = GetEventTraceFile ();
+  std::lock_guard<std::mutex> lock (file.mutex);
+  if (buffer->count > 0 && file.out.is_open ())
+    {
+      uint32_t header[4] = { EVENT_TRACE_CHUNK_RECORDS,
+                             static_cast<uint32_t> (8 + buffer->count * sizeof (EventTraceRecord)),
+                             buffer->thread, buffer->count };
+      file.out.write (reinterpret_cast<const char *> (header), sizeof (header));
+      file.out.write (reinterpret_cast<const char *> (buffer->records),
+                      buffer->count * sizeof (EventTraceRecord));
+    }
+  buffer->count = 0;
+}
+
+thread_local EventTraceBuffer *g_eventTraceBuffer = 0;
+
+/** Writes out and releases the buffer of a thread when it exits. */
+struct EventTraceReaper
+{
+  bool armed; //!< Touched to register the destructor.
+  ~EventTraceReaper ()
+  {
+    if (g_eventTraceBuffer != 0)
+      {
+        SpillEventTraceBuffer (g_eventTraceBuffer);
+        delete g_eventTraceBuffer;
+        g_eventTraceBuffer = 0;
+      }
+  }
+};
+
+thread_local EventTraceReaper g_eventTraceReaper;
+
+} // unnamed namespace
+
+uint16_t
+EventTrace::Register (const char *component, const char *event)
+{
+  EventTraceFile &file = GetEventTraceFile ();
+  std::lock_guard<std::mutex> lock (file.mutex);
+  if (!file.initialized)
+    {
+      file.initialized = true;
+      const char *filename = std::getenv ("NS_EVENT_TRACE");
+      if (filename != 0 && filename[0] != '\0')
+        {
+          file.out.open (filename, std::ios::out | std::ios::binary);
+          if (file.out.is_open ())
+            {
+              file.out.write ("NS3EVTR1", 8);
+              m_enabled = true;
+            }
+          else
+            {
+              NS_LOG_ERROR ("Cannot open " << filename);
+            }
+        }
+    }
+
+  std::string name = std::string (component) + '\0' + event + '\0';
+  for (uint32_t i = 0; i < file.names.size (); i++)
+    {
+      if (file.names[i] == name)
+        {
+          return i;
+        }
+    }
+  NS_ASSERT_MSG (file.names.size () < 0xffff, "Too many traced events");
+  uint32_t id = file.names.size ();
+  file.names.push_back (name);
+  if (file.out.is_open ())
+    {
+      uint32_t header[3] = { EVENT_TRACE_CHUNK_NAME,
+                             static_cast<uint32_t> (4 + name.size ()), id };
+      file.out.write (reinterpret_cast<const char *> (header), sizeof (header));
+      file.out.write (name.data (), name.size ());
+    }
+  return id;
+}
+
+void
+EventTrace::Flush (void)
+{
+  if (g_eventTraceBuffer != 0)
+    {
+      SpillEventTraceBuffer (g_eventTraceBuffer);
+    }
+  EventTraceFile &file = GetEventTraceFile ();
+  std::lock_guard<std::mutex> lock (file.mutex);
+  if (file.out.is_open ())
+    {
+      file.out.flush ();
+    }
+}
+
+void
+EventTrace::Append (uint16_t id, uint16_t n, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+  EventTraceBuffer *buffer = g_eventTraceBuffer;
+  if (buffer == 0)
+    {
+      buffer = new EventTraceBuffer;
+      buffer->count = 0;
+      {
+        EventTraceFile &file = GetEventTraceFile ();
+        std::lock_guard<std::mutex> lock (file.mutex);
+        buffer->thread = file.threads++;
+      }
+      g_eventTraceBuffer = buffer;
+      g_eventTraceReaper.armed = true;
+    }
+
+  EventTraceRecord &record = buffer->records[buffer->count];
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.context = Simulator::GetContext ();
+  record.id = id;
+  record.n = n;
+  record.value[0] = a;
+  record.value[1] = b;
+  record.value[2] = c;
+  record.value[3] = d;
+  if (++buffer->count == EVENT_TRACE_BUFFER_SIZE)
+    {
+      SpillEventTraceBuffer (buffer);
+    }
+}
+
+} // namespace ns3
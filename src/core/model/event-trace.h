@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef NS3_EVENT_TRACE_H
+#define NS3_EVENT_TRACE_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup eventtrace
+ * NS_EVENT_TRACE macro and ns3::EventTrace declaration.
+ */
+
+/**
+ * \ingroup debugging
+ * \defgroup eventtrace Event tracing
+ *
+ * \brief Binary event records for the hot paths
+ *
+ * Where a log message would cost too much even when its component is
+ * disabled, a model records a fixed-size binary event instead: the
+ * simulation time, the context, a component and event name pair and up
+ * to four 32-bit integers.  Nothing is formatted while the simulation
+ * runs; utils/decode-event-trace.py turns the records back into text.
+ *
+ * NS_EVENT_TRACE compiles to nothing unless ns-3 is configured with
+ * --enable-event-trace, and its arguments are then never evaluated.
+ * When compiled in, the records are kept only if the NS_EVENT_TRACE
+ * environment variable names the output file, e.g.
+ * \code
+ *   $ NS_EVENT_TRACE=events.bin ./waf --run ...
+ *   $ ./utils/decode-event-trace.py events.bin
+ * \endcode
+ *
+ * Each thread appends to its own buffer, which is written out when it
+ * fills up, when the thread exits and on EventTrace::Flush.
+ */
+
+#ifdef NS3_EVENT_TRACE_ENABLE
+
+/**
+ * \ingroup eventtrace
+ * Record an event.
+ *
+ * \param [in] component The component name, a string literal.
+ * \param [in] event The event name, a string literal.
+ * \param [in] ... One to four values converted to uint32_t.
+ */
+#define NS_EVENT_TRACE(component, event, ...)                           \
+  do                                                                    \
+    {                                                                   \
+      static const uint16_t ns3EventTraceId =                           \
+        ::ns3::EventTrace::Register (component, event);                 \
+      if (::ns3::EventTrace::IsEnabled ())                              \
+        {                                                               \
+          ::ns3::EventTrace::Record (ns3EventTraceId, __VA_ARGS__);     \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
+#else /* NS3_EVENT_TRACE_ENABLE */
+
+#define NS_EVENT_TRACE(component, event, ...)                           \
+  do                                                                    \
+    {                                                                   \
+      if (false)                                                        \
+        {                                                               \
+          ::ns3::EventTrace::Record (0, __VA_ARGS__);                   \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
+#endif /* NS3_EVENT_TRACE_ENABLE */
+
+namespace ns3 {
+
+/**
+ * \ingroup eventtrace
+ * \brief Recorder behind NS_EVENT_TRACE
+ *
+ * The file starts with the 8 bytes "NS3EVTR1", followed by chunks made
+ * of a uint32_t kind and a uint32_t payload size, in host byte order:
+ * - kind 1 names an event: uint32_t id, then the component and event
+ *   names, each terminated by a NUL;
+ * - kind 2 holds records: uint32_t thread, uint32_t count, then count
+ *   records of int64_t time in nanoseconds, uint32_t context, uint16_t
+ *   id, uint16_t number of values and uint32_t values[4].
+ */
+class EventTrace
+{
+public:
+  /**
+   * Get the id of an event, registering it on first use.
+   *
+   * \param [in] component The component name.
+   * \param [in] event The event name.
+   * \returns The id of the event.
+   */
+  static uint16_t Register (const char *component, const char *event);
+
+  /**
+   * \returns true if the records are kept, i.e. NS_EVENT_TRACE was set
+   *          when the first event was registered.
+   */
+  static bool IsEnabled (void)
+  {
+    return m_enabled;
+  }
+
+  /**
+   * Write out the records of the calling thread.
+   */
+  static void Flush (void);
+
+  /**
+   * \name Record an event
+   * \param [in] id The id of the event.
+   * \param [in] a,b,c,d The values of the event.
+   */
+  /** @{ */
+  static void Record (uint16_t id, uint32_t a)
+  {
+    Append (id, 1, a, 0, 0, 0);
+  }
+  static void Record (uint16_t id, uint32_t a, uint32_t b)
+  {
+    Append (id, 2, a, b, 0, 0);
+  }
+  static void Record (uint16_t id, uint32_t a, uint32_t b, uint32_t c)
+  {
+    Append (id, 3, a, b, c, 0);
+  }
+  static void Record (uint16_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+  {
+    Append (id, 4, a, b, c, d);
+  }
+  /** @} */
+
+private:
+  /**
+   * Append a record to the buffer of the calling thread.
+   *
+   * \param [in] id The id of the event.
+   * \param [in] n The number of values.
+   * \param [in] a,b,c,d The values, unused ones being 0.
+   */
+  static void Append (uint16_t id, uint16_t n, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+
+  static bool m_enabled; //!< Records are kept.
+};
+
+} // namespace ns3
+
+#endif /* NS3_EVENT_TRACE_H */
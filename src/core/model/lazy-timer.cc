@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "lazy-timer.h"
+#include "simulator.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup timer
+ * ns3::LazyTimer timer class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LazyTimer");
+
+LazyTimer::LazyTimer ()
+  : m_impl (0),
+    m_event (),
+    m_end (Seconds (0)),
+    m_running (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LazyTimer::~LazyTimer ()
+{
+  NS_LOG_FUNCTION (this);
+  // the pending event points back to this timer.
+  Simulator::Cancel (m_event);
+  delete m_impl;
+}
+
+void
+LazyTimer::Schedule (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_end = Simulator::Now () + delay;
+  m_running = true;
+  if (m_event.IsRunning ())
+    {
+      if (TimeStep (m_event.GetTs ()) <= m_end)
+        {
+          // the pending event will push itself to the new deadline.
+          return;
+        }
+      m_event.Cancel ();
+    }
+  m_event = Simulator::Schedule (delay, &LazyTimer::Expire, this);
+}
+
+void
+LazyTimer::Cancel (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_running = false;
+}
+
+bool
+LazyTimer::IsRunning (void) const
+{
+  return m_running;
+}
+
+bool
+LazyTimer::IsExpired (void) const
+{
+  return !m_running;
+}
+
+Time
+LazyTimer::GetDelayLeft (void) const
+{
+  if (!m_running)
+    {
+      return Seconds (0);
+    }
+  return m_end - Simulator::Now ();
+}
+
+void
+LazyTimer::Expire (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_running)
+    {
+      return;
+    }
+  if (m_end > Simulator::Now ())
+    {
+      m_event = Simulator::Schedule (m_end - Simulator::Now (), &LazyTimer::Expire, this);
+      return;
+    }
+  m_running = false;
+  m_impl->Invoke ();
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "recording-scheduler.h"
+#include "object-factory.h"
+#include "string.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::RecordingScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RecordingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (RecordingScheduler);
+
+TypeId
+RecordingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RecordingScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<RecordingScheduler> ()
+    .AddAttribute ("Scheduler",
+                   "The TypeId of the scheduler whose operations are recorded.",
+                   StringValue ("ns3::MapScheduler"),
+                   MakeStringAccessor (&RecordingScheduler::m_schedulerType),
+                   MakeStringChecker ())
+    .AddAttribute ("FileName",
+                   "The file the scheduler operations are written to.",
+                   StringValue ("scheduler-ops.tr"),
+                   MakeStringAccessor (&RecordingScheduler::m_fileName),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+RecordingScheduler::RecordingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RecordingScheduler::~RecordingScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RecordingScheduler::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  ObjectFactory factory (m_schedulerType);
+  m_scheduler = factory.Create<Scheduler> ();
+  m_trace.open (m_fileName.c_str ());
+  if (!m_trace)
+    {
+      NS_FATAL_ERROR ("Could not open scheduler trace file " << m_fileName);
+    }
+  Scheduler::NotifyConstructionCompleted ();
+}
+
+void
+RecordingScheduler::Insert (const Event &ev)
+{
+  m_trace << "i " << ev.key.m_ts << " " << ev.key.m_uid << "\n";
+  m_scheduler->Insert (ev);
+}
+
+bool
+RecordingScheduler::IsEmpty (void) const
+{
+  return m_scheduler->IsEmpty ();
+}
+
+Scheduler::Event
+RecordingScheduler::PeekNext (void) const
+{
+  return m_scheduler->PeekNext ();
+}
+
+Scheduler::Event
+RecordingScheduler::RemoveNext (void)
+{
+  m_trace << "r\n";
+  return m_scheduler->RemoveNext ();
+}
+
+void
+RecordingScheduler::Remove (const Event &ev)
+{
+  m_trace << "x " << ev.key.m_ts << " " << ev.key.m_uid << "\n";
+  m_scheduler->Remove (ev);
+}
+
+} // namespace ns3
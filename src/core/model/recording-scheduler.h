@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RECORDING_SCHEDULER_H
+#define RECORDING_SCHEDULER_H
+
+#include "scheduler.h"
+#include "ptr.h"
+#include <stdint.h>
+#include <string>
+#include <fstream>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::RecordingScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a scheduler which records the operations done on another one
+ *
+ * Every operation is forwarded to a scheduler of type \c Scheduler and
+ * written to \c FileName, one per line:
+ *  - <tt>i <ts> <uid></tt> for Insert,
+ *  - <tt>r</tt> for RemoveNext,
+ *  - <tt>x <ts> <uid></tt> for Remove.
+ *
+ * The resulting event-time trace of a real simulation can be replayed
+ * against every scheduler with <tt>bench-simulator --replay=<file></tt>
+ * to pick the fastest one for that workload.
+ */
+class RecordingScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  RecordingScheduler ();
+  /** Destructor. */
+  virtual ~RecordingScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+protected:
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  std::string m_schedulerType;  //!< TypeId name of the recorded scheduler.
+  std::string m_fileName;       //!< Trace file name.
+  Ptr<Scheduler> m_scheduler;   //!< The recorded scheduler.
+  std::ofstream m_trace;        //!< Trace file.
+};
+
+} // namespace ns3
+
+#endif /* RECORDING_SCHEDULER_H */
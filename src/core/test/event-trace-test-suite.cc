@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/event-trace.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/system-thread.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/// Number of threads recording besides the main one.
+#define EVENT_TRACE_TEST_THREADS 4
+/// Records per thread, more than a thread buffers before spilling.
+#define EVENT_TRACE_TEST_RECORDS 5000
+
+/**
+ * \ingroup eventtrace-tests
+ * Record from several threads and decode the file with
+ * utils/decode-event-trace.py.
+ *
+ * The records are made through EventTrace directly, so the test runs
+ * whether or not NS_EVENT_TRACE is compiled in.  Each worker fills its
+ * buffer once, spilling it, and spills the rest when it exits; the main
+ * thread records from simulation events and flushes.
+ */
+class EventTraceThreadsTestCase : public TestCase
+{
+public:
+  EventTraceThreadsTestCase ();
+  /**
+   * Record the events of a worker thread.
+   * \param [in] worker The index of the worker.
+   */
+  static void Work (uint32_t worker);
+  /**
+   * Record an event of the main thread.
+   * \param [in] value The value of the event.
+   */
+  static void RecordMain (uint32_t value);
+
+private:
+  virtual void DoRun (void);
+};
+
+EventTraceThreadsTestCase::EventTraceThreadsTestCase ()
+  : TestCase ("Check that records from several threads decode with decode-event-trace.py")
+{
+}
+
+void
+EventTraceThreadsTestCase::Work (uint32_t worker)
+{
+  uint16_t id = EventTrace::Register ("EventTraceTest", "Worker");
+  for (uint32_t i = 0; i < EVENT_TRACE_TEST_RECORDS; i++)
+    {
+      EventTrace::Record (id, worker, i);
+    }
+}
+
+void
+EventTraceThreadsTestCase::RecordMain (uint32_t value)
+{
+  EventTrace::Record (EventTrace::Register ("EventTraceTest", "Main"), value, 2, 3, 4);
+}
+
+void
+EventTraceThreadsTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("event-trace.bin");
+  std::string decoded = CreateTempDirFilename ("event-trace.txt");
+  setenv ("NS_EVENT_TRACE", filename.c_str (), 1);
+  uint16_t mainId = EventTrace::Register ("EventTraceTest", "Main");
+  NS_TEST_ASSERT_MSG_EQ (EventTrace::IsEnabled (), true,
+                         "Event tracing is off; was an event registered before NS_EVENT_TRACE was set?");
+  NS_TEST_ASSERT_MSG_EQ (EventTrace::Register ("EventTraceTest", "Main"), mainId,
+                         "Registering an event twice changed its id");
+
+  Simulator::ScheduleWithContext (7, MicroSeconds (5), &EventTraceThreadsTestCase::RecordMain, 1);
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < EVENT_TRACE_TEST_THREADS; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&EventTraceThreadsTestCase::Work, i)));
+      threads.back ()->Start ();
+    }
+  Simulator::Run ();
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+    }
+  Simulator::Destroy ();
+  EventTrace::Flush ();
+
+  std::string command = "python " NS_TEST_SOURCEDIR "/../../../utils/decode-event-trace.py"
+    " --filter EventTraceTest '" + filename + "' > '" + decoded + "'";
+  NS_TEST_ASSERT_MSG_EQ (std::system (command.c_str ()), 0, "Cannot decode " << filename);
+
+  std::ifstream in (decoded.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (in.is_open (), true, "Cannot read " << decoded);
+  std::map<uint32_t, uint32_t> next;      // next value expected from each worker
+  std::map<uint32_t, uint32_t> threadOf;  // thread index of each worker
+  uint32_t mainRecords = 0;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      std::istringstream fields (line);
+      int64_t time;
+      uint32_t thread;
+      std::string context, component, event;
+      fields >> time >> thread >> context >> component >> event;
+      std::vector<uint32_t> values;
+      uint32_t value;
+      while (fields >> value)
+        {
+          values.push_back (value);
+        }
+      NS_TEST_ASSERT_MSG_EQ (component, "EventTraceTest", "Wrong component in \"" << line << "\"");
+      if (event == "Main")
+        {
+          mainRecords++;
+          NS_TEST_EXPECT_MSG_EQ (time, 5000, "Wrong time in \"" << line << "\"");
+          NS_TEST_EXPECT_MSG_EQ (context, "7", "Wrong context in \"" << line << "\"");
+          NS_TEST_EXPECT_MSG_EQ (values.size (), 4, "Wrong values in \"" << line << "\"");
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (event, "Worker", "Wrong event in \"" << line << "\"");
+      NS_TEST_ASSERT_MSG_EQ (values.size (), 2, "Wrong values in \"" << line << "\"");
+      uint32_t worker = values[0];
+      NS_TEST_ASSERT_MSG_LT (worker, EVENT_TRACE_TEST_THREADS, "Unknown worker in \"" << line << "\"");
+      if (threadOf.find (worker) == threadOf.end ())
+        {
+          threadOf[worker] = thread;
+        }
+      NS_TEST_EXPECT_MSG_EQ (thread, threadOf[worker], "Worker " << worker << " changed thread");
+      NS_TEST_ASSERT_MSG_EQ (values[1], next[worker], "Worker " << worker << " records lost or out of order");
+      next[worker]++;
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (mainRecords, 1, "Wrong number of main thread records");
+  std::map<uint32_t, uint32_t> workerOf;
+  for (uint32_t i = 0; i < EVENT_TRACE_TEST_THREADS; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (next[i], EVENT_TRACE_TEST_RECORDS, "Worker " << i << " records lost");
+      NS_TEST_EXPECT_MSG_EQ (workerOf.count (threadOf[i]), 0,
+                             "Workers " << workerOf[threadOf[i]] << " and " << i << " share a thread index");
+      workerOf[threadOf[i]] = i;
+    }
+}
+
+/**
+ * \ingroup eventtrace-tests
+ * The EventTrace test suite.
+ */
+static class EventTraceTestSuite : public TestSuite
+{
+public:
+  EventTraceTestSuite ()
+    : TestSuite ("event-trace", UNIT)
+  {
+    AddTestCase (new EventTraceThreadsTestCase (), TestCase::QUICK);
+  }
+} g_eventTraceTestSuite;
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/lazy-timer.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup timer-tests
+ * Base class of the LazyTimer tests, which counts the expirations.
+ */
+class LazyTimerTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] name The name of the test case.
+   */
+  LazyTimerTestCase (std::string name);
+  /**
+   * The expire function of the timer.
+   * \param [in] arg The argument bound to the timer.
+   */
+  void Expire (int arg);
+
+protected:
+  /**
+   * Arm the timer, as a scheduled event.
+   * \param [in] delay The delay from now.
+   */
+  void Schedule (Time delay);
+  /** Cancel the timer, as a scheduled event. */
+  void Cancel (void);
+
+  LazyTimer m_timer;    //!< The timer under test.
+  uint32_t m_expired;   //!< Number of expirations.
+  Time m_expiredTime;   //!< Time of the last expiration.
+  int m_expiredArgument; //!< Argument of the last expiration.
+};
+
+LazyTimerTestCase::LazyTimerTestCase (std::string name)
+  : TestCase (name),
+    m_expired (0),
+    m_expiredTime (Seconds (0)),
+    m_expiredArgument (0)
+{
+  m_timer.SetFunction (&LazyTimerTestCase::Expire, this);
+  m_timer.SetArguments (7);
+}
+
+void
+LazyTimerTestCase::Expire (int arg)
+{
+  m_expired++;
+  m_expiredTime = Simulator::Now ();
+  m_expiredArgument = arg;
+}
+
+void
+LazyTimerTestCase::Schedule (Time delay)
+{
+  m_timer.Schedule (delay);
+}
+
+void
+LazyTimerTestCase::Cancel (void)
+{
+  m_timer.Cancel ();
+}
+
+/**
+ * \ingroup timer-tests
+ * Pushing the deadline later several times fires the timer once, at the
+ * last deadline.
+ */
+class LazyTimerPushTestCase : public LazyTimerTestCase
+{
+public:
+  LazyTimerPushTestCase ();
+  virtual void DoRun (void);
+};
+
+LazyTimerPushTestCase::LazyTimerPushTestCase ()
+  : LazyTimerTestCase ("Check that a pushed back LazyTimer fires once at its last deadline")
+{
+}
+
+void
+LazyTimerPushTestCase::DoRun (void)
+{
+  Schedule (MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (5), &LazyTimerPushTestCase::Schedule, this, MicroSeconds (20));
+  Simulator::Schedule (MicroSeconds (20), &LazyTimerPushTestCase::Schedule, this, MicroSeconds (17));
+  Simulator::Schedule (MicroSeconds (30), &LazyTimerPushTestCase::Schedule, this, MicroSeconds (7));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired, 1, "The timer did not fire exactly once");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime, MicroSeconds (37), "The timer did not fire at its last deadline");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredArgument, 7, "We did not get the right argument");
+  NS_TEST_ASSERT_MSG_EQ (m_timer.IsExpired (), true, "The timer is still running after it fired");
+}
+
+/**
+ * \ingroup timer-tests
+ * Rescheduling the timer to an earlier deadline fires it early, once.
+ */
+class LazyTimerEarlierTestCase : public LazyTimerTestCase
+{
+public:
+  LazyTimerEarlierTestCase ();
+  virtual void DoRun (void);
+};
+
+LazyTimerEarlierTestCase::LazyTimerEarlierTestCase ()
+  : LazyTimerTestCase ("Check that an earlier LazyTimer deadline fires early")
+{
+}
+
+void
+LazyTimerEarlierTestCase::DoRun (void)
+{
+  Schedule (MicroSeconds (40));
+  Simulator::Schedule (MicroSeconds (5), &LazyTimerEarlierTestCase::Schedule, this, MicroSeconds (5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired, 1, "The timer did not fire exactly once");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime, MicroSeconds (10), "The timer did not fire at the earlier deadline");
+}
+
+/**
+ * \ingroup timer-tests
+ * A cancelled timer does not fire, even though its event stays in the
+ * queue, and it fires once at its new deadline when it is armed again.
+ */
+class LazyTimerCancelTestCase : public LazyTimerTestCase
+{
+public:
+  LazyTimerCancelTestCase ();
+  virtual void DoRun (void);
+};
+
+LazyTimerCancelTestCase::LazyTimerCancelTestCase ()
+  : LazyTimerTestCase ("Check that Cancel suppresses the LazyTimer callback")
+{
+}
+
+void
+LazyTimerCancelTestCase::DoRun (void)
+{
+  Schedule (MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (5), &LazyTimerCancelTestCase::Cancel, this);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired, 0, "The cancelled timer fired");
+  NS_TEST_ASSERT_MSG_EQ (m_timer.GetDelayLeft (), Seconds (0), "The cancelled timer has time left");
+
+  // cancelled and armed again before the pending event fires
+  Simulator::Schedule (MicroSeconds (1), &LazyTimerCancelTestCase::Schedule, this, MicroSeconds (10));
+  Simulator::Schedule (MicroSeconds (3), &LazyTimerCancelTestCase::Cancel, this);
+  Simulator::Schedule (MicroSeconds (6), &LazyTimerCancelTestCase::Schedule, this, MicroSeconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired, 1, "The timer armed again did not fire exactly once");
+  NS_TEST_ASSERT_MSG_EQ (m_expiredTime, MicroSeconds (10 + 26), "The timer armed again did not fire at its new deadline");
+}
+
+/**
+ * \ingroup timer-tests
+ * The LazyTimer test suite.
+ */
+static class LazyTimerTestSuite : public TestSuite
+{
+public:
+  LazyTimerTestSuite ()
+    : TestSuite ("lazy-timer", UNIT)
+  {
+    AddTestCase (new LazyTimerPushTestCase (), TestCase::QUICK);
+    AddTestCase (new LazyTimerEarlierTestCase (), TestCase::QUICK);
+    AddTestCase (new LazyTimerCancelTestCase (), TestCase::QUICK);
+  }
+} g_lazyTimerTestSuite;
@@ -4,6 +4,7 @@
 
 #include "ns3/ipv4-drb-routing.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
@@ -18,6 +19,9 @@ public:
     virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
     Ptr<Ipv4DrbRouting> GetDrbRouting (Ptr<Ipv4> ipv4) const;
+
+    //为每个节点上的DRB路由依次指定随机变量的流编号，返回使用的流数量
+    int64_t AssignStreams (NodeContainer c, int64_t stream) const;
 };
 
 }
@@ -36,6 +36,7 @@ Ipv4DrbRouting::Ipv4DrbRouting () :
     m_mode (PER_FLOW)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrbRouting::~Ipv4DrbRouting ()
@@ -130,6 +131,14 @@ Ipv4DrbRouting::AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t
 
 /* Inherit From Ipv4RoutingProtocol */
 /* NOTE In DRB, the RouteOutput will not actually route the packets out but assign the path ID on it */
+int64_t
+Ipv4DrbRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 /* DRB relies the list routing & static routing to do the real routing */
 Ptr<Ipv4Route>
 Ipv4DrbRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
@@ -167,29 +176,31 @@ Ipv4DrbRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDev
   
   //如果是有不对称路径，则走extraPath中的，否则走对称路径中的即可
 
+  //直接引用路径表，不再为每个包复制一份
   /* Ugly code, patch to support Weighted Presto */
-  std::vector<uint32_t> paths;
-  std::map<Ipv4Address, std::vector<uint32_t> >::iterator extraItr = m_extraPaths.find (header.GetDestination ());
-  if (extraItr == m_extraPaths.end ())
+  const std::vector<uint32_t> *paths = &m_paths;
+  if (!m_extraPaths.empty ())
   {
-    paths = m_paths;
-  }
-  else
-  {
-    paths = extraItr->second;
+    std::map<Ipv4Address, std::vector<uint32_t> >::const_iterator extraItr = m_extraPaths.find (header.GetDestination ());
+    if (extraItr != m_extraPaths.end ())
+    {
+      paths = &extraItr->second;
+    }
   }
   /* Breathe a fresh air to celebrate the end of ugly code */
 
 
-  uint32_t index = rand () % paths.size ();
-  std::map<uint32_t, uint32_t>::iterator itr = m_indexMap.find (flowIndentify);
-  if (itr != m_indexMap.end ())
+  //一次查找得到流的下一个路径下标，新流随机选择起始路径
+  std::pair<std::map<uint32_t, uint32_t>::iterator, bool> inserted =
+      m_indexMap.insert (std::make_pair (flowIndentify, 0));
+  if (inserted.second)
   {
-    index = itr->second;
+    inserted.first->second = m_rand->GetInteger (0, paths->size () - 1);
   }
+  uint32_t &index = inserted.first->second;
 
-  uint32_t path = paths[index];
-  m_indexMap[flowIndentify] = (index + 1) % paths.size ();
+  uint32_t path = (*paths)[index];
+  index = (index + 1) % paths->size ();
 
   Ipv4XPathTag ipv4XPathTag;
   ipv4XPathTag.SetPathId (path);
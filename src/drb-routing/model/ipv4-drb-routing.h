@@ -8,6 +8,7 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <set>
 
@@ -37,6 +38,9 @@ public:
           const std::set<Ipv4Address>& exclusiveIPs = std::set<Ipv4Address> ());
   bool AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t path);
 
+  //指定流起始路径所用随机变量的流编号，返回使用的流数量
+  int64_t AssignStreams (int64_t stream);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -56,6 +60,7 @@ private:
   std::map<Ipv4Address, std::vector<uint32_t> > m_extraPaths;//去特定地址并且路径非对称
   std::map<uint32_t, uint32_t> m_indexMap;//下一次走的端口
   enum DrbRoutingMode m_mode;
+  Ptr<UniformRandomVariable> m_rand;//选择流的起始路径
 
   Ptr<Ipv4> m_ipv4;
 };
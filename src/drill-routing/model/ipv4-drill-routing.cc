@@ -41,6 +41,7 @@ Ipv4DrillRouting::Ipv4DrillRouting ()
     : m_d (2)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrillRouting::~Ipv4DrillRouting ()
@@ -48,6 +49,14 @@ Ipv4DrillRouting::~Ipv4DrillRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+int64_t
+Ipv4DrillRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 //添加路由表
 void
 Ipv4DrillRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
@@ -198,7 +207,10 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   uint32_t leastLoadInterface = 0;
   uint32_t leastLoad = std::numeric_limits<uint32_t>::max ();
   //得到一个随机端口
-  std::random_shuffle (allPorts.begin (), allPorts.end ());
+  for (uint32_t i = allPorts.size () - 1; i > 0; i--)
+  {
+    std::swap (allPorts[i], allPorts[m_rand->GetInteger (0, i)]);
+  }
   //从上次最好中寻找是否有过这个destAddress
   std::map<Ipv4Address, uint32_t>::iterator itr = m_previousBestQueueMap.find (destAddress);
   //如果找到后则将端口和负载都设为这个端口
@@ -8,6 +8,7 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
 #include <map>
@@ -39,6 +40,8 @@ public:
   uint32_t CalculateQueueLength (uint32_t interface);
   //构建一个Ipv4Route对象
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
+  //指定端口采样所用随机变量的流编号
+  int64_t AssignStreams (int64_t stream);
 
 
   /* Inherit From Ipv4RoutingProtocol */
@@ -59,6 +62,8 @@ private:
   uint32_t m_d;
   //记录上次最好的端口
   std::map<Ipv4Address, uint32_t> m_previousBestQueueMap;
+  //打乱端口顺序以随机采样
+  Ptr<UniformRandomVariable> m_rand;
 
   Ptr<Ipv4> m_ipv4;
   std::vector<DrillRouteEntry> m_routeEntryList;
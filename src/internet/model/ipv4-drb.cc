@@ -21,6 +21,7 @@ Ipv4Drb::GetTypeId (void)
 Ipv4Drb::Ipv4Drb ()
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Drb::~Ipv4Drb ()
@@ -42,7 +43,7 @@ Ipv4Drb::GetCoreSwitchAddress (uint32_t flowId)
   }
   
   //得到一个随机数
-  uint32_t index = rand () % listSize;
+  uint32_t index = m_rand->GetInteger (0, listSize - 1);
   //如果找得到就用这个，找不到就用随机数得到的
   std::map<uint32_t, uint32_t>::iterator itr = m_indexMap.find (flowId);
 
@@ -76,4 +77,12 @@ Ipv4Drb::AddCoreSwitchAddress (uint32_t k, Ipv4Address addr)
   }
 }
 
+int64_t
+Ipv4Drb::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 }
@@ -31,12 +31,26 @@
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 #include "ns3/flow-id-tag.h"
-#include "ns3/hash.h"
+#include "ns3/path-epoch-tag.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4GlobalRouting");
 
+//对flowId、路径epoch与TTL做整数哈希，TTL使每一跳的选择互不相关
+static inline uint32_t
+EcmpHash (uint32_t flowId, uint32_t pathEpoch, uint8_t ttl)
+{
+  uint32_t h = flowId ^ (pathEpoch * 0x9e3779b9u) ^ (static_cast<uint32_t> (ttl) << 24);
+  // MurmurHash3 finalizer
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (Ipv4GlobalRouting);
 //返回TypeID
 TypeId
@@ -147,7 +161,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
 
 //返回一个IPv4Route对象，先检查Host路由，再检查Network路由，最后检查AS域外路由
 Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv4Header &header, uint32_t flowId, Ptr<NetDevice> oif)
+Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv4Header &header, uint32_t flowId, uint32_t pathEpoch, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
@@ -236,12 +250,9 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
         }
       else if (m_perFlowEcmpRouting && flowId != 0) // If the flow id is 0, it may be the socket setup endpoint request, we simply return the first
         {                                           // available route to indicate the address is not local
-          std::stringstream hash_string;
-          hash_string << flowId;
-          hash_string << header.GetTtl ();
-          uint32_t hashPerturbe = Hash32 (hash_string.str ()); // Hash Perturbe
-          selectIndex = hashPerturbe % allRoutes.size();//根据flowId与TTL得到要选择的端口，否则会随机选择端口。
-          NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId);
+          uint32_t hash = EcmpHash (flowId, pathEpoch, header.GetTtl ());
+          selectIndex = (static_cast<uint64_t> (hash) * allRoutes.size ()) >> 32;//根据flowId、路径epoch与TTL得到要选择的端口
+          NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId << " epoch: " << pathEpoch);
         }
       else
         {
@@ -480,8 +491,9 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 {
   NS_LOG_FUNCTION (this << p << &header << oif << &sockerr);
 
-  //得到flowId
+  //得到flowId与路径epoch
   uint32_t flowId = 0;
+  uint32_t pathEpoch = 0;
   if (m_perFlowEcmpRouting && p != NULL) {
     NS_ASSERT(m_randomEcmpRouting == false);
     FlowIdTag flowIdTag;
@@ -490,6 +502,11 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
     {
       flowId = flowIdTag.GetFlowId();
     }
+    PathEpochTag pathEpochTag;
+    if (p->PeekPacketTag(pathEpochTag))
+    {
+      pathEpoch = pathEpochTag.GetEpoch();
+    }
   }
 
 //
@@ -508,7 +525,7 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 //查询是否是一个正在路由的单播包，得到路由条目
   NS_LOG_LOGIC ("Unicast destination- looking up");
   //这里改变了
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), p, header, flowId, oif);
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), p, header, flowId, pathEpoch, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -533,8 +550,9 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> packet, const Ipv4Header &head
 
   Ptr<Packet> p = ConstCast<Packet> (packet);
 
-  //得到flowId
+  //得到flowId与路径epoch
   uint32_t flowId = 0;
+  uint32_t pathEpoch = 0;
     if (m_perFlowEcmpRouting && p != NULL) {
       NS_ASSERT(m_randomEcmpRouting == false);
       FlowIdTag flowIdTag;
@@ -543,6 +561,11 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> packet, const Ipv4Header &head
       {
         flowId = flowIdTag.GetFlowId();
       }
+      PathEpochTag pathEpochTag;
+      if (p->PeekPacketTag(pathEpochTag))
+      {
+        pathEpoch = pathEpochTag.GetEpoch();
+      }
     }
 
   //Determine whether address and interface corresponding to received packet can be accepted for local delivery.
@@ -574,7 +597,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> packet, const Ipv4Header &head
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), p, header, flowId);
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), p, header, flowId, pathEpoch);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -209,11 +209,43 @@ Ipv4Interface::SetForwarding (bool val)
 
 void
 Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << *p << dest);
+  Ptr<QueueDiscItem> item = PrepareSend (p, hdr, dest);
+  if (item)
+    {
+      m_tc->Send (m_device, item);
+    }
+}
+
+void
+Ipv4Interface::Send (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << packets.size () << dest);
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (packets.size ());
+  for (std::list<std::pair<Ptr<Packet>, Ipv4Header> >::const_iterator it = packets.begin ();
+       it != packets.end (); ++it)
+    {
+      Ptr<QueueDiscItem> item = PrepareSend (it->first, it->second, dest);
+      if (item)
+        {
+          items.push_back (item);
+        }
+    }
+  if (!items.empty ())
+    {
+      m_tc->SendMany (m_device, items);
+    }
+}
+
+Ptr<QueueDiscItem>
+Ipv4Interface::PrepareSend (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
 {
   NS_LOG_FUNCTION (this << *p << dest);
   if (!IsUp ())
     {
-      return;
+      return 0;
     }
 
   // Check for a loopback device, if it's the case we don't pass through
@@ -224,7 +256,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
       /// goes to loopback)?
       p->AddHeader (hdr);
       m_device->Send (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER);
-      return;
+      return 0;
     } 
 
   NS_ASSERT (m_tc != 0);
@@ -239,7 +271,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
                          m_device->GetBroadcast (),
                          m_device->GetBroadcast (),
                          NetDevice::PACKET_HOST);
-          return;
+          return 0;
         }
     }
   if (m_device->NeedsArp ())
@@ -286,14 +318,13 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
       if (found)
         {
           NS_LOG_LOGIC ("Address Resolved.  Send.");
-          m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
+          return Create<Ipv4QueueDiscItem> (p, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr);
         }
+      return 0;
     }
-  else
-    {
-      NS_LOG_LOGIC ("Doesn't need ARP");
-      m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, hdr));
-    }
+
+  NS_LOG_LOGIC ("Doesn't need ARP");
+  return Create<Ipv4QueueDiscItem> (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, hdr);
 }
 
 uint32_t
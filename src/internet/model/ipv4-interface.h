@@ -153,6 +153,16 @@ public:
    */ 
   void Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest);
 
+  /**
+   * \param packets packets to send with their IPv4 headers, e.g. the
+   *        fragments of a packet
+   * \param dest next hop address of the packets.
+   *
+   * The packets handed to the traffic control layer are enqueued together
+   * and the queue disc of the device is run once.
+   */
+  void Send (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest);
+
   /**
    * \param address The Ipv4InterfaceAddress to add to the interface
    * \returns true if succeeded
@@ -193,6 +203,18 @@ private:
    */
   void DoSetup (void);
 
+  /**
+   * \brief Deliver a packet that does not go through the traffic control
+   *        layer, or build the queue disc item of one that does
+   * \param p packet to send
+   * \param hdr IPv4 header
+   * \param dest next hop address of packet.
+   * \returns the queue disc item to send to the traffic control layer, or
+   *          0 if the packet was delivered locally, is waiting for ARP or
+   *          was dropped
+   */
+  Ptr<QueueDiscItem> PrepareSend (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest);
+
 
   /**
    * \brief Container for the Ipv4InterfaceAddresses.
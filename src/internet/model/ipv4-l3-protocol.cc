@@ -118,6 +118,7 @@ Ipv4L3Protocol::GetTypeId(void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+    : m_rxPacket(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -602,17 +603,35 @@ void Ipv4L3Protocol::Receive(Ptr<NetDevice> device, Ptr<const Packet> p, uint16_
   }
 
   NS_ASSERT_MSG(m_routingProtocol != 0, "Need a routing protocol object to process packets");
-  if (!m_routingProtocol->RouteInput(packet, ipHeader, device,
-                                     MakeCallback(&Ipv4L3Protocol::IpForward, this),
-                                     MakeCallback(&Ipv4L3Protocol::IpMulticastForward, this),
-                                     MakeCallback(&Ipv4L3Protocol::LocalDeliver, this),
-                                     MakeCallback(&Ipv4L3Protocol::RouteInputError, this)))
+  // packet is our private copy: let the forwarding or local delivery
+  // callback take it over instead of copying it once more.
+  Packet const *outerRxPacket = m_rxPacket;
+  m_rxPacket = PeekPointer(packet);
+  bool routed = m_routingProtocol->RouteInput(packet, ipHeader, device,
+                                              MakeCallback(&Ipv4L3Protocol::IpForward, this),
+                                              MakeCallback(&Ipv4L3Protocol::IpMulticastForward, this),
+                                              MakeCallback(&Ipv4L3Protocol::LocalDeliver, this),
+                                              MakeCallback(&Ipv4L3Protocol::RouteInputError, this));
+  m_rxPacket = outerRxPacket;
+  if (!routed)
   {
     NS_LOG_WARN("No route found for forwarding packet.  Drop.");
     m_dropTrace(ipHeader, packet, DROP_NO_ROUTE, m_node->GetObject<Ipv4>(), interface);
   }
 }
 
+Ptr<Packet> Ipv4L3Protocol::TakePacket(Ptr<const Packet> p)
+{
+  if (PeekPointer(p) == m_rxPacket)
+  {
+    // Receive () does not use its copy after RouteInput, so the first
+    // callback reached with it may modify it in place.
+    m_rxPacket = 0;
+    return ConstCast<Packet>(p);
+  }
+  return p->Copy();
+}
+
 Ptr<Icmpv4L4Protocol>
 Ipv4L3Protocol::GetIcmp(void) const
 {
@@ -946,8 +965,9 @@ void Ipv4L3Protocol::SendRealOut(Ptr<Ipv4Route> route,
         for (std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin(); it != listFragments.end(); it++)
         {
           CallTxTrace(it->second, it->first, m_node->GetObject<Ipv4>(), interface);
-          outInterface->Send(it->first, it->second, route->GetGateway());
         }
+        //分片一起入队，队列规则只运行一次
+        outInterface->Send(listFragments, route->GetGateway());
       }
       else
       {
@@ -974,8 +994,8 @@ void Ipv4L3Protocol::SendRealOut(Ptr<Ipv4Route> route,
         {
           NS_LOG_LOGIC("Sending fragment " << *(it->first));
           CallTxTrace(it->second, it->first, m_node->GetObject<Ipv4>(), interface);
-          outInterface->Send(it->first, it->second, ipHeader.GetDestination());
         }
+        outInterface->Send(listFragments, ipHeader.GetDestination());
       }
       else
       {
@@ -1037,7 +1057,7 @@ void Ipv4L3Protocol::IpForward(Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, cons
   NS_LOG_LOGIC("Forwarding logic for node: " << m_node->GetId());
   // Forwarding
   Ipv4Header ipHeader = header;
-  Ptr<Packet> packet = p->Copy();
+  Ptr<Packet> packet = TakePacket(p);
   int32_t interface = GetInterfaceForDevice(rtentry->GetOutputDevice());
   ipHeader.SetTtl(ipHeader.GetTtl() - 1);
   if (ipHeader.GetTtl() == 0)
@@ -1061,7 +1081,7 @@ void Ipv4L3Protocol::IpForward(Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, cons
 void Ipv4L3Protocol::LocalDeliver(Ptr<const Packet> packet, Ipv4Header const &ip, uint32_t iif)
 {
   NS_LOG_FUNCTION(this << packet << &ip << iif);
-  Ptr<Packet> p = packet->Copy(); // need to pass a non-const packet up
+  Ptr<Packet> p = TakePacket(packet); // need to pass a non-const packet up
   Ipv4Header ipHeader = ip;
 
   if (!ipHeader.IsLastFragment() || ipHeader.GetFragmentOffset() != 0)
@@ -1089,9 +1109,11 @@ void Ipv4L3Protocol::LocalDeliver(Ptr<const Packet> packet, Ipv4Header const &ip
   Ptr<IpL4Protocol> protocol = GetProtocol(ipHeader.GetProtocol(), iif);
   if (protocol != 0)
   {
-    // we need to make a copy in the unlikely event we hit the
-    // RX_ENDPOINT_UNREACH codepath
-    Ptr<Packet> copy = p->Copy();
+    // ICMP only quotes the first 8 bytes of the datagram, so save
+    // those instead of copying the packet in the unlikely event we hit
+    // the RX_ENDPOINT_UNREACH codepath
+    uint8_t orgData[8];
+    uint32_t orgSize = p->CopyData(orgData, 8);
     enum IpL4Protocol::RxStatus status =
         protocol->Receive(p, ipHeader, GetInterface(iif));
     switch (status)
@@ -1121,7 +1143,7 @@ void Ipv4L3Protocol::LocalDeliver(Ptr<const Packet> packet, Ipv4Header const &ip
       }
       if (subnetDirected == false)
       {
-        GetIcmp()->SendDestUnreachPort(ipHeader, copy);
+        GetIcmp()->SendDestUnreachPort(ipHeader, Create<Packet>(orgData, orgSize));
       }
     }
   }
@@ -332,6 +332,16 @@ private:
                Ptr<Packet> packet,
                Ipv4Header const &ipHeader);
 
+  /**
+   * \brief Get a writable packet for the forwarding or local delivery path.
+   *
+   * The packet Receive () passes to RouteInput is owned by this object only,
+   * so it is handed over as is; any other packet is copied.
+   * \param p packet given to a RouteInput callback
+   * \returns the packet itself if it can be modified in place, a copy otherwise
+   */
+  Ptr<Packet> TakePacket (Ptr<const Packet> p);
+
   /**
    * \brief Forward a packet.
    * \param rtentry route
@@ -498,6 +508,8 @@ private:
 
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
+  Packet const *m_rxPacket; //!< Received packet RouteInput callbacks may take over without a copy.
+
   /**
    * \class Fragments
    * \brief A Set of Fragment belonging to the same packet (src, dst, identification and proto)
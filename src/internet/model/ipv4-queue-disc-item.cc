@@ -60,6 +60,21 @@ Ipv4QueueDiscItem::SetHeader (Ipv4Header header)
   m_header = header;
 }
 
+bool
+Ipv4QueueDiscItem::Mark (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_headerAdded || m_header.GetEcn () == Ipv4Header::ECN_NotECT)
+    {
+      return false;
+    }
+  if (m_header.GetEcn () != Ipv4Header::ECN_CE)
+    {
+      m_header.SetEcn (Ipv4Header::ECN_CE);
+    }
+  return true;
+}
+
 void Ipv4QueueDiscItem::AddHeader(void)
 {
   NS_LOG_FUNCTION (this);
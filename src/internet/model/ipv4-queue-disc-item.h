@@ -60,6 +60,12 @@ public:
 
   void SetHeader (Ipv4Header header);
 
+  /**
+   * \brief Set the ECN field of the stored header to CE, without copying it
+   * \return true if the packet is ECN capable and now carries CE.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Add the header to the packet
    */
@@ -36,7 +36,6 @@ TcpFlowBender::TcpFlowBender ()
      m_totalBytes (0),
      m_markedBytes (0),
      m_numCongestionRtt (0),
-     m_V (1),
      m_highTxMark (0),
      m_T (0.05),
      m_N (1)
@@ -49,7 +48,6 @@ TcpFlowBender::TcpFlowBender (const TcpFlowBender &other)
      m_totalBytes (0),
      m_markedBytes (0),
      m_numCongestionRtt (0),
-     m_V (1),
      m_highTxMark (0),
      m_T (other.m_T),
      m_N (other.m_N)
@@ -66,6 +64,7 @@ void
 TcpFlowBender::DoDispose (void)
 {
     NS_LOG_FUNCTION (this);
+    m_reroute = MakeNullCallback<void> ();
 }
 
 //收到一个包后进行的处理
@@ -87,17 +86,10 @@ TcpFlowBender::ReceivedPacket (SequenceNumber32 highTxhMark, SequenceNumber32 ac
 }
 
 
-uint32_t
-TcpFlowBender::GetV ()
-{
-    NS_LOG_INFO ( this << " retuning V as " << m_V );
-    return m_V;
-}
-
-Time
-TcpFlowBender::GetPauseTime ()
+void
+TcpFlowBender::SetRerouteCallback (Callback<void> reroute)
 {
-    return MicroSeconds (80);
+    m_reroute = reroute;
 }
 //检测是否拥塞
 void
@@ -115,8 +107,11 @@ TcpFlowBender::CheckCongestion ()
         {
             m_numCongestionRtt = 0; //clear
             // XXX Do we need to clear the congestion state
-            // m_V = m_V + 1 + (rand() % 10);
-            m_V ++;
+            NS_LOG_INFO (this << " rerouting");
+            if (!m_reroute.IsNull ())
+            {
+                m_reroute ();
+            }
         }
     }
     else
@@ -6,6 +6,7 @@
 #include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/sequence-number.h"
+#include "ns3/callback.h"
 
 namespace ns3 {
 
@@ -22,9 +23,8 @@ public:
 
     void ReceivedPacket (SequenceNumber32 higTxhMark, SequenceNumber32 ackNumber, uint32_t ackedBytes, bool withECE);
 
-    uint32_t GetV ();
-
-    Time GetPauseTime ();
+    //设置重路由的回调，拥塞持续N个RTT后调用
+    void SetRerouteCallback (Callback<void> reroute);
 
 private:
 
@@ -36,7 +36,7 @@ private:
 
     //拥塞的RTT计数
     uint32_t m_numCongestionRtt;
-    uint32_t m_V; //T改变V值用于重路由
+    Callback<void> m_reroute; //请求重路由
 
     SequenceNumber32 m_highTxMark; //目前为止见过的最大的ACK号码
 
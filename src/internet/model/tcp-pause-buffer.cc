@@ -23,6 +23,7 @@ TcpPauseBuffer::GetTypeId (void)
 }
 
 TcpPauseBuffer::TcpPauseBuffer ()
+    : m_heldBytes (0)
 {
     NS_LOG_FUNCTION (this);
 }
@@ -32,30 +33,46 @@ TcpPauseBuffer::~TcpPauseBuffer ()
     NS_LOG_FUNCTION (this);
 }
 
-//得到PauseBuffer中的条目
-struct TcpPauseItem
-TcpPauseBuffer::GetBufferedItem (void)
+//记录一个被扣住的区间，同一起始序列号只保留最长的一次
+void
+TcpPauseBuffer::Hold (SequenceNumber32 seq, uint32_t size)
 {
-    struct TcpPauseItem item = m_pauseItems.front ();
-    m_pauseItems.pop_front ();
-    return item;
+    NS_LOG_FUNCTION (this << seq << size);
+    std::pair<HeldRanges::iterator, bool> inserted =
+        m_heldRanges.insert (std::make_pair (seq, size));
+    if (inserted.second)
+    {
+        m_heldBytes += size;
+    }
+    else if (inserted.first->second < size)
+    {
+        m_heldBytes += size - inserted.first->second;
+        inserted.first->second = size;
+    }
 }
 
-//检查PauseBuffer是否为空
+//检查是否有被扣住的区间
 bool
-TcpPauseBuffer::HasBufferedItem (void)
+TcpPauseBuffer::HasHeldRange (void) const
 {
-    return m_pauseItems.empty ();
+    return !m_heldRanges.empty ();
 }
 
-//构建条目并入入m_pauseItems中
-void
-TcpPauseBuffer::BufferItem (Ptr<Packet> p, TcpHeader header)
+//被扣住的总字节数
+uint32_t
+TcpPauseBuffer::GetHeldBytes (void) const
+{
+    return m_heldBytes;
+}
+
+//取出并清空所有被扣住的区间
+TcpPauseBuffer::HeldRanges
+TcpPauseBuffer::Release (void)
 {
-    struct TcpPauseItem pauseItem;
-    pauseItem.packet = p;
-    pauseItem.header = header;
-    m_pauseItems.push_back (pauseItem);
+    HeldRanges heldRanges;
+    heldRanges.swap (m_heldRanges);
+    m_heldBytes = 0;
+    return heldRanges;
 }
 
 }
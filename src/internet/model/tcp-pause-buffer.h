@@ -2,34 +2,34 @@
 #define TCP_PAUSE_BUFFER_H
 
 #include "ns3/object.h"
-#include "ns3/packet.h"
-#include "ns3/tcp-header.h"
+#include "ns3/sequence-number.h"
 
-#include <deque>
+#include <map>
 
 namespace ns3 {
 
-//TcpPause条目
-struct TcpPauseItem
-{
-    Ptr<Packet> packet;
-    TcpHeader header;
-};
-
+//TcpPause期间被扣住的序列号区间
+//暂停时不再复制并缓存报文，数据本来就留在发送缓存中，只记录哪些区间本应发出，
+//暂停结束后由socket按正常发送流程重新发出
 class TcpPauseBuffer : public Object
 {
 public:
+    //区间起始序列号 -> 区间长度
+    typedef std::map<SequenceNumber32, uint32_t> HeldRanges;
+
     static TypeId GetTypeId (void);
 
     TcpPauseBuffer ();
     ~TcpPauseBuffer ();
 
-    struct TcpPauseItem GetBufferedItem (void);
-    bool HasBufferedItem (void);
-    void BufferItem (Ptr<Packet> p, TcpHeader header);
+    void Hold (SequenceNumber32 seq, uint32_t size);
+    bool HasHeldRange (void) const;
+    uint32_t GetHeldBytes (void) const;
+    HeldRanges Release (void);
 
 private:
-    std::deque<struct TcpPauseItem> m_pauseItems;
+    HeldRanges m_heldRanges;
+    uint32_t m_heldBytes;
 };
 
 }
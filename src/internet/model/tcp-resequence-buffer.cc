@@ -37,11 +37,6 @@ TcpResequenceBuffer::GetTypeId(void)
                                         TimeValue(MicroSeconds(50)),
                                         MakeTimeAccessor(&TcpResequenceBuffer::m_outOrderQueueTimerLimit),
                                         MakeTimeChecker())
-                          .AddAttribute("PeriodicalCheckTime",
-                                        "Periodical check time",
-                                        TimeValue(MicroSeconds(10)),
-                                        MakeTimeAccessor(&TcpResequenceBuffer::m_periodicalCheckTime),
-                                        MakeTimeChecker())
                           .AddTraceSource("Buffer",
                                           "When one packet is buffered",
                                           MakeTraceSourceAccessor(&TcpResequenceBuffer::m_tcpRBBuffer),
@@ -59,13 +54,13 @@ TcpResequenceBuffer::TcpResequenceBuffer() : // Parameters
                                              m_sizeLimit(64000),
                                              m_inOrderQueueTimerLimit(MicroSeconds(20)),
                                              m_outOrderQueueTimerLimit(MicroSeconds(50)),
-                                             m_periodicalCheckTime(MicroSeconds(10)),
                                              m_traceFlowId(0),
                                              // Variables
                                              m_size(0),
                                              m_inOrderQueueTimer(Simulator::Now()),
                                              m_outOrderQueueTimer(Simulator::Now()),
-                                             m_checkEvent(),
+                                             m_timeoutEvent(),
+                                             m_timeoutDeadline(Simulator::Now()),
                                              m_hasStopped(false),
                                              m_firstSeq(SequenceNumber32(0)),
                                              m_nextSeq(SequenceNumber32(0))
@@ -83,12 +78,9 @@ void TcpResequenceBuffer::DoDispose(void)
 {
   //清空元素
   NS_LOG_FUNCTION(this);
+  m_timeoutEvent.Cancel();
   m_inOrderQueue.clear();
-  while (!m_outOrderQueue.empty())
-  {
-    m_outOrderQueue.pop();
-  }
-  m_outOrderSeqSet.clear();
+  m_outOrderQueue.clear();
 }
 
 void TcpResequenceBuffer::BufferPacket(Ptr<Packet> packet,
@@ -103,12 +95,10 @@ void TcpResequenceBuffer::BufferPacket(Ptr<Packet> packet,
     return;
   }
 
-  // Turn on the periodical check and reset the timer
-  // 开启周期性检测事件
-  if (!m_checkEvent.IsRunning())
+  // Reset the timers when the buffer leaves the idle status
+  // 缓存由空变为非空时重置计时器，超时事件在处理完这个包后设定
+  if (m_inOrderQueue.empty() && m_outOrderQueue.empty())
   {
-    NS_LOG_LOGIC("Turn on periodical check");
-    m_checkEvent = Simulator::Schedule(m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
     m_inOrderQueueTimer = Simulator::Now();
     m_outOrderQueueTimer = Simulator::Now();
   }
@@ -146,7 +136,10 @@ void TcpResequenceBuffer::BufferPacket(Ptr<Packet> packet,
   NS_LOG_INFO("\tThe packet seq is: " << element.m_seq
                                       << " and the expected next seq is: " << TcpResequenceBuffer::CalculateNextSeq(element));
 
-  m_tcpRBBuffer(m_traceFlowId, Simulator::Now(), element.m_seq, TcpResequenceBuffer::CalculateNextSeq(element));
+  if (!m_tcpRBBuffer.IsEmpty())
+  {
+    m_tcpRBBuffer(m_traceFlowId, Simulator::Now(), element.m_seq, TcpResequenceBuffer::CalculateNextSeq(element));
+  }
 
   // If the seq < first seq, retransmission may occur
   // 得到重传包
@@ -188,22 +181,17 @@ void TcpResequenceBuffer::BufferPacket(Ptr<Packet> packet,
   //如果正好是下一个包，放入InorderQueue中
   else if (TcpResequenceBuffer::PutInTheInOrderQueue(element))
   {
-    // Try to fill the in order queue from the out order queue
-    // 然后测试一下有没有乱序的包可以接上，注意乱序的包在队列中有排序
-    while (!m_outOrderQueue.empty())
+    // Move the contiguous run at the head of the out order queue into the in order queue
+    // 然后把乱序队列开头能接上的一段连续区间整体移入InOrderQueue
+    std::map<SequenceNumber32, TcpResequenceBufferElement>::iterator itr = m_outOrderQueue.begin();
+    while (itr != m_outOrderQueue.end() && TcpResequenceBuffer::PutInTheInOrderQueue(itr->second))
     {
-      //如果正好接上，就把这个包放入InOrderQueue中
-      if (TcpResequenceBuffer::PutInTheInOrderQueue(m_outOrderQueue.top()))
-      {
-        //NS_LOG_LOGIC
-        NS_LOG_DEBUG("Get a outorder packet's right seq "<<m_outOrderQueue.top().m_seq);
-        m_outOrderSeqSet.erase(m_outOrderQueue.top().m_seq);
-        m_outOrderQueue.pop();
-      }
-      else
-      {
-        break;
-      }
+      NS_LOG_DEBUG("Get a outorder packet's right seq " << itr->first);
+      ++itr;
+    }
+    if (itr != m_outOrderQueue.begin())
+    {
+      m_outOrderQueue.erase(m_outOrderQueue.begin(), itr);
       // 并更新时间
       m_outOrderQueueTimer = Simulator::Now();
     }
@@ -223,12 +211,11 @@ void TcpResequenceBuffer::BufferPacket(Ptr<Packet> packet,
     //NS_LOG_LOGIC
     NS_LOG_DEBUG(m_tcp<<" Receive outorder packet with seq:" << element.m_seq
                             << ", while the firstSeq is: " << m_firstSeq<<" next_seq is "<<m_nextSeq);
-    if (m_outOrderSeqSet.find(element.m_seq) == m_outOrderSeqSet.end())
-    {
-      m_outOrderQueue.push(element);
-      m_outOrderSeqSet.insert(element.m_seq);
-    }
+    // 相同起始序列号的重复包不再插入
+    m_outOrderQueue.insert(std::make_pair(element.m_seq, element));
   }
+
+  TcpResequenceBuffer::ScheduleTimeout();
 }
 
 //设置TCP
@@ -240,10 +227,10 @@ void TcpResequenceBuffer::SetTcp(TcpSocketBase *tcp)
 //停止事件
 void TcpResequenceBuffer::Stop(void)
 {
-  // After the hasStopped flag turned into true, it would never activate the
-  // periodical check event again to prepare for the destruction
+  // After the hasStopped flag turned into true, it would never arm the
+  // timeout event again to prepare for the destruction
   m_hasStopped = true;
-  m_checkEvent.Cancel();
+  m_timeoutEvent.Cancel();
   m_tcp = NULL;
 }
 
@@ -280,8 +267,41 @@ TcpResequenceBuffer::CalculateNextSeq(const TcpResequenceBufferElement &element)
   return newSeq;
 }
 
-//周期性检测事件
-void TcpResequenceBuffer::PeriodicalCheck()
+//按两个计时器中较早的期限设定超时事件，缓存为空时不设定
+void TcpResequenceBuffer::ScheduleTimeout()
+{
+  if (m_hasStopped || (m_inOrderQueue.empty() && m_outOrderQueue.empty()))
+  {
+    if (m_timeoutEvent.IsRunning())
+    {
+      NS_LOG_LOGIC("Turn the timeout event into idle status");
+      m_timeoutEvent.Cancel();
+    }
+    return;
+  }
+
+  // The out order timeout also flushes the in order queue, so it is armed
+  // whenever the buffer holds a packet
+  Time deadline = m_outOrderQueueTimer + m_outOrderQueueTimerLimit;
+  if (!m_inOrderQueue.empty() && m_inOrderQueueTimer + m_inOrderQueueTimerLimit < deadline)
+  {
+    deadline = m_inOrderQueueTimer + m_inOrderQueueTimerLimit;
+  }
+
+  // Deadlines only move later when the queues are flushed, an event which is
+  // already pending for an earlier time re-arms itself when it fires
+  if (m_timeoutEvent.IsRunning() && m_timeoutDeadline <= deadline)
+  {
+    return;
+  }
+  m_timeoutEvent.Cancel();
+  m_timeoutDeadline = deadline;
+  Time delay = deadline > Simulator::Now() ? deadline - Simulator::Now() : Time(0);
+  m_timeoutEvent = Simulator::Schedule(delay, &TcpResequenceBuffer::CheckTimeout, this);
+}
+
+//超时事件
+void TcpResequenceBuffer::CheckTimeout()
 {
   if (m_hasStopped)
   {
@@ -289,29 +309,22 @@ void TcpResequenceBuffer::PeriodicalCheck()
   }
 
   //如果超时则Flush
-  if (Simulator::Now() - m_inOrderQueueTimer > m_inOrderQueueTimerLimit)
+  if (Simulator::Now() - m_inOrderQueueTimer >= m_inOrderQueueTimerLimit)
   {
     FlushInOrderQueue(IN_ORDER_TIMEOUT);
     m_firstSeq = m_nextSeq;
   }
 
   //如果OutOrderQueue也超时，则Flush
-  if (Simulator::Now() - m_outOrderQueueTimer > m_outOrderQueueTimerLimit)
+  if (Simulator::Now() - m_outOrderQueueTimer >= m_outOrderQueueTimerLimit)
   {
     FlushInOrderQueue(OUT_ORDER_TIMEOUT);
     FlushOutOrderQueue(OUT_ORDER_TIMEOUT);
     m_firstSeq = m_nextSeq;
   }
 
-  //只要还有一个不为空，则继续周期性检测
-  if (!m_inOrderQueue.empty() || !m_outOrderQueue.empty())
-  {
-    m_checkEvent = Simulator::Schedule(m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
-  }
-  else
-  {
-    NS_LOG_LOGIC("Turn the periodical check into idle status");
-  }
+  //只要还有一个不为空，则按新的期限再次设定
+  TcpResequenceBuffer::ScheduleTimeout();
 }
 
 //提交一个包
@@ -322,19 +335,28 @@ void TcpResequenceBuffer::FlushOneElement(const TcpResequenceBufferElement &elem
     return;
   }
   NS_LOG_INFO("Flush packet: " << element.m_packet);
-  m_tcpRBFlush(m_traceFlowId, Simulator::Now(), element.m_seq, m_inOrderQueue.size(),
-               m_outOrderQueue.size(), reason);
+  if (!m_tcpRBFlush.IsEmpty())
+  {
+    m_tcpRBFlush(m_traceFlowId, Simulator::Now(), element.m_seq, m_inOrderQueue.size(),
+                 m_outOrderQueue.size(), reason);
+  }
   m_tcp->DoForwardUp(element.m_packet, element.m_fromAddress, element.m_toAddress);
 }
 
-//提交顺序队列
-void TcpResequenceBuffer::FlushInOrderQueue(TcpRBPopReason reason)
+//将一段连续的包按顺序上交给TCP
+void TcpResequenceBuffer::FlushRun(const std::vector<TcpResequenceBufferElement> &run, TcpRBPopReason reason)
 {
-  NS_LOG_FUNCTION(this);
-  // Flush the data
-  std::vector<TcpResequenceBufferElement>::iterator itr = m_inOrderQueue.begin();
+  if (m_hasStopped || run.empty())
+  {
+    return;
+  }
 
-  for (; itr != m_inOrderQueue.end(); ++itr)
+  // The run is contiguous, so the socket answers it with one cumulative ACK.
+  // Hold a reference since the socket may stop this buffer while closing.
+  Ptr<TcpSocketBase> tcp = m_tcp;
+  tcp->BeginRxBatch();
+  std::vector<TcpResequenceBufferElement>::const_iterator itr = run.begin();
+  for (; itr != run.end(); ++itr)
   {
     if (m_hasStopped)
     {
@@ -342,6 +364,15 @@ void TcpResequenceBuffer::FlushInOrderQueue(TcpRBPopReason reason)
     }
     TcpResequenceBuffer::FlushOneElement(*itr, reason); //加入原因
   }
+  tcp->EndRxBatch();
+}
+
+//提交顺序队列
+void TcpResequenceBuffer::FlushInOrderQueue(TcpRBPopReason reason)
+{
+  NS_LOG_FUNCTION(this);
+  // Flush the data
+  TcpResequenceBuffer::FlushRun(m_inOrderQueue, reason);
 
   //清空大小并更新时间
   m_inOrderQueue.clear();
@@ -364,11 +395,11 @@ void TcpResequenceBuffer::FlushOutOrderQueue(TcpRBPopReason reason)
     {
       break;
     }
-    TcpResequenceBuffer::FlushOneElement(m_outOrderQueue.top(), reason);
-    m_outOrderQueue.pop();
+    TcpResequenceBuffer::FlushOneElement(m_outOrderQueue.begin()->second, reason);
+    m_outOrderQueue.erase(m_outOrderQueue.begin());
   }
   //清空并更新时间
-  m_outOrderSeqSet.clear();
+  m_outOrderQueue.clear();
 
   // Reset the timer
   m_outOrderQueueTimer = Simulator::Now();
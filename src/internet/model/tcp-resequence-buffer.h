@@ -10,8 +10,7 @@
 #include "ns3/traced-value.h"
 
 #include <vector>
-#include <queue>
-#include <set>
+#include <map>
 
 namespace ns3
 {
@@ -45,11 +44,6 @@ public:
   Address m_fromAddress;
   //目的地址
   Address m_toAddress;
-  //重载比较运算符，用于priority_queue排序
-  friend inline bool operator > (const TcpResequenceBufferElement &l, const TcpResequenceBufferElement &r)
-  {
-    return l.m_seq > r.m_seq;
-  }
 };
 
 class TcpResequenceBuffer : public Object
@@ -79,9 +73,11 @@ private:
   bool PutInTheInOrderQueue (const TcpResequenceBufferElement &element);
   SequenceNumber32 CalculateNextSeq (const TcpResequenceBufferElement &element);
 
-  void PeriodicalCheck ();
+  void ScheduleTimeout ();
+  void CheckTimeout ();
 
   void FlushOneElement (const TcpResequenceBufferElement &element, TcpRBPopReason reason);
+  void FlushRun (const std::vector<TcpResequenceBufferElement> &run, TcpRBPopReason reason);
   void FlushInOrderQueue (TcpRBPopReason reason);
   void FlushOutOrderQueue (TcpRBPopReason reason);
 
@@ -91,8 +87,6 @@ private:
   //超时的时间阀
   Time m_inOrderQueueTimerLimit;
   Time m_outOrderQueueTimerLimit;
-  //周期性检测的时间 
-  Time m_periodicalCheckTime;
   //缓存的流的ID
   uint32_t m_traceFlowId;
 
@@ -102,8 +96,9 @@ private:
   //超时事件计时器
   Time m_inOrderQueueTimer;
   Time m_outOrderQueueTimer;
-  //检测事件
-  EventId m_checkEvent;
+  //超时事件，只在缓存非空时设定，到期时间为两个计时器中较早的期限
+  EventId m_timeoutEvent;
+  Time m_timeoutDeadline;
   //是否还在运行的变量
   bool m_hasStopped;
   //InOrederQueue中第一个包的
@@ -112,12 +107,9 @@ private:
   SequenceNumber32 m_nextSeq;
   //有序队列
   std::vector<TcpResequenceBufferElement> m_inOrderQueue;
-  //无序队列,注意这个实现中无序队列没有限制大小
-  std::priority_queue<TcpResequenceBufferElement,
-      std::vector<TcpResequenceBufferElement>,
-      std::greater<TcpResequenceBufferElement> > m_outOrderQueue;
-  //无序队列中包的顺序号
-  std::set<SequenceNumber32> m_outOrderSeqSet;
+  //无序队列，按起始序列号索引，每个元素覆盖[m_seq, CalculateNextSeq)区间
+  //注意这个实现中无序队列没有限制大小
+  std::map<SequenceNumber32, TcpResequenceBufferElement> m_outOrderQueue;
   //tcp
   TcpSocketBase *m_tcp;
 
@@ -18,7 +18,10 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
+
 #include "ns3/packet.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -40,6 +43,12 @@ TcpRxBuffer::GetTypeId (void)
                      "Next sequence number expected (RCV.NXT)",
                      MakeTraceSourceAccessor (&TcpRxBuffer::m_nextRxSeq),
                      "ns3::SequenceNumber32TracedValueCallback")
+    .AddAttribute ("VirtualPayload",
+                   "Keep only the sequence ranges of the received data, and "
+                   "deliver zero-filled packets (for applications sending dummy data)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpRxBuffer::m_virtualPayload),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -52,7 +61,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_virtualPayload (false)
 {
 }
 
@@ -114,6 +124,10 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
+  else if (m_virtualPayload && m_ranges.size ())
+    { // No data allowed beyond Rx window allowed
+      return m_ranges.begin ()->first + SequenceNumber32 (m_maxBuffer);
+    }
   else if (m_data.size ())
     { // No data allowed beyond Rx window allowed
       return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
@@ -141,6 +155,10 @@ bool
 TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 {
   NS_LOG_FUNCTION (this << p << tcph);
+  if (m_virtualPayload)
+    {
+      return AddVirtual (p, tcph);
+    }
 
   uint32_t pktSize = p->GetSize ();
   SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
@@ -228,6 +246,10 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
+  if (m_virtualPayload)
+    {
+      return ExtractVirtual (extractSize);
+    }
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
   BufIterator i;
@@ -265,4 +287,95 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   return outPkt;
 }
 
+bool
+TcpRxBuffer::AddVirtual (Ptr<Packet> p, TcpHeader const& tcph)
+{
+  SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
+  SequenceNumber32 tailSeq = headSeq + SequenceNumber32 (p->GetSize ());
+  NS_LOG_LOGIC ("Add virtual pkt len=" << p->GetSize () << " seq=" << headSeq
+                << ", when NextRxSeq=" << m_nextRxSeq << ", buffsize=" << m_size);
+
+  // Trim packet to fit Rx window specification
+  if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
+  if (m_ranges.size ())
+    {
+      SequenceNumber32 maxSeq = m_ranges.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      if (maxSeq < tailSeq) tailSeq = maxSeq;
+    }
+  if (headSeq >= tailSeq)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false;
+    }
+
+  // Merge [headSeq, tailSeq) with the ranges it overlaps or touches,
+  // counting the bytes which were not buffered yet
+  uint32_t added = tailSeq - headSeq;
+  SequenceNumber32 start = headSeq;
+  SequenceNumber32 end = tailSeq;
+  RangeIterator i = m_ranges.upper_bound (headSeq);
+  if (i != m_ranges.begin ())
+    {
+      RangeIterator prev = i;
+      --prev;
+      if (prev->second >= headSeq)
+        {
+          i = prev;
+        }
+    }
+  while (i != m_ranges.end () && i->first <= tailSeq)
+    {
+      SequenceNumber32 overlapStart = std::max (i->first, headSeq);
+      SequenceNumber32 overlapEnd = std::min (i->second, tailSeq);
+      if (overlapStart < overlapEnd)
+        {
+          added -= overlapEnd - overlapStart;
+        }
+      start = std::min (start, i->first);
+      end = std::max (end, i->second);
+      m_ranges.erase (i++);
+    }
+  m_ranges[start] = end;
+  if (added == 0)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false;
+    }
+
+  // Update variables
+  m_size += added;
+  if (start <= m_nextRxSeq && m_nextRxSeq < end)
+    {
+      m_availBytes += end - m_nextRxSeq.Get ();
+      m_nextRxSeq = end;
+    }
+  NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq
+                << " ranges=" << m_ranges.size ());
+  if (m_gotFin && m_nextRxSeq == m_finSeq)
+    { // Account for the FIN packet
+      ++m_nextRxSeq;
+    };
+  return true;
+}
+
+Ptr<Packet>
+TcpRxBuffer::ExtractVirtual (uint32_t extractSize)
+{
+  RangeIterator i = m_ranges.begin ();
+  NS_ASSERT (i != m_ranges.end ());
+  NS_ASSERT (i->first + SequenceNumber32 (extractSize) <= m_nextRxSeq); // in-sequence data expected
+  SequenceNumber32 start = i->first + SequenceNumber32 (extractSize);
+  SequenceNumber32 end = i->second;
+  m_ranges.erase (i);
+  if (start < end)
+    {
+      m_ranges[start] = end;
+    }
+  m_size -= extractSize;
+  m_availBytes -= extractSize;
+  NS_LOG_LOGIC ("Extracted " << extractSize << " bytes, bufsize=" << m_size
+                             << ", num ranges in buffer=" << m_ranges.size ());
+  return Create<Packet> (extractSize);
+}
+
 } //namepsace ns3
@@ -36,6 +36,12 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * With the VirtualPayload attribute set, the buffer keeps only the set
+ * of received sequence ranges, as an ordered map of disjoint intervals,
+ * and hands zero-filled packets to the application.  Extract() returns
+ * packets without packet tags in both modes; byte tags are not kept in
+ * virtual mode.
  */
 class TcpRxBuffer : public Object
 {
@@ -126,8 +132,26 @@ public:
   Ptr<Packet> Extract (uint32_t maxSize);
 
 private:
+  /**
+   * Add() for the virtual payload mode
+   *
+   * \param p packet
+   * \param tcph packet's TCP header
+   * \return True when success, false otherwise.
+   */
+  bool AddVirtual (Ptr<Packet> p, TcpHeader const& tcph);
+  /**
+   * Extract() for the virtual payload mode
+   *
+   * \param extractSize number of bytes to extract
+   * \returns a zero-filled packet
+   */
+  Ptr<Packet> ExtractVirtual (uint32_t extractSize);
+
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  /// container for the received ranges, from first byte to next byte
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator RangeIterator;
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
@@ -135,6 +159,8 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  bool m_virtualPayload;                     //!< Keep only sequence ranges, not the data
+  std::map<SequenceNumber32, SequenceNumber32> m_ranges; //!< Disjoint received ranges (virtual payload)
 };
 
 } //namepsace ns3
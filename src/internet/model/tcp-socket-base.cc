@@ -57,6 +57,7 @@
 
 #include "ipv4-ecn-tag.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/path-epoch-tag.h"
 #include "ns3/ipv4-xpath-tag.h"
 #include "ns3/tcp-tlb-tag.h"
 #include "ns3/ipv4-clove.h"
@@ -170,6 +171,10 @@ TcpSocketBase::GetTypeId(void)
                                         BooleanValue(false),
                                         MakeBooleanAccessor(&TcpSocketBase::m_isPauseEnabled),
                                         MakeBooleanChecker())
+                          .AddAttribute("ReroutePauseTime", "How long TCP pauses after a reroute when Pause is enabled",
+                                        TimeValue(MicroSeconds(80)),
+                                        MakeTimeAccessor(&TcpSocketBase::m_reroutePauseTime),
+                                        MakeTimeChecker())
                           .AddAttribute("ResequenceBufferPointer", "Resequence Buffer Pointer",
                                         PointerValue(),
                                         MakePointerAccessor(&TcpSocketBase::GetResequenceBuffer),
@@ -210,6 +215,18 @@ TcpSocketBase::GetTypeId(void)
                                           "Socket estimation of bytes in flight",
                                           MakeTraceSourceAccessor(&TcpSocketBase::m_bytesInFlight),
                                           "ns3::TracedValueCallback::Uint32")
+                          .AddTraceSource("PauseTime",
+                                          "Total time the socket has spent paused in FlowBender & TLB",
+                                          MakeTraceSourceAccessor(&TcpSocketBase::m_pauseTime),
+                                          "ns3::Time::TracedValueCallback")
+                          .AddTraceSource("PauseHeldBytes",
+                                          "Total bytes whose transmission a pause has held back",
+                                          MakeTraceSourceAccessor(&TcpSocketBase::m_pauseHeldBytes),
+                                          "ns3::TracedValueCallback::Uint32")
+                          .AddTraceSource("PathEpoch",
+                                          "Path epoch of the flow, bumped on every reroute",
+                                          MakeTraceSourceAccessor(&TcpSocketBase::m_pathEpochTrace),
+                                          "ns3::TracedValueCallback::Uint32")
                           .AddTraceSource("HighestRxSequence",
                                           "Highest sequence number received from peer",
                                           MakeTraceSourceAccessor(&TcpSocketBase::m_highRxMark),
@@ -262,7 +279,11 @@ TcpSocketState::GetTypeId(void)
                           .AddTraceSource("CongState",
                                           "TCP Congestion machine state",
                                           MakeTraceSourceAccessor(&TcpSocketState::m_congState),
-                                          "ns3::TracedValue::TcpCongStatesTracedValueCallback");
+                                          "ns3::TracedValue::TcpCongStatesTracedValueCallback")
+                          .AddTraceSource("PathEpoch",
+                                          "Path epoch of the flow",
+                                          MakeTraceSourceAccessor(&TcpSocketState::m_pathEpoch),
+                                          "ns3::TracedValue::Uint32Callback");
   return tid;
 }
 
@@ -279,7 +300,8 @@ TcpSocketState::TcpSocketState(void)
       m_demandCWR(false),
       m_queueCWR(false),
       m_CWRSentSeq(0),
-      m_congState(CA_OPEN)
+      m_congState(CA_OPEN),
+      m_pathEpoch(0)
 {
 }
 
@@ -295,7 +317,8 @@ TcpSocketState::TcpSocketState(const TcpSocketState &other)
       m_demandCWR(other.m_demandCWR),
       m_queueCWR(other.m_queueCWR),
       m_CWRSentSeq(0),
-      m_congState(other.m_congState)
+      m_congState(other.m_congState),
+      m_pathEpoch(other.m_pathEpoch)
 {
 }
 
@@ -363,6 +386,10 @@ TcpSocketBase::TcpSocketBase(void)
       m_retransOut(0),
       m_ecn(true),
       m_resequenceBufferEnabled(false),
+      m_rxBatchDepth(0),
+      m_rxBatchAckPending(false),
+      m_rxBatchAckFlags(0),
+      m_rxBatchNotify(false),
       m_flowBenderEnabled(false),
       // TLB
       m_TLBEnabled(false),
@@ -377,6 +404,9 @@ TcpSocketBase::TcpSocketBase(void)
       m_isPauseEnabled(false),
       m_isPause(false),
       m_oldPath(0),
+      m_reroutePauseTime(MicroSeconds(80)),
+      m_pauseTime(Seconds(0)),
+      m_pauseHeldBytes(0),
       m_congestionControl(0),
       m_isFirstPartialAck(true),
       m_retransmit_time(0), //add by myself
@@ -387,11 +417,19 @@ TcpSocketBase::TcpSocketBase(void)
       m_urgeSendNum(0),
       m_urgeNum(10),
       m_flowId(0),
+      m_flowIdCached(false),
+      m_flowIdSport(0),
+      m_flowIdDport(0),
+      m_cachedFlowId(0),
       enablePrt(false),
       m_cacheable(false),
       m_enableUrgeSend(false)
 {
   NS_LOG_FUNCTION(this);
+  m_retxEvent.SetFunction(&TcpSocketBase::ReTxTimerExpired, this);
+  m_urgePktEvent.SetFunction(&TcpSocketBase::SendUrgePacket, this);
+  m_delAckEvent.SetFunction(&TcpSocketBase::DelAckTimeout, this);
+  m_persistEvent.SetFunction(&TcpSocketBase::PersistTimeout, this);
   m_rxBuffer = CreateObject<TcpRxBuffer>();
   m_txBuffer = CreateObject<TcpTxBuffer>();
   m_tcb = CreateObject<TcpSocketState>();
@@ -411,6 +449,7 @@ TcpSocketBase::TcpSocketBase(void)
 
   // Flow Bender support
   m_flowBender = CreateObject<TcpFlowBender>();
+  m_flowBender->SetRerouteCallback(MakeCallback(&TcpSocketBase::Reroute, this));
 
   // Pause support
   m_pauseBuffer = CreateObject<TcpPauseBuffer>();
@@ -428,6 +467,10 @@ TcpSocketBase::TcpSocketBase(void)
   ok = m_tcb->TraceConnectWithoutContext("CongState",
                                          MakeCallback(&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT(ok == true);
+
+  ok = m_tcb->TraceConnectWithoutContext("PathEpoch",
+                                         MakeCallback(&TcpSocketBase::UpdatePathEpoch, this));
+  NS_ASSERT(ok == true);
 }
 
 //根据其它变量初始化
@@ -480,6 +523,10 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase &sock)
       m_retransOut(sock.m_retransOut),
       m_ecn(sock.m_ecn),
       m_resequenceBufferEnabled(sock.m_resequenceBufferEnabled),
+      m_rxBatchDepth(0),
+      m_rxBatchAckPending(false),
+      m_rxBatchAckFlags(0),
+      m_rxBatchNotify(false),
       m_flowBenderEnabled(sock.m_flowBenderEnabled),
       // TLB
       m_TLBEnabled(sock.m_TLBEnabled),
@@ -494,6 +541,9 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase &sock)
       m_isPauseEnabled(sock.m_isPauseEnabled),
       m_isPause(false),
       m_oldPath(0),
+      m_reroutePauseTime(sock.m_reroutePauseTime),
+      m_pauseTime(Seconds(0)),
+      m_pauseHeldBytes(0),
       m_isFirstPartialAck(sock.m_isFirstPartialAck),
       m_txTrace(sock.m_txTrace),
       m_rxTrace(sock.m_rxTrace),
@@ -505,11 +555,19 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase &sock)
       m_urgeSendNum(0),
       m_urgeNum(10),
       m_flowId(0),
+      m_flowIdCached(false),
+      m_flowIdSport(0),
+      m_flowIdDport(0),
+      m_cachedFlowId(0),
       m_cacheable(sock.m_cacheable),
       m_enableUrgeSend(sock.m_enableUrgeSend)
 {
   NS_LOG_FUNCTION(this);
   NS_LOG_LOGIC("Invoked the copy constructor");
+  m_retxEvent.SetFunction(&TcpSocketBase::ReTxTimerExpired, this);
+  m_urgePktEvent.SetFunction(&TcpSocketBase::SendUrgePacket, this);
+  m_delAckEvent.SetFunction(&TcpSocketBase::DelAckTimeout, this);
+  m_persistEvent.SetFunction(&TcpSocketBase::PersistTimeout, this);
   // Copy the rtt estimator if it is set
   if (sock.m_rtt)
   {
@@ -544,6 +602,7 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase &sock)
 
   // Flow Bender support
   m_flowBender = CreateObject<TcpFlowBender>();
+  m_flowBender->SetRerouteCallback(MakeCallback(&TcpSocketBase::Reroute, this));
 
   // Pause support
   m_pauseBuffer = CreateObject<TcpPauseBuffer>();
@@ -566,6 +625,10 @@ TcpSocketBase::TcpSocketBase(const TcpSocketBase &sock)
   ok = m_tcb->TraceConnectWithoutContext("CongState",
                                          MakeCallback(&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT(ok == true);
+
+  ok = m_tcb->TraceConnectWithoutContext("PathEpoch",
+                                         MakeCallback(&TcpSocketBase::UpdatePathEpoch, this));
+  NS_ASSERT(ok == true);
 }
 
 //清理
@@ -1485,11 +1548,11 @@ void TcpSocketBase::DoForwardUp(Ptr<Packet> packet, const Address &fromAddress,
   if (m_rWnd.Get() == 0 && m_persistEvent.IsExpired())
   { // Zero window: Enter persist state to send 1 byte to probe
     NS_LOG_LOGIC(this << " Enter zerowindow persist state");
-    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + Simulator::GetDelayLeft(m_retxEvent)).GetSeconds());
+    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + m_retxEvent.GetDelayLeft()).GetSeconds());
     m_retxEvent.Cancel();
     NS_LOG_LOGIC("Schedule persist timeout at time " << Simulator::Now().GetSeconds() << " to expire at time " << (Simulator::Now() + m_persistTimeout).GetSeconds());
-    m_persistEvent = Simulator::Schedule(m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
-    NS_ASSERT(m_persistTimeout == Simulator::GetDelayLeft(m_persistEvent));
+    m_persistEvent.Schedule(m_persistTimeout);
+    NS_ASSERT(m_persistTimeout == m_persistEvent.GetDelayLeft());
   }
 
   // TCP state machine code in different process functions
@@ -2449,6 +2512,8 @@ void TcpSocketBase::PeerClose(Ptr<Packet> p, const TcpHeader &tcpHeader)
   {
     return;
   }
+  // Data held back by a receive batch goes out before the close is processed
+  FlushRxBatch();
 
   // Simultaneous close: Application invoked Close() when we are processing this FIN packet
   // 由FIN_WAIT_1到CLSING状态
@@ -2516,7 +2581,7 @@ void TcpSocketBase::Destroy(void)
   {
     m_tcp->RemoveSocket(this);
   }
-  NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + Simulator::GetDelayLeft(m_retxEvent)).GetSeconds());
+  NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + m_retxEvent.GetDelayLeft()).GetSeconds());
   CancelAllTimers();
 }
 
@@ -2530,7 +2595,7 @@ void TcpSocketBase::Destroy6(void)
   {
     m_tcp->RemoveSocket(this);
   }
-  NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + Simulator::GetDelayLeft(m_retxEvent)).GetSeconds());
+  NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + m_retxEvent.GetDelayLeft()).GetSeconds());
   CancelAllTimers();
 }
 
@@ -2573,16 +2638,9 @@ void TcpSocketBase::SendUrgePacket(uint32_t urgeNum)
     TcpSocketBase::AttachFlowId(p, m_endPoint->GetLocalAddress(),
                                 m_endPoint->GetPeerAddress(), header.GetSourcePort(), header.GetDestinationPort());
 
-    if (m_isPause) //如果有Pause则缓存
-    {
-      std::cout << "Pause enabled, buffering packet..." << std::endl;
-      m_pauseBuffer->BufferItem(p, header);
-    }
-    else
-    { //否则直接TCP发送
-      m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
-                        m_endPoint->GetPeerAddress(), m_boundnetdevice);
-    }
+    //不带数据的包不受Pause影响，直接TCP发送
+    m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
+                      m_endPoint->GetPeerAddress(), m_boundnetdevice);
   }
   else
   {
@@ -2750,11 +2808,8 @@ void TcpSocketBase::SendEmptyPacket(uint8_t flags)
 
       if (m_isPauseEnabled && !m_isPause && m_oldPath != path)
       {
-        std::cout << "Turning on pause" << std::endl;
-        m_isPause = true;
         m_oldPath = path;
-        Time pauseTime = ipv4TLB->GetPauseTime(flowId);
-        Simulator::Schedule(pauseTime, &TcpSocketBase::RecoverFromPause, this);
+        StartPause(ipv4TLB->GetPauseTime(flowId));
       }
     }
     // 如果设定了m_piggybackTLBInfo，则添加TLB标签
@@ -2822,16 +2877,9 @@ void TcpSocketBase::SendEmptyPacket(uint8_t flags)
     TcpSocketBase::AttachFlowId(p, m_endPoint->GetLocalAddress(),
                                 m_endPoint->GetPeerAddress(), header.GetSourcePort(), header.GetDestinationPort());
 
-    if (m_isPause) //如果有Pause则缓存
-    {
-      std::cout << "Pause enabled, buffering packet..." << std::endl;
-      m_pauseBuffer->BufferItem(p, header);
-    }
-    else
-    { //否则直接TCP发送
-      m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
-                        m_endPoint->GetPeerAddress(), m_boundnetdevice);
-    }
+    //不带数据的包不受Pause影响，直接TCP发送
+    m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
+                      m_endPoint->GetPeerAddress(), m_boundnetdevice);
   }
   else
   {
@@ -2856,7 +2904,8 @@ void TcpSocketBase::SendEmptyPacket(uint8_t flags)
     NS_LOG_LOGIC("Schedule retransmission timeout at time "
                  << Simulator::Now().GetSeconds() << " to expire at time "
                  << (Simulator::Now() + m_rto.Get()).GetSeconds());
-    m_retxEvent = Simulator::Schedule(m_rto, &TcpSocketBase::SendEmptyPacket, this, flags);
+    m_retxEvent.SetArguments(flags);
+    m_retxEvent.Schedule(m_rto);
   }
 }
 
@@ -3041,6 +3090,36 @@ uint32_t
 TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withAck)
 {
   NS_LOG_FUNCTION(this << seq << maxSize << withAck);
+  // XXX TLB Support
+  // 在构造头部、标记CWR、设置定时器之前选路，换路触发的Pause在此处扣住这个包
+  Ptr<Ipv4TLB> ipv4TLB;
+  uint32_t tlbFlowId = 0;
+  uint32_t tlbPath = 0;
+  if (m_endPoint != 0 && !m_isPause && m_TLBEnabled && m_TLBSendSide)
+  {
+    ipv4TLB = m_node->GetObject<Ipv4TLB>();
+    tlbFlowId = TcpSocketBase::CalFlowId(m_endPoint->GetLocalAddress(), m_endPoint->GetPeerAddress(),
+                                         m_endPoint->GetLocalPort(), m_endPoint->GetPeerPort());
+    tlbPath = ipv4TLB->GetPath(tlbFlowId, m_endPoint->GetLocalAddress(), m_endPoint->GetPeerAddress());
+    // std::cout << this << " Get Path From TLB: " << tlbPath << std::endl;
+
+    // Pause Support
+    if (m_isPauseEnabled && m_oldPath == 0)
+    {
+      m_oldPath = tlbPath;
+    }
+    if (m_isPauseEnabled && m_oldPath != tlbPath)
+    {
+      m_oldPath = tlbPath;
+      StartPause(ipv4TLB->GetPauseTime(tlbFlowId));
+    }
+  }
+  //暂停期间只记录被扣住的序列号区间，不复制数据，暂停结束后再发送
+  if (m_isPause && m_endPoint != 0)
+  {
+    m_pauseBuffer->Hold(seq, std::min(maxSize, m_txBuffer->SizeFromSequence(seq)));
+    return 0;
+  }
   //得到是否为重传
   bool isRetransmission = false;
   if (seq != m_highTxMark)
@@ -3163,7 +3242,8 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
 
     NS_LOG_LOGIC(this << " SendDataPacket Schedule ReTxTimeout at time " << Simulator::Now().GetSeconds() << " to expire at time " << (Simulator::Now() + m_rto.Get()).GetSeconds());
     //重新开启Timer
-    m_retxEvent = Simulator::Schedule(m_rto, &TcpSocketBase::ReTxTimeout, this);
+    m_retxEvent.SetArguments<uint8_t>(0);
+    m_retxEvent.Schedule(m_rto);
   }
 
   /***************************************************************************/
@@ -3172,7 +3252,8 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
     m_urgeSendNum++;
     if (m_urgeSendNum % 10 == 0 && m_cacheable && m_urgePktEvent.IsExpired())
     {
-      m_urgePktEvent = Simulator::Schedule(m_rto * 4 / 5, &TcpSocketBase::SendUrgePacket, this, 10);
+      m_urgePktEvent.SetArguments<uint32_t>(10);
+      m_urgePktEvent.Schedule(m_rto * 4 / 5);
     }
   }
   /***************************************************************************/
@@ -3186,41 +3267,20 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
                                 m_endPoint->GetPeerAddress(), header.GetSourcePort(), header.GetDestinationPort());
     /***************************************************************************/
     // XXX TLB Support
-    // 如果开启了TLB并且是发送端
-    if (m_TLBEnabled && m_TLBSendSide)
+    // 如果开启了TLB并且是发送端，添加开头选定路径的xpath标签和TLB标签
+    if (ipv4TLB != 0)
     {
-      //得到FlowId并且添加xpath标签和TLB标签
-      uint32_t flowId = TcpSocketBase::CalFlowId(m_endPoint->GetLocalAddress(),
-                                                 m_endPoint->GetPeerAddress(), header.GetSourcePort(), header.GetDestinationPort());
-      Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB>();
-      uint32_t path = ipv4TLB->GetPath(flowId, m_endPoint->GetLocalAddress(), m_endPoint->GetPeerAddress());
-      // std::cout << this << " Get Path From TLB: " << path << std::endl;
-
       // XPath Support
       Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId(path);
+      ipv4XPathTag.SetPathId(tlbPath);
       p->AddPacketTag(ipv4XPathTag);
 
       // TLB Support
       TcpTLBTag tcpTLBTag;
-      tcpTLBTag.SetPath(path);
+      tcpTLBTag.SetPath(tlbPath);
       tcpTLBTag.SetTime(Simulator::Now());
       p->AddPacketTag(tcpTLBTag);
-      ipv4TLB->FlowSend(flowId, m_endPoint->GetPeerAddress(), path, p->GetSize(), isRetransmission);
-
-      // Pause Support
-      if (m_isPauseEnabled && m_oldPath == 0)
-      {
-        m_oldPath = path;
-      }
-      if (m_isPauseEnabled && !m_isPause && m_oldPath != path)
-      {
-        std::cout << "Turning on pause ..." << std::endl;
-        m_isPause = true;
-        m_oldPath = path;
-        Time pauseTime = ipv4TLB->GetPauseTime(flowId);
-        Simulator::Schedule(pauseTime, &TcpSocketBase::RecoverFromPause, this);
-      }
+      ipv4TLB->FlowSend(tlbFlowId, m_endPoint->GetPeerAddress(), tlbPath, p->GetSize(), isRetransmission);
     }
 
     // XXX Clove Support
@@ -3247,17 +3307,8 @@ TcpSocketBase::SendDataPacket(SequenceNumber32 seq, uint32_t maxSize, bool withA
       }
     }
 
-    //如果开启了Pause则暂时缓存
-    if (m_isPause)
-    {
-      std::cout << "Pause enabled, buffering packet ..." << std::endl;
-      m_pauseBuffer->BufferItem(p, header);
-    }
-    else //否则直接发送
-    {
-      m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
-                        m_endPoint->GetPeerAddress(), m_boundnetdevice);
-    }
+    m_tcp->SendPacket(p, header, m_endPoint->GetLocalAddress(),
+                      m_endPoint->GetPeerAddress(), m_boundnetdevice);
     NS_LOG_DEBUG("Send segment of size " << sz << " with remaining data " << remainingData << " via TcpL4Protocol to " << m_endPoint->GetPeerAddress() << ". Header " << header);
   }
   else //否则IPV6支持
@@ -3349,6 +3400,10 @@ bool TcpSocketBase::SendPendingData(bool withAck)
     //发包
     uint32_t s = std::min(w, m_tcb->m_segmentSize); // Send no more than window
     uint32_t sz = SendDataPacket(m_nextTxSequence, s, withAck);
+    if (sz == 0)
+    {
+      break; // Paused, the data stays in the Tx buffer
+    }
     nPacketsSent++;         // Count sent this loop
     m_nextTxSequence += sz; // Advance next tx sequence
     if (nPacketsSent == 2)  //最多发送两个包就break
@@ -3444,6 +3499,58 @@ TcpSocketBase::AdvertisedWindowSize() const
   return (uint16_t)w;
 }
 
+// 开始批量接收，期间产生的ACK与上层通知都延后到批处理结束
+void TcpSocketBase::BeginRxBatch(void)
+{
+  NS_LOG_FUNCTION(this);
+  ++m_rxBatchDepth;
+}
+
+// 结束批量接收，最外层结束时发送一个累计ACK并通知上层一次
+void TcpSocketBase::EndRxBatch(void)
+{
+  NS_LOG_FUNCTION(this);
+  NS_ASSERT(m_rxBatchDepth > 0);
+  if (--m_rxBatchDepth == 0)
+  {
+    FlushRxBatch();
+  }
+}
+
+// 发送批处理中延后的ACK与上层通知
+void TcpSocketBase::FlushRxBatch(void)
+{
+  if (m_rxBatchAckPending)
+  {
+    // One cumulative ACK covers every segment of the run, so the delayed
+    // ACK that some of them may have armed is no longer needed
+    m_rxBatchAckPending = false;
+    m_delAckEvent.Cancel();
+    m_delAckCount = 0;
+    SendEmptyPacket(m_rxBatchAckFlags);
+  }
+  if (m_rxBatchNotify)
+  {
+    m_rxBatchNotify = false;
+    if (!m_shutdownRecv)
+    {
+      NotifyDataRecv();
+    }
+  }
+}
+
+// 发送数据的ACK，批处理中只记录标志，标志变化前ReceivedData已发出之前的ACK
+void TcpSocketBase::SendRxAck(uint8_t flags)
+{
+  if (m_rxBatchDepth > 0)
+  {
+    m_rxBatchAckPending = true;
+    m_rxBatchAckFlags = flags;
+    return;
+  }
+  SendEmptyPacket(flags);
+}
+
 // Receipt of new packet, put into Rx buffer
 // 收到新包将其放至RxBuf
 void TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader &tcpHeader)
@@ -3494,6 +3601,12 @@ void TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader &tcpHeader)
   {
     sendflags |= TcpHeader::ECE;
   }
+  // 与批处理中延后的ACK标志不同(如ECE变化)时不能合并，
+  // 先发出覆盖之前各段的累计ACK，再把这个段放入接收缓存
+  if (m_rxBatchAckPending && sendflags != m_rxBatchAckFlags)
+  {
+    FlushRxBatch();
+  }
 
   // XXX TLB Support
   // 如果支持TLB并且是的接收方
@@ -3527,14 +3640,14 @@ void TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader &tcpHeader)
   SequenceNumber32 expectedSeq = m_rxBuffer->NextRxSequence();
   if (!m_rxBuffer->Add(p, tcpHeader)) //这里会将包插入buff，如果失败，则退出
   {                                   // Insert failed: No data or RX buffer full
-    SendEmptyPacket(sendflags);
+    SendRxAck(sendflags);
     return;
   }
   // Now send a new ACK packet acknowledging all received and delivered data
   // 如果buff实际上占用空间大于可读空间证明中间有gap，则返回ACK
   if (m_rxBuffer->Size() > m_rxBuffer->Available() || m_rxBuffer->NextRxSequence() > expectedSeq + p->GetSize())
   { // A gap exists in the buffer, or we filled a gap: Always ACK
-    SendEmptyPacket(sendflags);
+    SendRxAck(sendflags);
   }
   else
   { // In-sequence packet: ACK if delayed ack count allows
@@ -3544,20 +3657,27 @@ void TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader &tcpHeader)
       m_congestionControl->CwndEvent(m_tcb, TcpCongestionOps::CA_EVENT_DELAY_ACK_NO_RESERVED, this);
       m_delAckEvent.Cancel();
       m_delAckCount = 0;
-      SendEmptyPacket(sendflags);
+      SendRxAck(sendflags);
+    }
+    else if (m_rxBatchAckPending) //批处理结束时的累计ACK会覆盖这个包
+    {
+      NS_LOG_LOGIC(this << " delayed ACK folded into the batch ACK");
     }
     else if (m_delAckEvent.IsExpired()) //如果delay Ack事件已经过期则重新调度
     {
       m_congestionControl->CwndEvent(m_tcb, TcpCongestionOps::CA_EVENT_DELAY_ACK_RESERVED, this);
-      m_delAckEvent = Simulator::Schedule(m_delAckTimeout,
-                                          &TcpSocketBase::DelAckTimeout, this);
-      NS_LOG_LOGIC(this << " scheduled delayed ACK at " << (Simulator::Now() + Simulator::GetDelayLeft(m_delAckEvent)).GetSeconds());
+      m_delAckEvent.Schedule(m_delAckTimeout);
+      NS_LOG_LOGIC(this << " scheduled delayed ACK at " << (Simulator::Now() + m_delAckEvent.GetDelayLeft()).GetSeconds());
     }
   }
   // Notify app to receive if necessary
   if (expectedSeq < m_rxBuffer->NextRxSequence())
   {                      // NextRxSeq advanced, we have something to send to the app
-    if (!m_shutdownRecv) //如果已经关闭了接收，则通知上层来取数据
+    if (m_rxBatchDepth > 0) //批处理中只记录，结束时统一通知
+    {
+      m_rxBatchNotify = true;
+    }
+    else if (!m_shutdownRecv) //如果已经关闭了接收，则通知上层来取数据
     {
       NotifyDataRecv();
     }
@@ -3572,6 +3692,7 @@ void TcpSocketBase::ReceivedData(Ptr<Packet> p, const TcpHeader &tcpHeader)
     // Finished函数检查是否收到了所有数据或连接已经关闭
     if (m_rxBuffer->Finished() && (tcpHeader.GetFlags() & TcpHeader::FIN) == 0)
     {
+      FlushRxBatch();
       DoPeerClose();
     }
   }
@@ -3642,7 +3763,7 @@ void TcpSocketBase::NewAck(SequenceNumber32 const &ack, bool resetRTO)
 
   if (m_state != SYN_RCVD && resetRTO)
   { // Set RTO unless the ACK is received in SYN_RCVD state
-    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + Simulator::GetDelayLeft(m_retxEvent)).GetSeconds());
+    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + m_retxEvent.GetDelayLeft()).GetSeconds());
     m_retxEvent.Cancel(); //取消重传事件
     m_urgePktEvent.Cancel();
     // On receiving a "New" ack we restart retransmission timer .. RFC 6298
@@ -3657,10 +3778,12 @@ void TcpSocketBase::NewAck(SequenceNumber32 const &ack, bool resetRTO)
 
     if (m_cacheable && m_enableUrgeSend)
     {
-      m_urgePktEvent = Simulator::Schedule(m_rto * 4 / 5, &TcpSocketBase::SendUrgePacket, this, m_urgeNum);
+      m_urgePktEvent.SetArguments(m_urgeNum);
+      m_urgePktEvent.Schedule(m_rto * 4 / 5);
     }
 
-    m_retxEvent = Simulator::Schedule(m_rto, &TcpSocketBase::ReTxTimeout, this);
+    m_retxEvent.SetArguments<uint8_t>(0);
+    m_retxEvent.Schedule(m_rto);
   }
 
   // Note the highest ACK and tell app to send more
@@ -3679,11 +3802,25 @@ void TcpSocketBase::NewAck(SequenceNumber32 const &ack, bool resetRTO)
   //如果没数据可发送，则取消超时事件
   if (m_txBuffer->Size() == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
   { // No retransmit timer if no data to retransmit
-    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + Simulator::GetDelayLeft(m_retxEvent)).GetSeconds());
+    NS_LOG_LOGIC(this << " Cancelled ReTxTimeout event which was set to expire at " << (Simulator::Now() + m_retxEvent.GetDelayLeft()).GetSeconds());
     m_retxEvent.Cancel();
   }
 }
 
+// Retransmission timer expired: resend the SYN/FIN segment it was armed
+// for, or handle a data retransmission timeout
+void TcpSocketBase::ReTxTimerExpired(uint8_t flags)
+{
+  if (flags != 0)
+  {
+    SendEmptyPacket(flags);
+  }
+  else
+  {
+    ReTxTimeout();
+  }
+}
+
 // Retransmit timeout
 // 重传超时
 void TcpSocketBase::ReTxTimeout()
@@ -3779,7 +3916,7 @@ void TcpSocketBase::PersistTimeout()
   NS_LOG_LOGIC("Schedule persist timeout at time "
                << Simulator::Now().GetSeconds() << " to expire at time "
                << (Simulator::Now() + m_persistTimeout).GetSeconds());
-  m_persistEvent = Simulator::Schedule(m_persistTimeout, &TcpSocketBase::PersistTimeout, this);
+  m_persistEvent.Schedule(m_persistTimeout);
 }
 
 //重传，调用DoRetransmit()
@@ -3916,6 +4053,7 @@ void TcpSocketBase::CancelAllTimers()
   m_lastAckEvent.Cancel();
   m_timewaitEvent.Cancel();
   m_sendPendingDataEvent.Cancel();
+  m_pauseEvent.Cancel();
 }
 
 //在关闭TCP连接转到TIME_WAIT状态进行过渡然后到关闭状态
@@ -4289,6 +4427,23 @@ void TcpSocketBase::UpdateCongState(TcpSocketState::TcpCongState_t oldValue,
   m_congStateTrace(oldValue, newValue);
 }
 
+//路径epoch改变后暂停发送，让旧路径上的包先到达
+void TcpSocketBase::UpdatePathEpoch(uint32_t oldValue, uint32_t newValue)
+{
+  m_pathEpochTrace(oldValue, newValue);
+  if (m_isPauseEnabled && !m_isPause)
+  {
+    StartPause(m_reroutePauseTime);
+  }
+}
+
+//将流切换到另一条路径
+void TcpSocketBase::Reroute(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_tcb->m_pathEpoch += 1;
+}
+
 //设置拥塞控制算法
 void TcpSocketBase::SetCongestionControlAlgorithm(Ptr<TcpCongestionOps> algo)
 {
@@ -4335,31 +4490,14 @@ void TcpSocketBase::AttachFlowId(Ptr<Packet> packet,
 
   uint32_t flowId = TcpSocketBase::CalFlowId(saddr, daddr, sport, dport);
   m_flowId = flowId;
-  // XXX Flow Bender support
-  if (m_flowBenderEnabled)
-  {
-    uint32_t path = m_flowBender->GetV();
-    flowId += path;
-
-    //如果开启了Pause支持
-    // Pause Support
-    if (m_isPauseEnabled && m_oldPath == 0)
-    {
-      m_oldPath = path;
-    }
-    if (m_isPauseEnabled && !m_isPause && m_oldPath != 0 && m_oldPath != path)
-    {
-      std::cout << "Turning on pause ..." << std::endl;
-      m_isPause = true;
-      m_oldPath = path;
-      Time pauseTime = m_flowBender->GetPauseTime();
-      //在pauseTime后从Pause中恢复过来
-      Simulator::Schedule(pauseTime, &TcpSocketBase::RecoverFromPause, this);
-    }
-  }
 
   //更改Tag
   packet->AddPacketTag(FlowIdTag(flowId));
+  //流被重路由过时，带上路径epoch供ECMP哈希
+  if (m_tcb->m_pathEpoch != 0)
+  {
+    packet->AddPacketTag(PathEpochTag(m_tcb->m_pathEpoch));
+  }
 }
 
 /************************************************Modify*********************************/
@@ -4368,28 +4506,63 @@ uint32_t
 TcpSocketBase::CalFlowId(const Ipv4Address &saddr, const Ipv4Address &daddr,
                          uint16_t sport, uint16_t dport)
 {
+  if (m_flowIdCached && m_flowIdSaddr == saddr && m_flowIdDaddr == daddr
+      && m_flowIdSport == sport && m_flowIdDport == dport)
+  {
+    return m_cachedFlowId;
+  }
   // Time now = Simulator::Now();
   std::stringstream hash_string;
   //hash_string << now.GetMicroSeconds();
   hash_string << daddr.Get() << saddr.Get();
   hash_string << dport << sport;
 
-  return Hash32(hash_string.str());
+  m_flowIdCached = true;
+  m_flowIdSaddr = saddr;
+  m_flowIdDaddr = daddr;
+  m_flowIdSport = sport;
+  m_flowIdDport = dport;
+  m_cachedFlowId = Hash32(hash_string.str());
+  return m_cachedFlowId;
 }
 /************************************************Modify*********************************/
 
-//将m_pauseBuff中的包都发送出去，并且关闭Pause
+//开启Pause，在pauseTime后恢复
+void TcpSocketBase::StartPause(Time pauseTime)
+{
+  NS_LOG_FUNCTION(this << pauseTime);
+  m_isPause = true;
+  m_pauseStart = Simulator::Now();
+  m_pauseEvent = Simulator::Schedule(pauseTime, &TcpSocketBase::RecoverFromPause, this);
+}
+
+//关闭Pause，按正常发送流程发出被扣住的序列号区间
 void TcpSocketBase::RecoverFromPause(void)
 {
-  std::cout << "Recovering from pause, flushing packets out..." << std::endl;
-  while (m_pauseBuffer->HasBufferedItem())
+  NS_LOG_FUNCTION(this);
+  m_isPause = false;
+  m_pauseTime += Simulator::Now() - m_pauseStart;
+  if (!m_pauseBuffer->HasHeldRange())
   {
-    struct TcpPauseItem item = m_pauseBuffer->GetBufferedItem();
-
-    m_tcp->SendPacket(item.packet, item.header, m_endPoint->GetLocalAddress(),
-                      m_endPoint->GetPeerAddress(), m_boundnetdevice);
+    return;
   }
-  m_isPause = false;
+  m_pauseHeldBytes += m_pauseBuffer->GetHeldBytes();
+  TcpPauseBuffer::HeldRanges heldRanges = m_pauseBuffer->Release();
+  if (m_endPoint == 0)
+  {
+    return;
+  }
+  //m_nextTxSequence之前的区间是被扣住的重传，已被确认的不再发送
+  for (TcpPauseBuffer::HeldRanges::iterator itr = heldRanges.begin();
+       itr != heldRanges.end() && itr->first < m_nextTxSequence; ++itr)
+  {
+    if (itr->first >= m_txBuffer->HeadSequence())
+    {
+      SendDataPacket(itr->first, itr->second, true);
+    }
+  }
+  //新数据仍在发送缓存中，从m_nextTxSequence继续发送
+  SendPendingData(m_connected);
 }
 
 /***************************************************************/
@@ -34,6 +34,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/lazy-timer.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
@@ -172,6 +173,9 @@ public:
 
   TracedValue<TcpCongState_t> m_congState; //!< State in the Congestion state machine
 
+  // Rerouting
+  TracedValue<uint32_t> m_pathEpoch; //!< Path epoch of the flow, bumped to move the flow to another path
+
   /**
    * \brief Get cwnd in segments rather than bytes
    *
@@ -362,6 +366,11 @@ public:
    */
   TracedCallback<TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t> m_congStateTrace;
 
+  /**
+   * \brief Callback pointer for path epoch trace chaining
+   */
+  TracedCallback<uint32_t, uint32_t> m_pathEpochTrace;
+
   /**
    * \brief Callback function to hook to TcpSocketState congestion window
    * \param oldValue old cWnd value
@@ -384,6 +393,26 @@ public:
   void UpdateCongState(TcpSocketState::TcpCongState_t oldValue,
                        TcpSocketState::TcpCongState_t newValue);
 
+  /**
+   * \brief Callback function to hook to TcpSocketState path epoch
+   *
+   * Starts a pause, when enabled, so the packets on the old path can drain
+   * before the flow moves to the new one.
+   *
+   * \param oldValue old path epoch
+   * \param newValue new path epoch
+   */
+  void UpdatePathEpoch(uint32_t oldValue, uint32_t newValue);
+
+  /**
+   * \brief Move the flow to another path
+   *
+   * Bumps the path epoch carried by the later packets of the flow, so that
+   * per-flow ECMP hashes them onto a new path.  Congestion control
+   * algorithms can do the same by bumping TcpSocketState::m_pathEpoch.
+   */
+  void Reroute(void);
+
   /**
    * \brief Install a congestion control algorithm on this socket
    *
@@ -545,6 +574,40 @@ protected:
   virtual void DoForwardUp(Ptr<Packet> packet, const Address &fromAddress,
                            const Address &toAddress);
 
+  /**
+   * \brief Start a batch of received segments
+   *
+   * Until the matching EndRxBatch(), segments passed to DoForwardUp() are
+   * processed as usual but the ACKs they trigger and the application
+   * notification are held back. Batches may nest.
+   */
+  void BeginRxBatch(void);
+
+  /**
+   * \brief Finish a batch of received segments
+   *
+   * When the outermost batch ends, send one cumulative ACK for the whole
+   * run if any segment asked for one, and notify the application once.
+   */
+  void EndRxBatch(void);
+
+  /**
+   * \brief Send the ACK and the application notification held back by the
+   *        current batch, if any
+   */
+  void FlushRxBatch(void);
+
+  /**
+   * \brief Send an ACK for received data, or hold it back inside a batch
+   *
+   * Within a batch, ReceivedData() flushes the held back ACK before a
+   * segment whose ACK flags differ (e.g. ECE) enters the Rx buffer, so
+   * one cumulative ACK never covers segments with different flags.
+   *
+   * \param flags the ACK's flags
+   */
+  void SendRxAck(uint8_t flags);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -928,20 +991,53 @@ protected:
   void AttachFlowId(Ptr<Packet> packet, const Ipv4Address &saddr, const Ipv4Address &daddr,
                     uint16_t sport, uint16_t dport);
 
+  /**
+   * \brief Hash the four-tuple of the flow into its flow id
+   *
+   * The hash is computed once per four-tuple and cached, so the per-packet
+   * callers do not rebuild and hash the tuple string every time.
+   */
   uint32_t CalFlowId(const Ipv4Address &saddr, const Ipv4Address &daddr,
                      uint16_t sport, uint16_t dport);
 
+  /**
+   * \brief Stop sending data until pauseTime has passed
+   *
+   * While paused, segments are not transmitted; the sequence ranges they
+   * cover are recorded in m_pauseBuffer instead.
+   *
+   * \param pauseTime the pause duration
+   */
+  void StartPause(Time pauseTime);
+
+  /**
+   * \brief End the pause and send the held sequence ranges through the
+   * normal send path
+   */
   void RecoverFromPause(void);
   /******************************************************************************/
   void SendUrgePacket(uint32_t urgeNum);
   /******************************************************************************/
+
+  /**
+   * \brief Called when the retransmission timer expires
+   *
+   * The same timer guards SYN/FIN and data segments.
+   *
+   * \param flags the flags of the SYN/FIN segment to resend, or 0 for a
+   *        data retransmission timeout
+   */
+  void ReTxTimerExpired(uint8_t flags);
+
 protected:
   // Counters and events
-  EventId m_retxEvent;         //!< Retransmission event
-  EventId m_urgePktEvent;      //Add by myself
+  // The timers re-armed on every ACK are lazy: pushing their deadline
+  // later does not touch the event queue.
+  LazyTimer m_retxEvent;       //!< Retransmission timer
+  LazyTimer m_urgePktEvent;    //Add by myself
   EventId m_lastAckEvent;      //!< Last ACK timeout event
-  EventId m_delAckEvent;       //!< Delayed ACK timeout event
-  EventId m_persistEvent;      //!< Persist event: Send 1 byte to probe for a non-zero Rx window
+  LazyTimer m_delAckEvent;     //!< Delayed ACK timer
+  LazyTimer m_persistEvent;    //!< Persist timer: Send 1 byte to probe for a non-zero Rx window
   EventId m_timewaitEvent;     //!< TIME_WAIT expiration event: Move this socket to CLOSED state
   uint32_t m_dupAckCount;      //!< Dupack counter
   uint32_t m_delAckCount;      //!< Delayed ACK counter
@@ -969,6 +1065,13 @@ protected:
   int m_retranTime;
   uint32_t m_urgeSendNum;
   uint32_t m_flowId;
+  // CalFlowId的缓存
+  bool m_flowIdCached;
+  Ipv4Address m_flowIdSaddr;
+  Ipv4Address m_flowIdDaddr;
+  uint16_t m_flowIdSport;
+  uint16_t m_flowIdDport;
+  uint32_t m_cachedFlowId;
   bool enablePrt;
   uint32_t m_urgeNum;
   bool m_cacheable;
@@ -1035,6 +1138,12 @@ protected:
   bool m_resequenceBufferEnabled;              //!< Whether resequence buffer is enabled
   Ptr<TcpResequenceBuffer> m_resequenceBuffer; //!< Resequence buffer
 
+  // Batched receive
+  uint32_t m_rxBatchDepth;    //!< Nesting depth of BeginRxBatch()
+  bool m_rxBatchAckPending;   //!< An ACK was held back by the batch
+  uint8_t m_rxBatchAckFlags;  //!< Flags of the held back ACK
+  bool m_rxBatchNotify;       //!< New data is waiting for NotifyDataRecv()
+
   // Flow Bender
   bool m_flowBenderEnabled;        //!< Whether the flow bender is enabled
   Ptr<TcpFlowBender> m_flowBender; //!< Flow Bender
@@ -1061,8 +1170,13 @@ protected:
   bool m_isPauseEnabled;
   bool m_isPause;
   uint32_t m_oldPath;
+  Time m_reroutePauseTime;                 //!< Pause after a reroute
+  Time m_pauseStart;                       //!< When the current pause began
+  EventId m_pauseEvent;                    //!< Event ending the current pause
+  TracedValue<Time> m_pauseTime;           //!< Total time spent paused
+  TracedValue<uint32_t> m_pauseHeldBytes;  //!< Total bytes held back by pauses
 
-  // Resequence buffer
+  // Sequence ranges held back during a pause
   Ptr<TcpPauseBuffer> m_pauseBuffer;
 
   // Transmission Control Block
@@ -20,9 +20,10 @@
 
 #include <iostream>
 #include <algorithm>
-#include <cstring>
 
 #include "ns3/packet.h"
+#include "ns3/tag.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
@@ -34,6 +35,74 @@ NS_LOG_COMPONENT_DEFINE ("TcpTxBuffer");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpTxBuffer);
 
+/**
+ * Abort if a packet tag cannot be copied to the segments
+ * \param tid the TypeId of a tag
+ */
+static void
+CheckTagConstructor (TypeId tid)
+{
+  if (!tid.HasConstructor ())
+    {
+      NS_FATAL_ERROR ("VirtualPayload cannot copy the packet tag " << tid.GetName ()
+                      << ", which has no constructor");
+    }
+}
+
+/**
+ * \param tid the TypeId of a tag
+ * \returns a new instance of the tag
+ */
+static Tag *
+CreateTag (TypeId tid)
+{
+  CheckTagConstructor (tid);
+  Callback<ObjectBase *> constructor = tid.GetConstructor ();
+  Tag *tag = dynamic_cast<Tag *> (constructor ());
+  NS_ASSERT_MSG (tag != 0, tid.GetName () << " is not a Tag");
+  return tag;
+}
+
+/**
+ * \param a a packet
+ * \param b another packet
+ * \returns true if both packets carry the same packet tags, with the
+ *          same content
+ */
+static bool
+SamePacketTags (Ptr<const Packet> a, Ptr<const Packet> b)
+{
+  PacketTagIterator i = a->GetPacketTagIterator ();
+  PacketTagIterator j = b->GetPacketTagIterator ();
+  while (i.HasNext () && j.HasNext ())
+    {
+      if (!i.Next ().IsSameTag (j.Next ()))
+        {
+          return false;
+        }
+    }
+  return !i.HasNext () && !j.HasNext ();
+}
+
+/**
+ * Add the packet tags of a packet to another one
+ * \param from the packet carrying the tags
+ * \param to the packet to tag
+ */
+static void
+CopyPacketTags (Ptr<const Packet> from, Ptr<Packet> to)
+{
+  PacketTagIterator i = from->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      Tag *tag = CreateTag (item.GetTypeId ());
+      item.GetTag (*tag);
+      to->AddPacketTag (*tag);
+      delete tag;
+    }
+}
+
 TypeId
 TcpTxBuffer::GetTypeId (void)
 {
@@ -45,6 +114,12 @@ TcpTxBuffer::GetTypeId (void)
                      "First unacknowledged sequence number (SND.UNA)",
                      MakeTraceSourceAccessor (&TcpTxBuffer::m_firstByteSeq),
                      "ns3::SequenceNumber32TracedValueCallback")
+    .AddAttribute ("VirtualPayload",
+                   "Keep only the sequence ranges of the data, and send "
+                   "zero-filled segments (for applications sending dummy data)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpTxBuffer::m_virtualPayload),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -57,7 +132,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0),
+    m_virtualPayload (false)
 {
 }
 
@@ -111,7 +187,14 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          if (m_virtualPayload)
+            {
+              AddVirtual (p);
+            }
+          else
+            {
+              m_data.push_back (p);
+            }
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -121,6 +204,41 @@ TcpTxBuffer::Add (Ptr<Packet> p)
   return false;
 }
 
+void
+TcpTxBuffer::AddVirtual (Ptr<Packet> p)
+{
+  SequenceNumber32 tail = TailSequence () + SequenceNumber32 (p->GetSize ());
+  bool tagged = p->GetPacketTagIterator ().HasNext ();
+  if (!m_runs.empty ())
+    {
+      VirtualRun &last = m_runs.back ();
+      if (tagged ? (last.tags != 0 && SamePacketTags (last.tags, p)) : last.tags == 0)
+        { // Same tags as the previous packet: extend its run
+          last.tail = tail;
+          return;
+        }
+    }
+  if (tagged)
+    { // Fail now rather than when a segment of the run is sent
+      PacketTagIterator i = p->GetPacketTagIterator ();
+      while (i.HasNext ())
+        {
+          CheckTagConstructor (i.Next ().GetTypeId ());
+        }
+    }
+  VirtualRun run;
+  run.tail = tail;
+  run.tags = tagged ? p : 0;
+  m_runs.push_back (run);
+  NS_LOG_LOGIC ("New virtual run ending at " << tail << ", runs=" << m_runs.size ());
+}
+
+bool
+TcpTxBuffer::TailAfter (const SequenceNumber32& seq, const VirtualRun& run)
+{
+  return seq < run.tail;
+}
+
 uint32_t
 TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
 {
@@ -142,6 +260,20 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     {
       return Create<Packet> (); // Empty packet returned
     }
+  if (m_virtualPayload)
+    { // Materialize the segment, with the tags of the run holding its first byte
+      Ptr<Packet> outPacket = Create<Packet> (s);
+      std::deque<VirtualRun>::const_iterator i = m_runs.begin ();
+      if (m_runs.size () > 1)
+        {
+          i = std::upper_bound (m_runs.begin (), m_runs.end (), seq, TailAfter);
+        }
+      if (i != m_runs.end () && i->tags != 0)
+        {
+          CopyPacketTags (i->tags, outPacket);
+        }
+      return outPacket;
+    }
   if (m_data.size () == 0)
     { // No actual data, just return dummy-data packet of correct size
       return Create<Packet> (s);
@@ -217,6 +349,23 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
+  if (m_virtualPayload)
+    {
+      uint32_t discarded = std::min<uint32_t> (seq - m_firstByteSeq.Get (), m_size);
+      m_size -= discarded;
+      m_firstByteSeq += discarded;
+      while (!m_runs.empty () && m_runs.front ().tail <= m_firstByteSeq.Get ())
+        {
+          m_runs.pop_front ();
+        }
+      if (m_size == 0)
+        { // Catching the case of ACKing a FIN
+          m_firstByteSeq = seq;
+        }
+      NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " runs=" << m_runs.size ());
+      return;
+    }
+
   // Scan the buffer and discard packets
   uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
   uint32_t pktSize;
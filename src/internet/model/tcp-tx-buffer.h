@@ -22,6 +22,7 @@
 #define TCP_TX_BUFFER_H
 
 #include <list>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +37,14 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * With the VirtualPayload attribute set, the buffer does not keep the
+ * application data at all, only the sequence ranges it covers and the
+ * packet tags it was sent with.  Segments are created as zero-filled
+ * packets when they are sent, which is enough for applications such as
+ * BulkSendApplication that send dummy data, and avoids holding and
+ * fragmenting megabytes of packets per socket.  Byte tags are not kept
+ * in this mode.
  */
 class TcpTxBuffer : public Object
 {
@@ -128,6 +137,30 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
+  /**
+   * A run of virtual payload bytes, added by consecutive packets
+   * carrying the same packet tags.
+   */
+  struct VirtualRun
+  {
+    SequenceNumber32 tail;  //!< Sequence number following the last byte of the run
+    Ptr<Packet> tags;       //!< Packet holding the packet tags of the run (may be null)
+  };
+
+  /**
+   * Append the sequence range of a packet to the virtual payload.
+   * \param p the packet added by the application
+   */
+  void AddVirtual (Ptr<Packet> p);
+
+  /**
+   * Order a sequence number against the runs of virtual payload
+   * \param seq a sequence number
+   * \param run a run of virtual payload
+   * \returns true if seq is before the end of the run
+   */
+  static bool TailAfter (const SequenceNumber32& seq, const VirtualRun& run);
+
   /// container for data stored in the buffer
   typedef std::list<Ptr<Packet> >::iterator BufIterator;
 
@@ -135,6 +168,8 @@ private:
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
   std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  bool m_virtualPayload;                        //!< Keep only sequence ranges, not the data
+  std::deque<VirtualRun> m_runs;                //!< Runs of virtual payload, in sequence order
 };
 
 } // namepsace ns3
@@ -478,9 +478,9 @@ protected:
    * \brief Get the persistent event of the selected socket
    *
    * \param who socket where check the parameter
-   * \return the persistent event in the selected socket
+   * \return the persistent timer in the selected socket
    */
-  EventId GetPersistentEvent (SocketWho who);
+  const LazyTimer & GetPersistentEvent (SocketWho who);
 
   /**
    * \brief Get the persistent timeout of the selected socket
@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+#include "ns3/boolean.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief A packet tag holding a number, to follow the tags of the segments
+ */
+class TcpTxBufferTestTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  TcpTxBufferTestTag ();
+  /**
+   * \brief Constructor
+   * \param value the number
+   */
+  TcpTxBufferTestTag (uint32_t value);
+
+  uint32_t m_value; //!< the number
+};
+
+TypeId
+TcpTxBufferTestTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpTxBufferTestTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpTxBufferTestTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpTxBufferTestTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+TcpTxBufferTestTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+TcpTxBufferTestTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_value);
+}
+
+void
+TcpTxBufferTestTag::Deserialize (TagBuffer i)
+{
+  m_value = i.ReadU32 ();
+}
+
+void
+TcpTxBufferTestTag::Print (std::ostream &os) const
+{
+  os << "value=" << m_value;
+}
+
+TcpTxBufferTestTag::TcpTxBufferTestTag ()
+  : m_value (0)
+{
+}
+
+TcpTxBufferTestTag::TcpTxBufferTestTag (uint32_t value)
+  : m_value (value)
+{
+}
+
+/**
+ * \param p a packet
+ * \returns the number of the TcpTxBufferTestTag of the packet, or 0
+ */
+static uint32_t
+GetTagValue (Ptr<const Packet> p)
+{
+  TcpTxBufferTestTag tag;
+  return p->PeekPacketTag (tag) ? tag.m_value : 0;
+}
+
+/**
+ * \param virtualPayload the value of the VirtualPayload attribute
+ * \returns a buffer starting at sequence number 1, with room for 10000 bytes
+ */
+static Ptr<TcpTxBuffer>
+CreateTxBuffer (bool virtualPayload)
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetAttribute ("VirtualPayload", BooleanValue (virtualPayload));
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetMaxBufferSize (10000);
+  return txBuf;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the byte accounting of a TcpTxBuffer in VirtualPayload mode
+ */
+class TcpTxBufferVirtualSizeTestCase : public TestCase
+{
+public:
+  TcpTxBufferVirtualSizeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferVirtualSizeTestCase::TcpTxBufferVirtualSizeTestCase ()
+  : TestCase ("TcpTxBuffer VirtualPayload byte count")
+{
+}
+
+void
+TcpTxBufferVirtualSizeTestCase::DoRun (void)
+{
+  Ptr<TcpTxBuffer> txBuf = CreateTxBuffer (true);
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (500)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (1000)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (0)), true, "Add of an empty packet failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (700)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 2200, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Available (), 7800, "Wrong room left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->TailSequence (), SequenceNumber32 (2201), "Wrong tail");
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Add (Create<Packet> (7801)), false, "Add beyond the buffer size succeeded");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 2200, "A rejected packet changed the size");
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf->SizeFromSequence (SequenceNumber32 (1001)), 1200, "Wrong size from sequence");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->CopyFromSequence (1000, SequenceNumber32 (1))->GetSize (), 1000,
+                         "Wrong segment size");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->CopyFromSequence (1000, SequenceNumber32 (2001))->GetSize (), 200,
+                         "The last segment goes beyond the data");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->CopyFromSequence (1000, SequenceNumber32 (2201))->GetSize (), 0,
+                         "A segment after the data is not empty");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (801));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 1400, "Wrong size after a partial ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->HeadSequence (), SequenceNumber32 (801), "Wrong head after a partial ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Available (), 8600, "The acknowledged bytes were not freed");
+
+  txBuf->DiscardUpTo (SequenceNumber32 (2201));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Wrong size after the last ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->HeadSequence (), SequenceNumber32 (2201), "Wrong head after the last ACK");
+  // the ACK of a FIN moves the head past the data
+  txBuf->DiscardUpTo (SequenceNumber32 (2202));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->HeadSequence (), SequenceNumber32 (2202), "Wrong head after the ACK of a FIN");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the segments of a VirtualPayload buffer have the
+ *        size and the packet tags of the segments of a packet buffer
+ *
+ * The application writes runs of packets with equal tags, which the
+ * virtual buffer merges, an untagged packet and runs with different
+ * tags.  Segments are copied in order, at the holes a SACK leaves and
+ * again after partial ACKs, as retransmissions do.  Each segment
+ * carries the tags of the packet holding its first byte.
+ */
+class TcpTxBufferVirtualSegmentTestCase : public TestCase
+{
+public:
+  TcpTxBufferVirtualSegmentTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Copy a segment from both buffers and compare them
+   * \param seq the sequence number of the segment
+   * \param size the maximum size of the segment
+   * \param value the expected TcpTxBufferTestTag number, or 0 if none
+   */
+  void CheckSegment (uint32_t seq, uint32_t size, uint32_t value);
+
+  Ptr<TcpTxBuffer> m_packets;  //!< the buffer holding the packets
+  Ptr<TcpTxBuffer> m_virtual;  //!< the buffer in VirtualPayload mode
+};
+
+TcpTxBufferVirtualSegmentTestCase::TcpTxBufferVirtualSegmentTestCase ()
+  : TestCase ("TcpTxBuffer VirtualPayload segments and packet tags")
+{
+}
+
+void
+TcpTxBufferVirtualSegmentTestCase::CheckSegment (uint32_t seq, uint32_t size, uint32_t value)
+{
+  Ptr<Packet> expected = m_packets->CopyFromSequence (size, SequenceNumber32 (seq));
+  Ptr<Packet> segment = m_virtual->CopyFromSequence (size, SequenceNumber32 (seq));
+  NS_TEST_EXPECT_MSG_EQ (segment->GetSize (), expected->GetSize (),
+                         "Wrong size of the segment at " << seq);
+  NS_TEST_EXPECT_MSG_EQ (GetTagValue (expected), value,
+                         "Wrong tag in the packet buffer at " << seq);
+  NS_TEST_EXPECT_MSG_EQ (GetTagValue (segment), value,
+                         "Wrong tag of the segment at " << seq);
+}
+
+void
+TcpTxBufferVirtualSegmentTestCase::DoRun (void)
+{
+  m_packets = CreateTxBuffer (false);
+  m_virtual = CreateTxBuffer (true);
+
+  // bytes 1-1500 tagged 1, 1501-1800 untagged, 1801-2600 tagged 2,
+  // 2601-3000 tagged 1 again
+  const uint32_t sizes[] = { 600, 500, 400, 300, 500, 300, 400 };
+  const uint32_t values[] = { 1, 1, 1, 0, 2, 2, 1 };
+  for (uint32_t i = 0; i < 7; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (sizes[i]);
+      if (values[i] != 0)
+        {
+          p->AddPacketTag (TcpTxBufferTestTag (values[i]));
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_packets->Add (p->Copy ()), true, "Add failed");
+      NS_TEST_ASSERT_MSG_EQ (m_virtual->Add (p), true, "Add failed");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_virtual->Size (), m_packets->Size (), "Wrong size");
+
+  // in order, within and across the merged run of tag 1
+  CheckSegment (1, 536, 1);
+  CheckSegment (537, 536, 1);
+  CheckSegment (1073, 536, 1);
+  CheckSegment (1609, 536, 0);
+  CheckSegment (2145, 536, 2);
+  CheckSegment (2681, 536, 1);
+
+  // holes left by a SACK of 1073-2144 and 2681-3000
+  CheckSegment (1, 1072, 1);
+  CheckSegment (2145, 536, 2);
+  CheckSegment (1500, 10, 1);
+  CheckSegment (1501, 10, 0);
+  CheckSegment (2600, 1, 2);
+  CheckSegment (2601, 1, 1);
+
+  // retransmissions after partial ACKs, in the middle of runs
+  m_packets->DiscardUpTo (SequenceNumber32 (1201));
+  m_virtual->DiscardUpTo (SequenceNumber32 (1201));
+  NS_TEST_ASSERT_MSG_EQ (m_virtual->Size (), m_packets->Size (), "Wrong size after an ACK");
+  CheckSegment (1201, 536, 1);
+  CheckSegment (1737, 536, 0);
+  m_packets->DiscardUpTo (SequenceNumber32 (2001));
+  m_virtual->DiscardUpTo (SequenceNumber32 (2001));
+  CheckSegment (2001, 536, 2);
+  CheckSegment (2537, 536, 2);
+  CheckSegment (2601, 536, 1);
+  m_packets->DiscardUpTo (SequenceNumber32 (2700));
+  m_virtual->DiscardUpTo (SequenceNumber32 (2700));
+  CheckSegment (2700, 536, 1);
+  NS_TEST_ASSERT_MSG_EQ (m_virtual->Size (), 301, "Wrong size after the last partial ACK");
+
+  // a later write with the tags of the last run extends it
+  Ptr<Packet> p = Create<Packet> (200);
+  p->AddPacketTag (TcpTxBufferTestTag (1));
+  m_packets->Add (p->Copy ());
+  m_virtual->Add (p);
+  CheckSegment (2700, 536, 1);
+  CheckSegment (3001, 536, 1);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpTxBuffer TestSuite
+ */
+static class TcpTxBufferTestSuite : public TestSuite
+{
+public:
+  TcpTxBufferTestSuite ()
+    : TestSuite ("tcp-tx-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferVirtualSizeTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferVirtualSegmentTestCase, TestCase::QUICK);
+  }
+} g_tcpTxBufferTestSuite;
+
+} // namespace ns3
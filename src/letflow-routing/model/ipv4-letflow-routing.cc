@@ -8,6 +8,8 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
 
 #include <algorithm>
 
@@ -23,6 +25,7 @@ Ipv4LetFlowRouting::Ipv4LetFlowRouting ():
     m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4LetFlowRouting::~Ipv4LetFlowRouting ()
@@ -38,11 +41,32 @@ Ipv4LetFlowRouting::GetTypeId (void)
       .SetParent<Object>()
       .SetGroupName ("Internet")
       .AddConstructor<Ipv4LetFlowRouting> ()
+      .AddAttribute ("FlowletTableSize",
+                     "Number of buckets in the flowlet table",
+                     UintegerValue (4096),
+                     MakeUintegerAccessor (&Ipv4LetFlowRouting::SetFlowletTableSize,
+                                           &Ipv4LetFlowRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("FlowletCollision",
+                     "What a new flowlet does when its bucket holds another active flow",
+                     EnumValue (FLOWLET_COLLISION_REPLACE),
+                     MakeEnumAccessor (&Ipv4LetFlowRouting::SetFlowletCollisionPolicy,
+                                       &Ipv4LetFlowRouting::GetFlowletCollisionPolicy),
+                     MakeEnumChecker (FLOWLET_COLLISION_REPLACE, "Replace",
+                                      FLOWLET_COLLISION_BYPASS, "Bypass"))
   ;
 
   return tid;
 }
 
+int64_t
+Ipv4LetFlowRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 //添加一个路由表项
 void
 Ipv4LetFlowRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
@@ -96,6 +120,37 @@ Ipv4LetFlowRouting::SetFlowletTimeout (Time timeout)
   m_flowletTimeout = timeout;
 }
 
+//设置flowlet表的大小，已有的表项会被清空
+void
+Ipv4LetFlowRouting::SetFlowletTableSize (uint32_t size)
+{
+  m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4LetFlowRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+void
+Ipv4LetFlowRouting::SetFlowletCollisionPolicy (FlowletCollisionPolicy policy)
+{
+  m_flowletTable.SetCollisionPolicy (policy);
+}
+
+FlowletCollisionPolicy
+Ipv4LetFlowRouting::GetFlowletCollisionPolicy (void) const
+{
+  return m_flowletTable.GetCollisionPolicy ();
+}
+
+const FlowletTable<uint32_t> &
+Ipv4LetFlowRouting::GetFlowletTable (void) const
+{
+  return m_flowletTable;
+}
+
 //路由出去时的输出
 Ptr<Ipv4Route>
 Ipv4LetFlowRouting::RouteOutput (Ptr<Packet> packet, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
@@ -167,46 +222,42 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   uint32_t selectedPort;
 
   // If the flowlet table entry is valid, return the port
-  // 得到flowlet表中对应的条目
-  std::map<uint32_t, struct LetFlowFlowlet>::iterator flowletItr = m_flowletTable.find (flowId);
-  //如果不为空工 苛
-  if (flowletItr != m_flowletTable.end ())
+  // 得到flowlet表中对应的条目，并检测flowlet是否已经过期
+  bool flowletActive = false;
+  FlowletTable<uint32_t>::Entry *flowlet = m_flowletTable.Lookup (flowId, m_flowletTimeout, flowletActive);
+  if (flowletActive)
   {
-    //则得到对应的flowlet
-    LetFlowFlowlet flowlet = flowletItr->second;
-    //检测flowlet是否已经过期 
-    if (now - flowlet.activeTime <= m_flowletTimeout)
-    {
-      // Do not forget to update the flowlet active time
-      //如果未过期就更新时间
-      flowlet.activeTime = now;
-
-      // Return the port information used for routing routine to select the port
-      // 得到选择的端口
-      selectedPort = flowlet.port;
-      //得到路由对象
-      Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
-      //更新flowlet
-      m_flowletTable[flowId] = flowlet;
-
-      return true;
-    }
+    // Do not forget to update the flowlet active time
+    //如果未过期就更新时间
+    flowlet->activeTime = now;
+
+    // Return the port information used for routing routine to select the port
+    // 得到选择的端口
+    selectedPort = flowlet->value;
+    //得到路由对象
+    Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
+    ucb (route, packet, header);
+
+    return true;
   }
 
   // Not hit. Random Select the Port
-  selectedPort = routeEntries[rand () % routeEntries.size ()].port;
-
-  LetFlowFlowlet flowlet;
+  selectedPort = routeEntries[m_rand->GetInteger (0, routeEntries.size () - 1)].port;
 
-  flowlet.port = selectedPort;
-  flowlet.activeTime = now;
+  //占用flowlet表的桶，冲突时可能不缓存
+  if (flowlet == 0)
+  {
+    flowlet = m_flowletTable.Insert (flowId, m_flowletTimeout);
+  }
+  if (flowlet != 0)
+  {
+    flowlet->value = selectedPort;
+    flowlet->activeTime = now;
+  }
 
   Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
   ucb (route, packet, header);
 
-  m_flowletTable[flowId] = flowlet;
-
   return true;
 }
 
@@ -10,15 +10,11 @@
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
 namespace ns3 {
 
-//构建flowlet结构体
-struct LetFlowFlowlet {
-  uint32_t port;
-  Time activeTime;
-};
-
 //flowlet路由条目
 struct LetFlowRouteEntry {
   Ipv4Address network;
@@ -55,6 +51,15 @@ public:
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
   //设置flowletTimeout的时间
   void SetFlowletTimeout (Time timeout);
+  //设置flowlet表的大小（会清空表）与冲突时的处理方式
+  void SetFlowletTableSize (uint32_t size);
+  uint32_t GetFlowletTableSize (void) const;
+  void SetFlowletCollisionPolicy (FlowletCollisionPolicy policy);
+  FlowletCollisionPolicy GetFlowletCollisionPolicy (void) const;
+  //命中、未命中与冲突计数
+  const FlowletTable<uint32_t> &GetFlowletTable (void) const;
+  //指定新flowlet选端口所用随机变量的流编号
+  int64_t AssignStreams (int64_t stream);
 
 private:
   // Flowlet Timeout
@@ -65,9 +70,12 @@ private:
   // 路由器的Ipv4变量
   Ptr<Ipv4> m_ipv4;
 
-  // Flowlet Table
-  // flowlet表
-  std::map<uint32_t, LetFlowFlowlet> m_flowletTable;
+  // Picks the port of a new flowlet
+  Ptr<UniformRandomVariable> m_rand;
+
+  // Flowlet Table, the value of an entry is the port
+  // flowlet表，表项的值为端口
+  FlowletTable<uint32_t> m_flowletTable;
 
   // Route table
   // 路由表
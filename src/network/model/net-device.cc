@@ -231,4 +231,29 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SupportsTxBurst (void) const
+{
+  return false;
+}
+
+uint32_t
+NetDevice::GetTxBurstRoom (void) const
+{
+  return 0;
+}
+
+uint32_t
+NetDevice::SendBurst (const std::vector<TxBurstPacket> &burst)
+{
+  NS_LOG_FUNCTION (this << burst.size ());
+  uint32_t sent = 0;
+  while (sent < burst.size ()
+         && Send (burst[sent].packet, burst[sent].dest, burst[sent].protocolNumber))
+    {
+      sent++;
+    }
+  return sent;
+}
+
 } // namespace ns3
@@ -502,6 +502,43 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+
+  /**
+   * \brief A packet handed to SendBurst, with its destination and protocol
+   */
+  struct TxBurstPacket
+  {
+    Ptr<Packet> packet;      //!< the packet
+    Address dest;            //!< mac address of the destination
+    uint16_t protocolNumber; //!< type of payload contained in the packet
+  };
+
+  /**
+   * \return true if the device takes packets in bursts through SendBurst,
+   *         which the traffic control layer then sizes with GetTxBurstRoom
+   *
+   * The default implementation returns false.
+   */
+  virtual bool SupportsTxBurst (void) const;
+
+  /**
+   * \return how many packets SendBurst accepts right now
+   *
+   * The default implementation returns 0.
+   */
+  virtual uint32_t GetTxBurstRoom (void) const;
+
+  /**
+   * \param burst the packets sent from above down to Network Device, in order
+   *
+   * Modelled after the xmit_more hint of Linux: the device learns about all
+   * the packets of the burst before it starts transmitting them.  The
+   * default implementation calls Send for each packet, up to the first
+   * failure.
+   *
+   * \return the number of packets accepted, from the head of the burst
+   */
+  virtual uint32_t SendBurst (const std::vector<TxBurstPacket> &burst);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <string>
+#include <cstring>
 #include <cstdarg>
 
 namespace ns3 {
@@ -116,6 +117,12 @@ PacketTagIterator::Item::GetTag (Tag &tag) const
                               (uint8_t*)m_data->data
                               + PacketTagList::TagData::MAX_SIZE));
 }
+bool
+PacketTagIterator::Item::IsSameTag (const Item &o) const
+{
+  return m_data->tid == o.m_data->tid
+         && std::memcmp (m_data->data, o.m_data->data, PacketTagList::TagData::MAX_SIZE) == 0;
+}
 
 
 Ptr<Packet> 
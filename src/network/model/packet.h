@@ -148,6 +148,14 @@ public:
      * by the user does not match the type of the underlying tag.
      */
     void GetTag (Tag &tag) const;
+    /**
+     * \param o another packet tag
+     * \returns true if both tags have the same type and were serialized
+     *          to the same bytes
+     *
+     * Unlike GetTag, this does not need an instance of the tag.
+     */
+    bool IsSameTag (const Item &o) const;
 private:
     friend class PacketTagIterator;
     /**
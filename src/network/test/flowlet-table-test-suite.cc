@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/flowlet-table.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a flow keeps its path while its packets are closer
+ *        than the flowlet timeout, and that the entry goes idle after it
+ *
+ * The flow is seen every 40 to 50us with a timeout of 50us, for longer
+ * than the timeout in total, and its entry is refreshed on each packet as
+ * CONGA, LetFlow and Clove do; it then stays silent for 51us.
+ */
+class FlowletTableTimeoutTestCase : public TestCase
+{
+public:
+  FlowletTableTimeoutTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up the flow and refresh its entry, as a switch does on
+   *        each packet
+   * \param expectActive whether the entry must still be active
+   */
+  void Receive (bool expectActive);
+
+  FlowletTable<uint32_t> m_table;  //!< the table under test
+};
+
+FlowletTableTimeoutTestCase::FlowletTableTimeoutTestCase ()
+  : TestCase ("FlowletTable reuses the path within the gap and expires after the timeout"),
+    m_table (16)
+{
+}
+
+void
+FlowletTableTimeoutTestCase::Receive (bool expectActive)
+{
+  bool active;
+  FlowletTable<uint32_t>::Entry *entry = m_table.Lookup (1, MicroSeconds (50), active);
+  NS_TEST_EXPECT_MSG_NE (entry, 0, "The flow lost its entry at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (active, expectActive, "Wrong flowlet state at " << Simulator::Now ());
+  if (entry != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (entry->value, 7, "The entry lost its path");
+      entry->activeTime = Simulator::Now ();
+    }
+}
+
+void
+FlowletTableTimeoutTestCase::DoRun (void)
+{
+  bool active;
+  NS_TEST_ASSERT_MSG_EQ (m_table.Lookup (1, MicroSeconds (50), active), 0, "Found a flow never inserted");
+  FlowletTable<uint32_t>::Entry *entry = m_table.Insert (1, MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_NE (entry, 0, "Insertion into an empty bucket failed");
+  entry->value = 7;
+
+  Simulator::Schedule (MicroSeconds (40), &FlowletTableTimeoutTestCase::Receive, this, true);
+  Simulator::Schedule (MicroSeconds (80), &FlowletTableTimeoutTestCase::Receive, this, true);
+  Simulator::Schedule (MicroSeconds (130), &FlowletTableTimeoutTestCase::Receive, this, true);
+  Simulator::Schedule (MicroSeconds (181), &FlowletTableTimeoutTestCase::Receive, this, false);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetHits (), 3, "Wrong number of hits");
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetMisses (), 2, "Wrong number of misses");
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetCollisions (), 0, "Wrong number of collisions");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check how a table with a single bucket resolves collisions
+ *
+ * A second flow arriving while the first one is active evicts it or
+ * bypasses the table, depending on the collision policy.  Once the first
+ * flow has been idle for longer than the timeout, its bucket is reclaimed
+ * without a collision.
+ */
+class FlowletTableEvictionTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param policy the collision policy
+   */
+  FlowletTableEvictionTestCase (FlowletCollisionPolicy policy);
+private:
+  virtual void DoRun (void);
+  /** \brief Insert the second flow while the first one is active */
+  void Collide (void);
+  /** \brief Insert a third flow after the others went idle */
+  void Reclaim (void);
+
+  FlowletTable<uint32_t> m_table;  //!< the table under test
+  FlowletCollisionPolicy m_policy; //!< the collision policy
+};
+
+FlowletTableEvictionTestCase::FlowletTableEvictionTestCase (FlowletCollisionPolicy policy)
+  : TestCase (policy == FLOWLET_COLLISION_REPLACE ?
+              "FlowletTable evicts an active entry on collision" :
+              "FlowletTable bypasses an active entry on collision"),
+    m_table (1, policy),
+    m_policy (policy)
+{
+}
+
+void
+FlowletTableEvictionTestCase::Collide (void)
+{
+  bool active;
+  FlowletTable<uint32_t>::Entry *entry = m_table.Insert (2, MicroSeconds (50));
+  NS_TEST_EXPECT_MSG_EQ (m_table.GetCollisions (), 1, "The collision was not counted");
+  FlowletTable<uint32_t>::Entry *first = m_table.Lookup (1, MicroSeconds (50), active);
+  if (m_policy == FLOWLET_COLLISION_REPLACE)
+    {
+      NS_TEST_EXPECT_MSG_NE (entry, 0, "The new flowlet was not cached");
+      NS_TEST_EXPECT_MSG_EQ (first, 0, "The active entry was not evicted");
+      if (entry != 0)
+        {
+          entry->value = 2;
+        }
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (entry, 0, "The new flowlet was cached");
+      NS_TEST_EXPECT_MSG_NE (first, 0, "The active entry was evicted");
+      NS_TEST_EXPECT_MSG_EQ (active, true, "The active entry went idle");
+      if (first != 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (first->value, 1, "The active entry lost its path");
+        }
+    }
+}
+
+void
+FlowletTableEvictionTestCase::Reclaim (void)
+{
+  bool active;
+  FlowletTable<uint32_t>::Entry *entry = m_table.Insert (3, MicroSeconds (50));
+  NS_TEST_EXPECT_MSG_EQ (m_table.GetCollisions (), 1, "Reclaiming an idle bucket counted as a collision");
+  NS_TEST_EXPECT_MSG_NE (entry, 0, "The idle bucket was not reclaimed");
+  NS_TEST_EXPECT_MSG_EQ (m_table.Lookup (1, MicroSeconds (50), active), 0, "The first flow kept its bucket");
+  NS_TEST_EXPECT_MSG_EQ (m_table.Lookup (2, MicroSeconds (50), active), 0, "The second flow kept its bucket");
+  NS_TEST_EXPECT_MSG_NE (m_table.Lookup (3, MicroSeconds (50), active), 0, "The third flow has no bucket");
+  NS_TEST_EXPECT_MSG_EQ (active, true, "The new entry is not active");
+}
+
+void
+FlowletTableEvictionTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetSize (), 1, "Wrong table size");
+  m_table.Insert (1, MicroSeconds (50))->value = 1;
+  Simulator::Schedule (MicroSeconds (10), &FlowletTableEvictionTestCase::Collide, this);
+  Simulator::Schedule (MicroSeconds (100), &FlowletTableEvictionTestCase::Reclaim, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_table.Clear ();
+  bool active;
+  NS_TEST_ASSERT_MSG_EQ (m_table.Lookup (3, MicroSeconds (50), active), 0, "Clear kept an entry");
+  NS_TEST_ASSERT_MSG_EQ (m_table.GetCollisions (), 1, "Clear reset the counters");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief FlowletTable TestSuite
+ */
+static class FlowletTableTestSuite : public TestSuite
+{
+public:
+  FlowletTableTestSuite ()
+    : TestSuite ("flowlet-table", UNIT)
+  {
+    AddTestCase (new FlowletTableTimeoutTestCase, TestCase::QUICK);
+    AddTestCase (new FlowletTableEvictionTestCase (FLOWLET_COLLISION_REPLACE), TestCase::QUICK);
+    AddTestCase (new FlowletTableEvictionTestCase (FLOWLET_COLLISION_BYPASS), TestCase::QUICK);
+  }
+} g_flowletTableTestSuite;
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOWLET_TABLE_H
+#define FLOWLET_TABLE_H
+
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief What a FlowletTable does when a new flowlet hashes to a bucket
+ *        held by another active flow
+ */
+enum FlowletCollisionPolicy
+{
+  FLOWLET_COLLISION_REPLACE, //!< The new flowlet evicts the active entry
+  FLOWLET_COLLISION_BYPASS   //!< The new flowlet is not cached, the active entry stays
+};
+
+/**
+ * \ingroup network
+ * \brief Fixed-size hashed flowlet table, modelled after switch hardware
+ *
+ * Each bucket holds one flow, identified by its flow id, together with
+ * the time the flow was last seen and a caller-defined value (the chosen
+ * port or path).  There is no aging sweep: whether an entry is still
+ * active is decided lazily, against the caller's flowlet timeout, when it
+ * is looked up.  An idle entry is reclaimed by the next flow hashing to
+ * its bucket, and a collision with an active entry is resolved by the
+ * FlowletCollisionPolicy.  Memory is bounded by the table size and every
+ * operation is O(1).
+ *
+ * The table counts hits (lookups finding an active entry of the flow),
+ * misses (everything else) and collisions, so the effect of the table
+ * size on load balancing can be studied.
+ */
+template <typename T>
+class FlowletTable
+{
+public:
+  /**
+   * \brief One bucket of the table
+   */
+  struct Entry
+  {
+    uint32_t flowId;  //!< Flow holding the bucket
+    Time activeTime;  //!< Last time the flow was seen
+    T value;          //!< Caller-defined flowlet state
+    bool valid;       //!< Whether the bucket holds a flow at all
+  };
+
+  /**
+   * \param size number of buckets
+   * \param policy collision behavior
+   */
+  FlowletTable (uint32_t size = 4096,
+                FlowletCollisionPolicy policy = FLOWLET_COLLISION_REPLACE)
+    : m_policy (policy),
+      m_hits (0),
+      m_misses (0),
+      m_collisions (0)
+  {
+    SetSize (size);
+  }
+
+  /**
+   * \brief Resize the table, dropping every entry
+   * \param size number of buckets, at least one
+   */
+  void SetSize (uint32_t size)
+  {
+    Entry empty = Entry ();
+    empty.valid = false;
+    m_entries.assign (size > 0 ? size : 1, empty);
+  }
+
+  /**
+   * \returns the number of buckets
+   */
+  uint32_t GetSize (void) const
+  {
+    return m_entries.size ();
+  }
+
+  /**
+   * \param policy collision behavior for later insertions
+   */
+  void SetCollisionPolicy (FlowletCollisionPolicy policy)
+  {
+    m_policy = policy;
+  }
+
+  /**
+   * \returns the collision behavior
+   */
+  FlowletCollisionPolicy GetCollisionPolicy (void) const
+  {
+    return m_policy;
+  }
+
+  /**
+   * \brief Find the entry of a flow
+   *
+   * \param flowId the flow id
+   * \param timeout the flowlet timeout
+   * \param active set to whether the entry was seen within timeout
+   * \returns the entry of flowId, active or idle, or 0 if its bucket is
+   *          empty or held by another flow
+   */
+  Entry *Lookup (uint32_t flowId, Time timeout, bool &active)
+  {
+    Entry &entry = m_entries[Index (flowId)];
+    if (!entry.valid || entry.flowId != flowId)
+      {
+        active = false;
+        m_misses++;
+        return 0;
+      }
+    active = Simulator::Now () - entry.activeTime <= timeout;
+    if (active)
+      {
+        m_hits++;
+      }
+    else
+      {
+        m_misses++;
+      }
+    return &entry;
+  }
+
+  /**
+   * \brief Claim the bucket of a flow for a new flowlet
+   *
+   * The returned entry carries flowId and the current time; the caller
+   * fills in the value.  An entry of another flow is replaced when it
+   * has been idle for longer than timeout; otherwise the collision
+   * policy decides.
+   *
+   * \param flowId the flow id
+   * \param timeout the flowlet timeout
+   * \returns the entry, or 0 if the flowlet is not cached
+   */
+  Entry *Insert (uint32_t flowId, Time timeout)
+  {
+    Entry &entry = m_entries[Index (flowId)];
+    Time now = Simulator::Now ();
+    if (entry.valid && entry.flowId != flowId
+        && now - entry.activeTime <= timeout)
+      {
+        m_collisions++;
+        if (m_policy == FLOWLET_COLLISION_BYPASS)
+          {
+            return 0;
+          }
+      }
+    entry.valid = true;
+    entry.flowId = flowId;
+    entry.activeTime = now;
+    return &entry;
+  }
+
+  /**
+   * \brief Drop every entry, keeping the size and the counters
+   */
+  void Clear (void)
+  {
+    SetSize (m_entries.size ());
+  }
+
+  /**
+   * \returns the number of lookups that found an active entry of the flow
+   */
+  uint64_t GetHits (void) const
+  {
+    return m_hits;
+  }
+
+  /**
+   * \returns the number of lookups that did not
+   */
+  uint64_t GetMisses (void) const
+  {
+    return m_misses;
+  }
+
+  /**
+   * \returns the number of insertions into a bucket held by another active flow
+   */
+  uint64_t GetCollisions (void) const
+  {
+    return m_collisions;
+  }
+
+private:
+  /**
+   * \param flowId the flow id
+   * \returns the bucket of flowId
+   */
+  uint32_t Index (uint32_t flowId) const
+  {
+    // Fibonacci hashing: the high bits of the product depend on every bit
+    // of the flow id, scale them to the table size
+    uint32_t hash = flowId * 2654435761u;
+    return (static_cast<uint64_t> (hash) * m_entries.size ()) >> 32;
+  }
+
+  std::vector<Entry> m_entries;     //!< The buckets
+  FlowletCollisionPolicy m_policy;  //!< Collision behavior
+  uint64_t m_hits;                  //!< Lookups hitting an active entry
+  uint64_t m_misses;                //!< Other lookups
+  uint64_t m_collisions;            //!< Insertions colliding with an active entry
+};
+
+} // namespace ns3
+
+#endif /* FLOWLET_TABLE_H */
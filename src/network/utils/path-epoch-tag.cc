@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "path-epoch-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PathEpochTag);
+
+TypeId
+PathEpochTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PathEpochTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<PathEpochTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+PathEpochTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PathEpochTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+PathEpochTag::Serialize (TagBuffer buf) const
+{
+  buf.WriteU32 (m_epoch);
+}
+
+void
+PathEpochTag::Deserialize (TagBuffer buf)
+{
+  m_epoch = buf.ReadU32 ();
+}
+
+void
+PathEpochTag::Print (std::ostream &os) const
+{
+  os << "PathEpoch=" << m_epoch;
+}
+
+PathEpochTag::PathEpochTag ()
+  : Tag (),
+    m_epoch (0)
+{
+}
+
+PathEpochTag::PathEpochTag (uint32_t epoch)
+  : Tag (),
+    m_epoch (epoch)
+{
+}
+
+void
+PathEpochTag::SetEpoch (uint32_t epoch)
+{
+  m_epoch = epoch;
+}
+
+uint32_t
+PathEpochTag::GetEpoch (void) const
+{
+  return m_epoch;
+}
+
+} // namespace ns3
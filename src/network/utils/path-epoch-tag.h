@@ -0,0 +1,53 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PATH_EPOCH_TAG_H
+#define PATH_EPOCH_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Path epoch of the flow a packet belongs to
+ *
+ * A transport bumps the epoch of a flow when it wants the flow moved to
+ * another path (FlowBender-style rerouting).  Per-flow ECMP hashes the
+ * epoch together with the flow id, so every epoch of a flow maps to an
+ * independent path while the flow id itself stays stable for the other
+ * load balancers.  Packets of epoch 0 carry no tag.
+ */
+class PathEpochTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  PathEpochTag ();
+
+  /**
+   * \brief Constructs a PathEpochTag with the given epoch
+   * \param epoch the path epoch
+   */
+  PathEpochTag (uint32_t epoch);
+  /**
+   * \param epoch the path epoch
+   */
+  void SetEpoch (uint32_t epoch);
+  /**
+   * \returns the path epoch
+   */
+  uint32_t GetEpoch (void) const;
+private:
+  uint32_t m_epoch; //!< Path epoch
+};
+
+} // namespace ns3
+
+#endif /* PATH_EPOCH_TAG_H */
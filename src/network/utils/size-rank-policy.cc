@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "size-rank-policy.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SizeRankPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (SizeRankPolicy);
+
+TypeId
+SizeRankPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SizeRankPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SizeRankPolicy> ()
+    .AddTraceSource ("FlowSize",
+                     "The size of a flow starting under the policy",
+                     MakeTraceSourceAccessor (&SizeRankPolicy::m_flowSizeTrace),
+                     "ns3::SizeRankPolicy::FlowSizeCallback")
+  ;
+  return tid;
+}
+
+SizeRankPolicy::SizeRankPolicy ()
+  : m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SizeRankPolicy::~SizeRankPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SizeRankPolicy::SetThresholds (const std::vector<uint64_t> &thresholds)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (thresholds.size () < 255, "Size ranks must fit in the 8-bit rank of RtoPriTag");
+  m_thresholds = thresholds;
+  std::sort (m_thresholds.begin (), m_thresholds.end ());
+  m_generation++;
+}
+
+const std::vector<uint64_t> &
+SizeRankPolicy::GetThresholds (void) const
+{
+  return m_thresholds;
+}
+
+bool
+SizeRankPolicy::LoadThresholds (const std::string &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream in (filename.c_str ());
+  if (!in)
+    {
+      NS_LOG_ERROR ("Cannot open size rank threshold file " << filename);
+      return false;
+    }
+  std::vector<uint64_t> thresholds;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      std::string::size_type comment = line.find ('#');
+      if (comment != std::string::npos)
+        {
+          line.erase (comment);
+        }
+      std::istringstream fields (line);
+      double threshold;
+      while (fields >> threshold)
+        {
+          thresholds.push_back (static_cast<uint64_t> (threshold));
+        }
+    }
+  SetThresholds (thresholds);
+  return true;
+}
+
+void
+SizeRankPolicy::DeriveFromCdf (const std::vector<std::pair<double, double> > &cdf, uint32_t nRanks)
+{
+  NS_LOG_FUNCTION (this << nRanks);
+  NS_ASSERT (nRanks > 0);
+  std::vector<uint64_t> thresholds;
+  if (cdf.empty ())
+    {
+      SetThresholds (thresholds);
+      return;
+    }
+  double minCdf = cdf.front ().second;
+  double maxCdf = cdf.back ().second;
+  std::size_t j = 0;
+  for (uint32_t k = 1; k < nRanks; k++)
+    {
+      // 第k个阀值取累积概率为k/nRanks处的流大小，在CDF的两点间线性插值
+      double target = minCdf + (maxCdf - minCdf) * k / nRanks;
+      while (j + 1 < cdf.size () && cdf[j].second < target)
+        {
+          j++;
+        }
+      double value = cdf[j].first;
+      if (j > 0 && cdf[j].second > cdf[j - 1].second)
+        {
+          double fraction = (target - cdf[j - 1].second) / (cdf[j].second - cdf[j - 1].second);
+          value = cdf[j - 1].first + fraction * (cdf[j].first - cdf[j - 1].first);
+        }
+      thresholds.push_back (static_cast<uint64_t> (std::ceil (value)));
+    }
+  SetThresholds (thresholds);
+}
+
+uint32_t
+SizeRankPolicy::GetNRanks (void) const
+{
+  return m_thresholds.size () + 1;
+}
+
+uint8_t
+SizeRankPolicy::GetRank (uint64_t bytes) const
+{
+  return std::upper_bound (m_thresholds.begin (), m_thresholds.end (), bytes) - m_thresholds.begin ();
+}
+
+uint64_t
+SizeRankPolicy::GetNextThreshold (uint64_t bytes) const
+{
+  std::vector<uint64_t>::const_iterator it = std::upper_bound (m_thresholds.begin (), m_thresholds.end (), bytes);
+  if (it == m_thresholds.end ())
+    {
+      return std::numeric_limits<uint64_t>::max ();
+    }
+  return *it;
+}
+
+uint32_t
+SizeRankPolicy::GetGeneration (void) const
+{
+  return m_generation;
+}
+
+void
+SizeRankPolicy::NotifyFlowSize (uint64_t bytes)
+{
+  m_flowSizeTrace (bytes);
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SIZE_RANK_POLICY_H
+#define SIZE_RANK_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/traced-callback.h"
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Byte thresholds mapping the bytes a flow has sent to its size rank
+ *
+ * A flow that has sent fewer bytes than the first threshold has rank 0,
+ * and every threshold it reaches demotes it by one rank, as in PIAS.  The
+ * thresholds are set once at setup, from a table, a file or the flow-size
+ * CDF, and a single policy is shared by all the senders using it.  Rank
+ * lookups are a binary search, and GetNextThreshold lets a sender skip
+ * the lookup until its byte count reaches the next demotion point.
+ *
+ * The thresholds may also be replaced while the simulation runs, e.g. by
+ * a PiasThresholdOptimizer fed through NotifyFlowSize; senders notice the
+ * change through GetGeneration.
+ */
+class SizeRankPolicy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SizeRankPolicy ();
+  virtual ~SizeRankPolicy ();
+
+  /**
+   * TracedCallback signature for the flow sizes reported by the senders
+   *
+   * \param [in] bytes the flow size in bytes
+   */
+  typedef void (* FlowSizeCallback)(uint64_t bytes);
+
+  /**
+   * \brief Replace the thresholds
+   * \param thresholds the demotion thresholds in bytes, in any order
+   */
+  void SetThresholds (const std::vector<uint64_t> &thresholds);
+
+  /**
+   * \returns the demotion thresholds in bytes, ascending
+   */
+  const std::vector<uint64_t> &GetThresholds (void) const;
+
+  /**
+   * \brief Read the thresholds from a file
+   *
+   * The file holds the thresholds in bytes separated by white space; the
+   * rest of a line after '#' is ignored.
+   *
+   * \param filename the file name
+   * \returns false if the file cannot be read, keeping the thresholds
+   */
+  bool LoadThresholds (const std::string &filename);
+
+  /**
+   * \brief Split the flow-size distribution into equally likely ranks
+   *
+   * \param cdf (flow size in bytes, cumulative probability) points,
+   *        ascending
+   * \param nRanks the number of ranks, one more than the thresholds
+   */
+  void DeriveFromCdf (const std::vector<std::pair<double, double> > &cdf, uint32_t nRanks);
+
+  /**
+   * \returns the number of ranks, one more than the thresholds
+   */
+  uint32_t GetNRanks (void) const;
+
+  /**
+   * \param bytes the bytes the flow has sent
+   * \returns the number of thresholds bytes has reached
+   */
+  uint8_t GetRank (uint64_t bytes) const;
+
+  /**
+   * \param bytes the bytes the flow has sent
+   * \returns the first threshold above bytes, the rank of the flow does
+   *          not change before it; the largest uint64_t if there is none
+   */
+  uint64_t GetNextThreshold (uint64_t bytes) const;
+
+  /**
+   * \returns a counter bumped every time the thresholds change
+   */
+  uint32_t GetGeneration (void) const;
+
+  /**
+   * \brief Report the size of a flow starting under this policy
+   * \param bytes the flow size in bytes
+   */
+  void NotifyFlowSize (uint64_t bytes);
+
+private:
+  std::vector<uint64_t> m_thresholds; //!< Demotion thresholds, ascending
+  uint32_t m_generation;              //!< Bumped on every threshold change
+
+  /// Trace of the flow sizes reported by the senders
+  TracedCallback<uint64_t> m_flowSizeTrace;
+};
+
+} // namespace ns3
+
+#endif /* SIZE_RANK_POLICY_H */
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +68,14 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("TxBurst",
+                   "Take packets from the queue disc in bursts and transmit all the queued "
+                   "packets with a single completion event.  The packets still arrive one "
+                   "by one, but leave the TxQueue, and fire PhyTxBegin and PhyTxEnd, at "
+                   "the start and end of their burst.  Only for a TxQueue in packet mode.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_txBurst),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -177,7 +186,8 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_txBurst (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -224,6 +234,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_burst.clear ();
   m_queue = 0;
   m_queueInterface = 0;
   NetDevice::DoDispose ();
@@ -325,6 +336,75 @@ PointToPointNetDevice::TransmitComplete (void)
   TransmitStart (p);
 }
 
+void
+PointToPointNetDevice::TransmitBurst (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  NS_ASSERT_MSG (m_burst.empty (), "The previous burst is not complete");
+  m_txMachineState = BUSY;
+
+  // 每个包仍按自己的到达时间交给信道，整个突发只安排一个完成事件
+  Time offset = Seconds (0);
+  for (Ptr<QueueItem> item = m_queue->Dequeue (); item != 0; item = m_queue->Dequeue ())
+    {
+      Ptr<Packet> p = item->GetPacket ();
+      NS_LOG_LOGIC ("UID is " << p->GetUid () << ", starting in " << offset.GetSeconds () << "sec");
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+      m_phyTxBeginTrace (p);
+
+      Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+      if (!m_channel->TransmitStart (p, this, offset + txTime))
+        {
+          m_phyTxDropTrace (p);
+        }
+      offset += txTime + m_tInterframeGap;
+      m_burst.push_back (p);
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitBurstComplete for " << m_burst.size ()
+                << " packets in " << offset.GetSeconds () << "sec");
+  Simulator::Schedule (offset, &PointToPointNetDevice::TransmitBurstComplete, this);
+}
+
+void
+PointToPointNetDevice::TransmitBurstComplete (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
+  m_txMachineState = READY;
+
+  for (std::vector<Ptr<Packet> >::const_iterator it = m_burst.begin (); it != m_burst.end (); ++it)
+    {
+      m_phyTxEndTrace (*it);
+    }
+  m_burst.clear ();
+
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+  {
+    txq = m_queueInterface->GetTxQueue (0);
+  }
+
+  if (m_queue->IsEmpty ())
+    {
+      NS_LOG_LOGIC ("No pending packets in device queue after burst complete");
+      if (txq)
+      {
+        txq->Wake ();
+      }
+      return;
+    }
+
+  // As in TransmitComplete, do not wake the upper layers while busy
+  if (txq && txq->IsStopped ())
+    {
+      txq->Start ();
+    }
+  TransmitBurst ();
+}
+
 bool
 PointToPointNetDevice::Attach (Ptr<PointToPointChannel> ch)
 {
@@ -578,6 +658,11 @@ PointToPointNetDevice::Send (
       //
       // If the channel is ready for transition we send the packet right now
       // 
+      if (m_txMachineState == READY && m_txBurst)
+        {
+          TransmitBurst ();
+          return true;
+        }
       if (m_txMachineState == READY)
         {
           packet = m_queue->Dequeue ()->GetPacket ();
@@ -598,6 +683,70 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsTxBurst (void) const
+{
+  return m_txBurst && m_queue->GetMode () == Queue::QUEUE_MODE_PACKETS;
+}
+
+uint32_t
+PointToPointNetDevice::GetTxBurstRoom (void) const
+{
+  if (!SupportsTxBurst () || !IsLinkUp ())
+    {
+      return 0;
+    }
+  // 队列中和线路上的包合计不超过TxQueue的容量
+  uint32_t held = m_queue->GetNPackets () + m_burst.size ();
+  return held < m_queue->GetMaxPackets () ? m_queue->GetMaxPackets () - held : 0;
+}
+
+uint32_t
+PointToPointNetDevice::SendBurst (const std::vector<TxBurstPacket> &burst)
+{
+  NS_LOG_FUNCTION (this << burst.size ());
+  if (!m_txBurst)
+    {
+      return NetDevice::SendBurst (burst);
+    }
+
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+  {
+    txq = m_queueInterface->GetTxQueue (0);
+  }
+
+  NS_ASSERT_MSG (!txq || !txq->IsStopped (), "SendBurst should not be called when the device is stopped");
+
+  uint32_t sent = 0;
+  for (; sent < burst.size (); sent++)
+    {
+      Ptr<Packet> packet = burst[sent].packet;
+      if (IsLinkUp () == false)
+        {
+          m_macTxDropTrace (packet);
+          break;
+        }
+      AddHeader (packet, burst[sent].protocolNumber);
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (Create<QueueItem> (packet)))
+        {
+          m_macTxDropTrace (packet);
+          if (txq)
+          {
+            txq->Stop ();
+          }
+          break;
+        }
+    }
+
+  if (m_txMachineState == READY && !m_queue->IsEmpty ())
+    {
+      TransmitBurst ();
+    }
+  return sent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
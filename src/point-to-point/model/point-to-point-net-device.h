@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -179,6 +180,10 @@ public:
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
 
+  virtual bool SupportsTxBurst (void) const;
+  virtual uint32_t GetTxBurstRoom (void) const;
+  virtual uint32_t SendBurst (const std::vector<TxBurstPacket> &burst);
+
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
 
@@ -278,6 +283,26 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Start Sending all the Queued Packets Down the Wire.
+   *
+   * Used instead of TransmitStart when TxBurst is enabled.  Each packet is
+   * handed to the channel at once, with the serialization time of the
+   * packets ahead of it added to its own, so that it still arrives at its
+   * own time.  A single event is scheduled for the end of the burst.
+   *
+   * \see TransmitBurstComplete()
+   */
+  void TransmitBurst (void);
+
+  /**
+   * Stop Sending a Burst Down the Wire.
+   *
+   * Fires the PhyTxEnd trace of every packet of the burst and starts the
+   * next burst, if packets were queued meanwhile.
+   */
+  void TransmitBurstComplete (void);
+
   /**
    * \brief Make the link up and running
    *
@@ -461,6 +486,9 @@ private:
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 
+  bool m_txBurst;                     //!< Transmit the queued packets in bursts
+  std::vector<Ptr<Packet> > m_burst;  //!< Packets of the burst on the wire
+
   /**
    * \brief PPP to Ethernet protocol number mapping
    * \param protocol A PPP protocol number
@@ -23,6 +23,13 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/fifo-queue-disc.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -98,6 +105,242 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Connect two nodes with point to point devices at 1Gbps over a
+ *        channel with a delay of 50us, so that several packets are in
+ *        flight on each wire
+ *
+ * \param channel the channel
+ * \param devA the device of the first node
+ * \param devB the device of the second node
+ */
+static void
+ConnectPointToPointPair (Ptr<PointToPointChannel> channel,
+                         Ptr<PointToPointNetDevice> devA, Ptr<PointToPointNetDevice> devB)
+{
+  channel->SetAttribute ("Delay", TimeValue (MicroSeconds (50)));
+  Ptr<PointToPointNetDevice> devices[2] = { devA, devB };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      devices[i]->SetDataRate (DataRate ("1Gbps"));
+      devices[i]->Attach (channel);
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      devices[i]->SetQueue (CreateObject<DropTailQueue> ());
+      node->AddDevice (devices[i]);
+      devices[i]->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+    }
+}
+
+/**
+ * \brief A queue disc item with no header to add
+ */
+class PointToPointTestItem : public QueueDiscItem
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param p the packet
+   * \param addr the destination MAC address
+   * \param protocol the protocol number
+   */
+  PointToPointTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~PointToPointTestItem ();
+  virtual void AddHeader (void);
+
+private:
+  PointToPointTestItem ();
+  PointToPointTestItem (const PointToPointTestItem &);
+  PointToPointTestItem &operator = (const PointToPointTestItem &);
+};
+
+PointToPointTestItem::PointToPointTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+PointToPointTestItem::~PointToPointTestItem ()
+{
+}
+
+void
+PointToPointTestItem::AddHeader (void)
+{
+}
+
+/**
+ * \brief A point to point device which offers the queue disc one packet
+ *        more than its TxQueue has room for, so that it refuses the last
+ *        packet of every full burst
+ */
+class RefusingPointToPointNetDevice : public PointToPointNetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual uint32_t GetTxBurstRoom (void) const;
+};
+
+TypeId
+RefusingPointToPointNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RefusingPointToPointNetDevice")
+    .SetParent<PointToPointNetDevice> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<RefusingPointToPointNetDevice> ()
+  ;
+  return tid;
+}
+
+uint32_t
+RefusingPointToPointNetDevice::GetTxBurstRoom (void) const
+{
+  // no room means the device is busy with a full TxQueue, keep it at 0
+  uint32_t room = PointToPointNetDevice::GetTxBurstRoom ();
+  return room > 0 ? room + 1 : 0;
+}
+
+/**
+ * \brief Test the TxBurst attribute of PointToPointNetDevice
+ *
+ * Trains of packets of varying sizes are sent through a FifoQueueDisc
+ * with TxBurst off and on, and with TxBurst on over a device that refuses
+ * the last packet of each full burst, which the queue disc must requeue.
+ * Every packet must be received at the same time in the three cases.
+ */
+class PointToPointTxBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointTxBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send the trains over a new channel
+   *
+   * \param txBurst the value of TxBurst
+   * \param refuse whether the sending device refuses the last packet of
+   *        its bursts
+   * \param rxTimes the receive times
+   * \return the number of packets requeued by the queue disc
+   */
+  uint32_t RunTrains (bool txBurst, bool refuse, std::vector<Time> &rxTimes);
+
+  /**
+   * \brief Send a train of packets through a queue disc, as the traffic
+   *        control layer does
+   *
+   * \param qdisc the queue disc of the sending device
+   * \param n the number of packets
+   */
+  void SendTrain (Ptr<QueueDisc> qdisc, uint32_t n);
+
+  /**
+   * \brief Record the receive time of a packet
+   *
+   * \param rxTimes the receive times
+   * \param p the packet
+   */
+  static void Receive (std::vector<Time> *rxTimes, Ptr<const Packet> p);
+};
+
+PointToPointTxBurstTest::PointToPointTxBurstTest ()
+  : TestCase ("PointToPoint TxBurst keeps the receive times")
+{
+}
+
+void
+PointToPointTxBurstTest::SendTrain (Ptr<QueueDisc> qdisc, uint32_t n)
+{
+  Ptr<NetDevice> device = qdisc->GetNetDevice ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + (i * 397) % 1400);
+      qdisc->Enqueue (Create<PointToPointTestItem> (p, device->GetBroadcast (), 0x800));
+      qdisc->Run ();
+    }
+}
+
+void
+PointToPointTxBurstTest::Receive (std::vector<Time> *rxTimes, Ptr<const Packet> p)
+{
+  rxTimes->push_back (Simulator::Now ());
+}
+
+uint32_t
+PointToPointTxBurstTest::RunTrains (bool txBurst, bool refuse, std::vector<Time> &rxTimes)
+{
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  Ptr<PointToPointNetDevice> devA;
+  if (refuse)
+    {
+      devA = CreateObject<RefusingPointToPointNetDevice> ();
+    }
+  else
+    {
+      devA = CreateObject<PointToPointNetDevice> ();
+    }
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  ConnectPointToPointPair (channel, devA, devB);
+  devA->SetAttribute ("TxBurst", BooleanValue (txBurst));
+  // a short TxQueue keeps most of the packets in the queue disc
+  devA->GetQueue ()->SetAttribute ("MaxPackets", UintegerValue (4));
+  devB->TraceConnectWithoutContext ("MacRx", MakeBoundCallback (&PointToPointTxBurstTest::Receive, &rxTimes));
+
+  Ptr<QueueDisc> qdisc = CreateObjectWithAttributes<FifoQueueDisc> ("MaxSize", UintegerValue (1000));
+  qdisc->SetNetDevice (devA);
+  devA->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->SetWakeCallback (MakeCallback (&QueueDisc::Run, qdisc));
+  qdisc->Initialize ();
+
+  // the second train joins the first one while it is queued
+  Simulator::Schedule (Seconds (1.0), &PointToPointTxBurstTest::SendTrain, this, qdisc, 40);
+  Simulator::Schedule (Seconds (1.0) + MicroSeconds (120), &PointToPointTxBurstTest::SendTrain, this, qdisc, 30);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return qdisc->GetTotalRequeuedPackets ();
+}
+
+void
+PointToPointTxBurstTest::DoRun (void)
+{
+  std::vector<Time> perPacket;
+  std::vector<Time> burst;
+  std::vector<Time> refused;
+  RunTrains (false, false, perPacket);
+  uint32_t burstRequeued = RunTrains (true, false, burst);
+  uint32_t refusedRequeued = RunTrains (true, true, refused);
+
+  NS_TEST_ASSERT_MSG_EQ (perPacket.size (), 70, "Not every packet was received");
+  NS_TEST_ASSERT_MSG_EQ (burstRequeued, 0, "The device refused a packet it had room for");
+  NS_TEST_ASSERT_MSG_GT (refusedRequeued, 0, "The device never refused the last packet of a burst");
+  NS_TEST_ASSERT_MSG_EQ (burst.size (), perPacket.size (),
+                         "TxBurst changed the number of packets received");
+  NS_TEST_ASSERT_MSG_EQ (refused.size (), perPacket.size (),
+                         "A requeued packet was not received");
+  for (uint32_t i = 0; i < perPacket.size () && i < burst.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (burst[i], perPacket[i],
+                             "TxBurst changed the receive time of packet " << i);
+    }
+  for (uint32_t i = 0; i < perPacket.size () && i < refused.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (refused[i], perPacket[i],
+                             "The requeue changed the receive time of packet " << i);
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +357,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointTxBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
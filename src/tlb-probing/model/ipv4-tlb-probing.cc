@@ -63,6 +63,7 @@ Ipv4TLBProbing::Ipv4TLBProbing ()
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
@@ -79,6 +80,7 @@ Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::~Ipv4TLBProbing ()
@@ -95,8 +97,12 @@ Ipv4TLBProbing::DoDispose ()
     for ( ; itr != m_probingTimeoutMap.end (); ++itr)
     {
         (itr->second).Cancel ();
-        m_probingTimeoutMap.erase (itr);
     }
+    m_probingTimeoutMap.clear ();
+    m_probeEvent.Cancel ();
+    m_socket = 0;
+    m_node = 0;
+    Object::DoDispose ();
 }
 
 //设置源地址
@@ -120,6 +126,15 @@ Ipv4TLBProbing::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+//设置随机变量的流编号
+int64_t
+Ipv4TLBProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 //添加广播地址
 void
 Ipv4TLBProbing::AddBroadCastAddress (Ipv4Address addr)
@@ -345,7 +360,7 @@ Ipv4TLBProbing::DoProbe ()
         for (uint32_t i = 0; i < 10; i++) // Try 8 times
         {
             //随机选择一条路径进行探测
-            uint32_t path = availPaths[rand() % availPaths.size ()];
+            uint32_t path = availPaths[m_rand->GetInteger (0, availPaths.size () - 1)];
             if (pathSet.find (path) != pathSet.end ())
             {
                 continue;
@@ -8,6 +8,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
 #include <map>
@@ -36,6 +37,9 @@ public:
 
     void SetNode (Ptr<Node> node);
 
+    //指定随机选择探测路径所用的流编号，返回使用的流数量
+    int64_t AssignStreams (int64_t stream);
+
     void AddBroadCastAddress (Ipv4Address addr);
 
     void Init (void);
@@ -90,6 +94,8 @@ private:
     std::vector<Ipv4Address> m_broadcastAddresses;
     //节点
     Ptr<Node> m_node;
+    //在可用路径中随机选择探测路径
+    Ptr<UniformRandomVariable> m_rand;
 
 };
 
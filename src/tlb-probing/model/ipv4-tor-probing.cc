@@ -0,0 +1,479 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ipv4-tor-probing.h"
+
+#include "ns3/ipv4-tlb-probing-tag.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/socket.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-clove.h"
+#include "ns3/ipv4-xpath-tag.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4TorProbing");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4TorProbing);
+
+const uint8_t Ipv4TorProbing::PROT_NUMBER = 253;
+
+//返回TypeId
+TypeId
+Ipv4TorProbing::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::Ipv4TorProbing")
+        .SetParent<IpL4Protocol> ()
+        .SetGroupName ("TLB")
+        .AddConstructor<Ipv4TorProbing> ()
+        .AddAttribute ("ProbeInterval", "Probing Interval",
+                      TimeValue (MicroSeconds (100)),
+                      MakeTimeAccessor (&Ipv4TorProbing::m_probeInterval),
+                      MakeTimeChecker ())
+        .AddAttribute ("ProbeTimeout", "Time after which an unanswered probe times out",
+                      TimeValue (Seconds (0.1)),
+                      MakeTimeAccessor (&Ipv4TorProbing::m_probeTimeout),
+                      MakeTimeChecker ())
+    ;
+
+    return tid;
+}
+
+//初始化，并准备好探测包与回复包的模板
+Ipv4TorProbing::Ipv4TorProbing ()
+    : m_node (),
+      m_ipv4 (),
+      m_probeTimeout (Seconds (0.1)),
+      m_probeInterval (MicroSeconds (100)),
+      m_id (0)
+{
+    NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
+
+    m_template = Create<Packet> (0);
+
+    m_probeHeader.SetSource (Ipv4Address ("127.0.0.1"));
+    m_probeHeader.SetProtocol (PROT_NUMBER);
+    m_probeHeader.SetPayloadSize (0);
+    m_probeHeader.SetEcn (Ipv4Header::ECN_ECT1);
+    m_probeHeader.SetTtl (255);
+
+    m_replyHeader.SetProtocol (PROT_NUMBER);
+    m_replyHeader.SetPayloadSize (0);
+    m_replyHeader.SetTtl (255);
+}
+
+Ipv4TorProbing::~Ipv4TorProbing ()
+{
+    NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4TorProbing::DoDispose (void)
+{
+    NS_LOG_FUNCTION (this);
+    m_probeEvent.Cancel ();
+    m_timeoutEvent.Cancel ();
+    m_outstanding.clear ();
+    m_dests.clear ();
+    m_tlbConsumers.clear ();
+    m_cloveConsumers.clear ();
+    m_downTarget.Nullify ();
+    m_downTarget6.Nullify ();
+    m_node = 0;
+    m_ipv4 = 0;
+    IpL4Protocol::DoDispose ();
+}
+
+//聚合到节点上后，向Ipv4注册为上层协议
+void
+Ipv4TorProbing::NotifyNewAggregate (void)
+{
+    NS_LOG_FUNCTION (this);
+    if (m_node == 0)
+    {
+        m_node = this->GetObject<Node> ();
+    }
+    if (m_ipv4 == 0)
+    {
+        Ptr<Ipv4> ipv4 = this->GetObject<Ipv4> ();
+        if (ipv4 != 0)
+        {
+            m_ipv4 = ipv4;
+            ipv4->Insert (this);
+        }
+    }
+    IpL4Protocol::NotifyNewAggregate ();
+}
+
+//设置源地址
+void
+Ipv4TorProbing::SetSourceAddress (Ipv4Address address)
+{
+    m_probeHeader.SetSource (address);
+}
+
+//添加探测路径，同一个被探测地址的路径归到同一个目的ToR
+void
+Ipv4TorProbing::AddPath (Ipv4Address probeAddress, uint32_t path)
+{
+    std::vector<TorProbingDest>::iterator itr = m_dests.begin ();
+    for ( ; itr != m_dests.end (); ++itr)
+    {
+        if (itr->probeAddress == probeAddress)
+        {
+            break;
+        }
+    }
+    if (itr == m_dests.end ())
+    {
+        TorProbingDest dest;
+        dest.probeAddress = probeAddress;
+        dest.hasBestPath = false;
+        dest.bestPath = 0;
+        dest.bestPathRtt = Seconds (666);
+        m_dests.push_back (dest);
+        itr = m_dests.end () - 1;
+    }
+    itr->paths.push_back (path);
+}
+
+void
+Ipv4TorProbing::AddConsumer (Ptr<Ipv4TLB> tlb)
+{
+    m_tlbConsumers.push_back (tlb);
+}
+
+void
+Ipv4TorProbing::AddConsumer (Ptr<Ipv4Clove> clove)
+{
+    m_cloveConsumers.push_back (clove);
+}
+
+//设置随机变量的流编号
+int64_t
+Ipv4TorProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
+//调用开始探测事件
+void
+Ipv4TorProbing::StartProbe (void)
+{
+    m_probeEvent = Simulator::ScheduleNow (&Ipv4TorProbing::DoProbe, this);
+}
+
+//停止探测
+void
+Ipv4TorProbing::StopProbe (Time stopTime)
+{
+    Simulator::Schedule (stopTime, &Ipv4TorProbing::DoStop, this);
+}
+
+void
+Ipv4TorProbing::DoStop (void)
+{
+    //取消固定周期探测
+    m_probeEvent.Cancel ();
+}
+
+//每个目的ToR探测上一周期最好的路径和一条随机路径，没有最好路径时探测两条随机路径
+void
+Ipv4TorProbing::DoProbe (void)
+{
+    for (uint32_t i = 0; i < m_dests.size (); i++)
+    {
+        TorProbingDest &dest = m_dests[i];
+        uint32_t probingCount = 2;
+        uint32_t probed[2];
+        uint32_t probedCount = 0;
+
+        if (dest.hasBestPath && dest.bestPath != 0)
+        {
+            Ipv4TorProbing::SendProbe (i, dest.bestPath);
+            probed[probedCount++] = dest.bestPath;
+        }
+        if (!dest.paths.empty ())
+        {
+            for (uint32_t j = 0; j < 10 && probedCount < probingCount; j++) // Try 10 times
+            {
+                //随机选择一条路径进行探测
+                uint32_t path = dest.paths[m_rand->GetInteger (0, dest.paths.size () - 1)];
+                if (std::find (probed, probed + probedCount, path) != probed + probedCount)
+                {
+                    continue;
+                }
+                Ipv4TorProbing::SendProbe (i, path);
+                probed[probedCount++] = path;
+            }
+        }
+        dest.hasBestPath = false;
+        dest.bestPathRtt = Seconds (666);
+    }
+    //固定周期进行探测
+    m_probeEvent = Simulator::Schedule (m_probeInterval, &Ipv4TorProbing::DoProbe, this);
+}
+
+//复制模板发出探测包，不经过socket
+void
+Ipv4TorProbing::SendProbe (uint32_t dest, uint32_t path)
+{
+    TorProbingDest &torDest = m_dests[dest];
+
+    Ptr<Packet> packet = m_template->Copy ();
+    Ipv4Header header = m_probeHeader;
+    header.SetDestination (torDest.probeAddress);
+
+    // XPath tag
+    // 添加XPath标签
+    Ipv4XPathTag ipv4XPathTag;
+    ipv4XPathTag.SetPathId (path);
+    packet->AddPacketTag (ipv4XPathTag);
+
+    // Probing tag
+    // 添加探测Tag
+    Ipv4TLBProbingTag probingTag;
+    probingTag.SetId (m_id);
+    probingTag.SetPath (path);
+    probingTag.SetProbeAddress (torDest.probeAddress);
+    probingTag.SetIsReply (0);
+    probingTag.SetTime (Simulator::Now ());
+    probingTag.SetIsCE (0);
+    probingTag.SetIsBroadcast (0);
+    packet->AddPacketTag (probingTag);
+
+    //服务器只有一条上行链路，到同一地址的路由只需查找一次
+    if (torDest.route == 0)
+    {
+        Socket::SocketErrno errno_ = Socket::ERROR_NOTERROR;
+        int32_t interface = m_ipv4->GetInterfaceForAddress (header.GetSource ());
+        Ptr<NetDevice> oif = 0;
+        if (interface >= 0)
+        {
+            oif = m_ipv4->GetNetDevice (interface);
+        }
+        torDest.route = m_ipv4->GetRoutingProtocol ()->RouteOutput (packet, header, oif, errno_);
+        if (torDest.route == 0)
+        {
+            NS_LOG_DEBUG ("No route to probe address " << torDest.probeAddress);
+            return;
+        }
+    }
+
+    //id只有16位，未回复的探测包不能超过65536个
+    while (m_outstanding.size () > 0xffff)
+    {
+        Ipv4TorProbing::TimeoutOldest ();
+    }
+
+    TorProbingOutstanding outstanding;
+    outstanding.id = m_id++;
+    outstanding.dest = dest;
+    outstanding.path = path;
+    outstanding.deadline = Simulator::Now () + m_probeTimeout;
+    outstanding.answered = false;
+    m_outstanding.push_back (outstanding);
+    if (!m_timeoutEvent.IsRunning ())
+    {
+        m_timeoutEvent = Simulator::Schedule (m_outstanding.front ().deadline - Simulator::Now (),
+                                              &Ipv4TorProbing::ExpireProbes, this);
+    }
+
+    m_ipv4->SendWithHeader (packet, header, torDest.route);
+
+    //调用Ipv4TLB中的ProbeSend来更新路径信息
+    for (uint32_t i = 0; i < m_tlbConsumers.size (); i++)
+    {
+        m_tlbConsumers[i]->ProbeSend (torDest.probeAddress, path);
+    }
+}
+
+//收到探测包就回复，收到回复就分发给消费者
+enum IpL4Protocol::RxStatus
+Ipv4TorProbing::Receive (Ptr<Packet> p, Ipv4Header const &header,
+                         Ptr<Ipv4Interface> incomingInterface)
+{
+    NS_LOG_FUNCTION (this << p << header);
+    Ipv4TLBProbingTag probingTag;
+    if (!p->RemovePacketTag (probingTag))
+    {
+        return IpL4Protocol::RX_OK;
+    }
+
+    if (probingTag.GetIsReply () == 0)
+    {
+        Ipv4TorProbing::SendReply (header, probingTag, incomingInterface);
+    }
+    else
+    {
+        Ipv4TorProbing::ReceiveReply (probingTag, p->GetSize () + header.GetSerializedSize ());
+    }
+    return IpL4Protocol::RX_OK;
+}
+
+enum IpL4Protocol::RxStatus
+Ipv4TorProbing::Receive (Ptr<Packet> p, Ipv6Header const &header,
+                         Ptr<Ipv6Interface> incomingInterface)
+{
+    return IpL4Protocol::RX_ENDPOINT_UNREACH;
+}
+
+//回复探测包，带回单程时延和是否被标记ECN
+void
+Ipv4TorProbing::SendReply (Ipv4Header const &header, const Ipv4TLBProbingTag &probingTag,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+    Ptr<Packet> packet = m_template->Copy ();
+    Ipv4Header replyHeader = m_replyHeader;
+    replyHeader.SetSource (header.GetDestination ());
+    replyHeader.SetDestination (header.GetSource ());
+
+    //创建回复用的ProbingTag,并将回复设置为1,设置一半的路径时间
+    Ipv4TLBProbingTag replyProbingTag;
+    replyProbingTag.SetId (probingTag.GetId ());
+    replyProbingTag.SetPath (probingTag.GetPath ());
+    replyProbingTag.SetProbeAddress (probingTag.GetProbeAddres ());
+    replyProbingTag.SetIsReply (1);
+    replyProbingTag.SetIsBroadcast (0);
+    replyProbingTag.SetTime (Simulator::Now () - probingTag.GetTime ());
+    replyProbingTag.SetIsCE (header.GetEcn () == Ipv4Header::ECN_CE ? 1 : 0);
+    packet->AddPacketTag (replyProbingTag);
+
+    Socket::SocketErrno errno_ = Socket::ERROR_NOTERROR;
+    Ptr<Ipv4Route> route = m_ipv4->GetRoutingProtocol ()->RouteOutput (packet, replyHeader,
+                                                                       incomingInterface->GetDevice (),
+                                                                       errno_);
+    if (route == 0)
+    {
+        NS_LOG_DEBUG ("No route to reply to " << header.GetSource ());
+        return;
+    }
+    m_ipv4->SendWithHeader (packet, replyHeader, route);
+}
+
+//回复在超时之前到达时，更新最好路径并分发给本机架的所有消费者
+void
+Ipv4TorProbing::ReceiveReply (const Ipv4TLBProbingTag &probingTag, uint32_t size)
+{
+    if (m_outstanding.empty ())
+    {
+        return;
+    }
+    uint16_t offset = probingTag.GetId () - m_outstanding.front ().id;
+    if (offset >= m_outstanding.size () || m_outstanding[offset].answered)
+    {
+        // The reply has incurred timeout
+        return;
+    }
+    TorProbingOutstanding &outstanding = m_outstanding[offset];
+    outstanding.answered = true;
+
+    TorProbingDest &dest = m_dests[outstanding.dest];
+    uint32_t path = outstanding.path;
+    Time oneWayRtt = probingTag.GetTime ();
+    bool isCE = probingTag.GetIsCE () == 1;
+
+    if (oneWayRtt < dest.bestPathRtt)
+    {
+        dest.hasBestPath = true;
+        dest.bestPath = path;
+        dest.bestPathRtt = oneWayRtt;
+    }
+
+    for (uint32_t i = 0; i < m_tlbConsumers.size (); i++)
+    {
+        m_tlbConsumers[i]->ProbeRecv (path, dest.probeAddress, size, isCE, oneWayRtt);
+    }
+    for (uint32_t i = 0; i < m_cloveConsumers.size (); i++)
+    {
+        m_cloveConsumers[i]->FlowRecv (path, dest.probeAddress, isCE);
+    }
+
+    Ipv4TorProbing::PopAnswered ();
+}
+
+//超时所有到期的探测包，计时器改为等待下一个最早到期的探测包
+void
+Ipv4TorProbing::ExpireProbes (void)
+{
+    Time now = Simulator::Now ();
+    while (!m_outstanding.empty () && m_outstanding.front ().deadline <= now)
+    {
+        Ipv4TorProbing::TimeoutOldest ();
+    }
+    Ipv4TorProbing::PopAnswered ();
+    if (!m_outstanding.empty ())
+    {
+        m_timeoutEvent = Simulator::Schedule (m_outstanding.front ().deadline - now,
+                                              &Ipv4TorProbing::ExpireProbes, this);
+    }
+}
+
+//移除最早的探测包，还没有回复就通知消费者超时
+void
+Ipv4TorProbing::TimeoutOldest (void)
+{
+    TorProbingOutstanding outstanding = m_outstanding.front ();
+    m_outstanding.pop_front ();
+    if (outstanding.answered)
+    {
+        return;
+    }
+    const TorProbingDest &dest = m_dests[outstanding.dest];
+    for (uint32_t i = 0; i < m_tlbConsumers.size (); i++)
+    {
+        m_tlbConsumers[i]->ProbeTimeout (outstanding.path, dest.probeAddress);
+    }
+}
+
+void
+Ipv4TorProbing::PopAnswered (void)
+{
+    while (!m_outstanding.empty () && m_outstanding.front ().answered)
+    {
+        m_outstanding.pop_front ();
+    }
+}
+
+int
+Ipv4TorProbing::GetProtocolNumber (void) const
+{
+    return PROT_NUMBER;
+}
+
+void
+Ipv4TorProbing::SetDownTarget (IpL4Protocol::DownTargetCallback cb)
+{
+    m_downTarget = cb;
+}
+
+void
+Ipv4TorProbing::SetDownTarget6 (IpL4Protocol::DownTargetCallback6 cb)
+{
+    m_downTarget6 = cb;
+}
+
+IpL4Protocol::DownTargetCallback
+Ipv4TorProbing::GetDownTarget (void) const
+{
+    return m_downTarget;
+}
+
+IpL4Protocol::DownTargetCallback6
+Ipv4TorProbing::GetDownTarget6 (void) const
+{
+    return m_downTarget6;
+}
+
+}
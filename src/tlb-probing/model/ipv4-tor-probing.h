@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_TOR_PROBING_H
+#define IPV4_TOR_PROBING_H
+
+#include "ns3/ip-l4-protocol.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+#include <deque>
+
+namespace ns3 {
+
+class Node;
+class Ipv4;
+class Ipv4TLB;
+class Ipv4Clove;
+class Ipv4TLBProbingTag;
+
+/**
+ * \brief ToR-level path probing shared by every server under a leaf
+ *
+ * Aggregated to a server node, the object registers itself as an IP
+ * protocol and answers the probes it receives.  On one server per leaf it
+ * also acts as the probing agent of the rack: every probe interval it
+ * probes each destination ToR over the best path of the last interval and
+ * random other paths, and hands each probe result, timeout and send event
+ * to all the Ipv4TLB and Ipv4Clove consumers of the rack.  Probing traffic
+ * thus grows with the number of ToRs rather than with the number of
+ * servers.
+ *
+ * Probes are copies of a preallocated template packet and header sent
+ * straight to Ipv4::SendWithHeader, with no socket in between, and the
+ * outstanding probes of the agent time out from a single timer.
+ */
+class Ipv4TorProbing : public IpL4Protocol
+{
+public:
+    static const uint8_t PROT_NUMBER; //!< protocol number (253, experimental)
+
+    static TypeId GetTypeId (void);
+
+    Ipv4TorProbing ();
+    virtual ~Ipv4TorProbing ();
+
+    //设置代理发出探测包的源地址
+    void SetSourceAddress (Ipv4Address address);
+
+    //添加一个要探测的路径，probeAddress为目的ToR下被探测的服务器
+    void AddPath (Ipv4Address probeAddress, uint32_t path);
+
+    //添加接收探测结果的本机架消费者
+    void AddConsumer (Ptr<Ipv4TLB> tlb);
+    void AddConsumer (Ptr<Ipv4Clove> clove);
+
+    //指定随机选择探测路径所用的流编号，返回使用的流数量
+    int64_t AssignStreams (int64_t stream);
+
+    void StartProbe (void);
+
+    void StopProbe (Time stopTime);
+
+    // From IpL4Protocol
+    virtual int GetProtocolNumber (void) const;
+    virtual enum IpL4Protocol::RxStatus Receive (Ptr<Packet> p,
+                                                 Ipv4Header const &header,
+                                                 Ptr<Ipv4Interface> incomingInterface);
+    virtual enum IpL4Protocol::RxStatus Receive (Ptr<Packet> p,
+                                                 Ipv6Header const &header,
+                                                 Ptr<Ipv6Interface> incomingInterface);
+    virtual void SetDownTarget (IpL4Protocol::DownTargetCallback cb);
+    virtual void SetDownTarget6 (IpL4Protocol::DownTargetCallback6 cb);
+    virtual IpL4Protocol::DownTargetCallback GetDownTarget (void) const;
+    virtual IpL4Protocol::DownTargetCallback6 GetDownTarget6 (void) const;
+
+protected:
+    virtual void DoDispose (void);
+    virtual void NotifyNewAggregate (void);
+
+private:
+    //一个被探测的目的ToR
+    struct TorProbingDest
+    {
+        Ipv4Address probeAddress;   // 目的ToR下被探测的服务器
+        std::vector<uint32_t> paths;
+        Ptr<Ipv4Route> route;       // 到probeAddress的路由，第一次探测时查找
+        bool hasBestPath;
+        uint32_t bestPath;
+        Time bestPathRtt;
+    };
+
+    //一个尚未回复的探测包
+    struct TorProbingOutstanding
+    {
+        uint16_t id;
+        uint32_t dest;
+        uint32_t path;
+        Time deadline;
+        bool answered;
+    };
+
+    void DoProbe (void);
+    void DoStop (void);
+
+    void SendProbe (uint32_t dest, uint32_t path);
+
+    void SendReply (Ipv4Header const &header, const Ipv4TLBProbingTag &probingTag,
+                    Ptr<Ipv4Interface> incomingInterface);
+
+    void ReceiveReply (const Ipv4TLBProbingTag &probingTag, uint32_t size);
+
+    //超时最早的探测包，并重新设置计时器
+    void ExpireProbes (void);
+    void TimeoutOldest (void);
+    void PopAnswered (void);
+
+    Ptr<Node> m_node;
+    Ptr<Ipv4> m_ipv4;
+    IpL4Protocol::DownTargetCallback m_downTarget;
+    IpL4Protocol::DownTargetCallback6 m_downTarget6;
+
+    //探测timeout的时间和探测间隔
+    Time m_probeTimeout;
+    Time m_probeInterval;
+
+    //探测包与回复包的模板
+    Ptr<Packet> m_template;
+    Ipv4Header m_probeHeader;
+    Ipv4Header m_replyHeader;
+
+    std::vector<TorProbingDest> m_dests;
+
+    //按发送顺序排列的未回复探测包，id连续，超时时间单调
+    std::deque<TorProbingOutstanding> m_outstanding;
+    uint16_t m_id;
+    EventId m_timeoutEvent;
+
+    std::vector<Ptr<Ipv4TLB> > m_tlbConsumers;
+    std::vector<Ptr<Ipv4Clove> > m_cloveConsumers;
+
+    EventId m_probeEvent;
+    //在可用路径中随机选择探测路径
+    Ptr<UniformRandomVariable> m_rand;
+};
+
+}
+
+#endif /* IPV4_TOR_PROBING_H */
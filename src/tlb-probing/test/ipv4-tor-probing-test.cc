@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-tor-probing.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup tlb-probing
+ * \ingroup tests
+ *
+ * \brief Check that the probes of a rack agent reach the path table of
+ *        every consumer, and that the table ages once probing stops
+ *
+ * The agent A and a second server A2 sit under ToR 0 behind a router.
+ * ToR 1 holds B, which answers probes, over paths 1 and 2; ToR 2 holds C,
+ * which does not, over path 3.  The agent probes for 1.5ms.  The paths
+ * are read through the SelectPath trace of each Ipv4TLB, which reports
+ * all the paths to the destination ToR whenever a new flow is placed.
+ */
+class Ipv4TorProbingTestCase : public TestCase
+{
+public:
+  Ipv4TorProbingTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Place a new flow and return the paths reported for its ToR
+   * \param tlb the consumer to query
+   * \param daddr the destination of the flow
+   * \return the parallel paths to the destination ToR
+   */
+  std::vector<PathInfo> GetPaths (Ptr<Ipv4TLB> tlb, Ipv4Address daddr);
+  /**
+   * \brief SelectPath trace sink
+   * \param flowId the flow id
+   * \param fromTor the source ToR
+   * \param toTor the destination ToR
+   * \param path the selected path
+   * \param isRandom whether the path was picked at random
+   * \param info the selected path
+   * \param parallelPaths all the paths to the destination ToR
+   */
+  void SelectPath (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                   bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
+  /** \brief Check the paths while the agent is probing */
+  void CheckProbed (void);
+  /** \brief Check the paths long after the agent stopped */
+  void CheckAged (void);
+
+  Ptr<Ipv4TLB> m_tlbs[2];           //!< the consumers of ToR 0
+  Ipv4Address m_source;             //!< the address of the agent
+  Ipv4Address m_answering;          //!< the address of B
+  Ipv4Address m_silent;             //!< the address of C
+  uint32_t m_flowId;                //!< the next flow to place
+  std::vector<PathInfo> m_paths;    //!< the paths of the last trace
+};
+
+Ipv4TorProbingTestCase::Ipv4TorProbingTestCase ()
+  : TestCase ("Ipv4TorProbing updates the path table of every consumer, which ages after probing stops"),
+    m_flowId (1)
+{
+}
+
+void
+Ipv4TorProbingTestCase::SelectPath (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                                    bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths)
+{
+  m_paths = parallelPaths;
+}
+
+std::vector<PathInfo>
+Ipv4TorProbingTestCase::GetPaths (Ptr<Ipv4TLB> tlb, Ipv4Address daddr)
+{
+  m_paths.clear ();
+  tlb->TraceConnectWithoutContext ("SelectPath", MakeCallback (&Ipv4TorProbingTestCase::SelectPath, this));
+  tlb->GetPath (m_flowId++, m_source, daddr);
+  tlb->TraceDisconnectWithoutContext ("SelectPath", MakeCallback (&Ipv4TorProbingTestCase::SelectPath, this));
+  return m_paths;
+}
+
+void
+Ipv4TorProbingTestCase::CheckProbed (void)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      std::vector<PathInfo> paths = GetPaths (m_tlbs[i], m_answering);
+      NS_TEST_EXPECT_MSG_EQ (paths.size (), 2, "Consumer " << i << " has the wrong paths to ToR 1");
+      for (uint32_t j = 0; j < paths.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_LT (paths[j].rttMin, MicroSeconds (60),
+                                 "Consumer " << i << " has no RTT sample on path " << paths[j].pathId);
+          NS_TEST_EXPECT_MSG_EQ (paths[j].pathType, GoodPath,
+                                 "Consumer " << i << " does not see path " << paths[j].pathId << " as good");
+        }
+
+      paths = GetPaths (m_tlbs[i], m_silent);
+      NS_TEST_EXPECT_MSG_EQ (paths.size (), 1, "Consumer " << i << " has the wrong paths to ToR 2");
+      if (paths.size () == 1)
+        {
+          NS_TEST_EXPECT_MSG_NE (paths[0].pathType, GoodPath,
+                                 "Consumer " << i << " sees an unanswered path as good");
+        }
+    }
+}
+
+void
+Ipv4TorProbingTestCase::CheckAged (void)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      std::vector<PathInfo> paths = GetPaths (m_tlbs[i], m_answering);
+      NS_TEST_EXPECT_MSG_EQ (paths.size (), 2, "Consumer " << i << " has the wrong paths to ToR 1");
+      for (uint32_t j = 0; j < paths.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (paths[j].rttMin, Seconds (666),
+                                 "Consumer " << i << " kept a stale RTT on path " << paths[j].pathId);
+          NS_TEST_EXPECT_MSG_EQ (paths[j].size, 1,
+                                 "Consumer " << i << " kept a stale size on path " << paths[j].pathId);
+          NS_TEST_EXPECT_MSG_NE (paths[j].pathType, GoodPath,
+                                 "Consumer " << i << " still sees stale path " << paths[j].pathId << " as good");
+        }
+    }
+}
+
+void
+Ipv4TorProbingTestCase::DoRun (void)
+{
+  // A, A2, B, C and the router
+  NodeContainer nodes;
+  nodes.Create (5);
+  Ptr<Node> router = nodes.Get (4);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  devHelper.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+
+  Ipv4AddressHelper ipv4;
+  Ipv4Address addresses[4];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NetDeviceContainer devices = devHelper.Install (NodeContainer (nodes.Get (i), router));
+      std::ostringstream network;
+      network << "10.1." << i + 1 << ".0";
+      ipv4.SetBase (network.str ().c_str (), "255.255.255.0");
+      addresses[i] = ipv4.Assign (devices).GetAddress (0);
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  m_source = addresses[0];
+  m_answering = addresses[2];
+  m_silent = addresses[3];
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      m_tlbs[i] = CreateObject<Ipv4TLB> ();
+      m_tlbs[i]->SetNode (nodes.Get (i));
+      m_tlbs[i]->AddAddressWithTor (addresses[0], 0);
+      m_tlbs[i]->AddAddressWithTor (addresses[1], 0);
+      m_tlbs[i]->AddAddressWithTor (m_answering, 1);
+      m_tlbs[i]->AddAddressWithTor (m_silent, 2);
+      m_tlbs[i]->AddAvailPath (1, 1);
+      m_tlbs[i]->AddAvailPath (1, 2);
+      m_tlbs[i]->AddAvailPath (2, 3);
+      // The first flow starts the path aging
+      m_tlbs[i]->GetPath (m_flowId++, m_source, m_answering);
+    }
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      nodes.Get (i)->AggregateObject (CreateObject<Ipv4TorProbing> ());
+    }
+  Ptr<Ipv4TorProbing> agent = nodes.Get (0)->GetObject<Ipv4TorProbing> ();
+  agent->SetAttribute ("ProbeTimeout", TimeValue (MicroSeconds (300)));
+  agent->SetSourceAddress (m_source);
+  agent->AddConsumer (m_tlbs[0]);
+  agent->AddConsumer (m_tlbs[1]);
+  agent->AddPath (m_answering, 1);
+  agent->AddPath (m_answering, 2);
+  agent->AddPath (m_silent, 3);
+  agent->StartProbe ();
+  agent->StopProbe (MicroSeconds (1500));
+
+  Simulator::Schedule (MicroSeconds (1050), &Ipv4TorProbingTestCase::CheckProbed, this);
+  Simulator::Schedule (MicroSeconds (2500), &Ipv4TorProbingTestCase::CheckAged, this);
+  Simulator::Stop (MicroSeconds (3000));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_tlbs[0] = 0;
+  m_tlbs[1] = 0;
+}
+
+/**
+ * \ingroup tlb-probing
+ * \ingroup tests
+ *
+ * \brief Ipv4TorProbing TestSuite
+ */
+static class Ipv4TorProbingTestSuite : public TestSuite
+{
+public:
+  Ipv4TorProbingTestSuite ()
+    : TestSuite ("ipv4-tor-probing", UNIT)
+  {
+    AddTestCase (new Ipv4TorProbingTestCase, TestCase::QUICK);
+  }
+} g_ipv4TorProbingTestSuite;
@@ -7,6 +7,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 
 #include <cstdio>
 #include <algorithm>
@@ -20,6 +21,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4TLB");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4TLB);
 
+const uint32_t TLBPathSet::NONE;
+
 //初始化
 Ipv4TLB::Ipv4TLB ():
     m_runMode (0),
@@ -68,6 +71,7 @@ Ipv4TLB::Ipv4TLB ():
     m_ecnBeta(0.0)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
@@ -112,9 +116,19 @@ Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
     */
     m_flowletTimeout (other.m_flowletTimeout),
     m_rttAlpha (other.m_rttAlpha),
-    m_ecnBeta (other.m_ecnBeta)
+    m_ecnBeta (other.m_ecnBeta),
+    m_acklets (other.m_acklets.GetSize (), other.m_acklets.GetCollisionPolicy ())
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
+}
+
+TLBDestTorInfo::TLBDestTorInfo ():
+    agingDeadline (Time::Max ()),
+    goodValid (false),
+    goodMinCounter (0),
+    goodMinRttLevel (5)
+{
 }
 
 //返回TypeId
@@ -177,6 +191,18 @@ Ipv4TLB::GetTypeId (void)
                       TimeValue (MicroSeconds (300)),
                       MakeTimeAccessor (&Ipv4TLB::m_ackletTimeout),
                       MakeTimeChecker ())
+        .AddAttribute ("AckletTableSize", "Number of buckets in the acklet table",
+                      UintegerValue (4096),
+                      MakeUintegerAccessor (&Ipv4TLB::SetAckletTableSize,
+                                            &Ipv4TLB::GetAckletTableSize),
+                      MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("AckletCollision",
+                      "What a new acklet does when its bucket holds another active flow",
+                      EnumValue (FLOWLET_COLLISION_REPLACE),
+                      MakeEnumAccessor (&Ipv4TLB::SetAckletCollisionPolicy,
+                                        &Ipv4TLB::GetAckletCollisionPolicy),
+                      MakeEnumChecker (FLOWLET_COLLISION_REPLACE, "Replace",
+                                       FLOWLET_COLLISION_BYPASS, "Bypass"))
         .AddAttribute ("FlowletTimeout", "The flowlet timeout",
                       TimeValue (MicroSeconds (500)),
                       MakeTimeAccessor (&Ipv4TLB::m_flowletTimeout),
@@ -233,42 +259,52 @@ Ipv4TLB::AddAddressWithTor (Ipv4Address address, uint32_t torId)
     m_ipTorMap[address] = torId;
 }
 
-//存储一个可以到destTor地址的路径
+//存储一个可以到destTor地址的路径，路径在可用路径中的位置即其加入的顺序
 void
 Ipv4TLB::AddAvailPath (uint32_t destTor, uint32_t path)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    TLBDestTorInfo &tor = Ipv4TLB::GetDestTor (destTor);
+    uint32_t slot = Ipv4TLB::GetSlot (tor, path);
+    if (tor.position[slot] != TLBPathSet::NONE)
     {
-        std::vector<uint32_t> paths;
-        paths.push_back(path);
-        m_availablePath[destTor] = paths;
+        NS_LOG_WARN ("Path " << path << " to tor " << destTor << " is already available");
+        return;
     }
-    else 
+
+    uint32_t pos = tor.availSlots.size ();
+    tor.position[slot] = pos;
+    tor.availSlots.push_back (slot);
+    for (uint32_t type = GoodPath; type <= FailPath; ++type)
     {
-        (itr->second).push_back (path);
+        tor.classes[type].Resize (pos + 1);
     }
-    
+    tor.classes[tor.judged[slot].pathType].Set (pos);
+    tor.goodValid = false;
 }
 
 //得到去某个地址的路径集合
 std::vector<uint32_t>
 Ipv4TLB::GetAvailPath (Ipv4Address daddr)
 {
-    std::vector<uint32_t> emptyVector;
+    std::vector<uint32_t> paths;
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
-        return emptyVector;
+        return paths;
     }
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    TLBDestTorInfo *tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor == 0)
+    {
+        return paths;
+    }
+    std::vector<uint32_t>::iterator itr = tor->availSlots.begin ();
+    for ( ; itr != tor->availSlots.end (); ++itr)
     {
-        return emptyVector;
+        paths.push_back (tor->pathIds[*itr]);
     }
-    return itr->second;
+    return paths;
 }
 
 //得到ack的路径 //TODO什么时候调用
@@ -276,27 +312,24 @@ uint32_t
 Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
     //通过flowId找到acklet
-    struct TLBAcklet acklet;
-    std::map<uint32_t, TLBAcklet>::iterator ackletItr = m_acklets.find (flowId);
+    bool ackletActive = false;
+    FlowletTable<uint32_t>::Entry *acklet = m_acklets.Lookup (flowId, m_ackletTimeout, ackletActive);
     //如果找到了
-    if (ackletItr != m_acklets.end ())
+    if (acklet != 0)
     {
         // Existing flow
-        acklet = ackletItr->second; //得到acklet
         //如果当前时间减去上次的时间 未超时
-        if (Simulator::Now () - acklet.activeTime <= m_ackletTimeout) // Timeout
+        if (ackletActive) // Timeout
         {
-            //更新时间
-            acklet.activeTime = Simulator::Now ();
-            //并且存储到m_acklets中 返回
-            m_acklets[flowId] = acklet;
-            return acklet.pathId;
+            //更新时间并返回
+            acklet->activeTime = Simulator::Now ();
+            return acklet->value;
         }
         //TODO？
 
         // Bug Fix for bad small flow FCT in black hole case
         // 如果时间已经超过1ms,则认为是包黑洞
-        if (Simulator:: Now () - acklet.activeTime >= MilliSeconds (1))
+        if (Simulator:: Now () - acklet->activeTime >= MilliSeconds (1))
         {
             //找到这个目的地址对应的TorId
             uint32_t destTor = 0;
@@ -306,7 +339,7 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 return 0;
             }
             //记录现在走的路径
-            uint32_t oldPath = acklet.pathId;
+            uint32_t oldPath = acklet->value;
 
             // Ipv4TLB::TimeoutPath (destTor, oldPath, false, true);
             //构建一个新路径
@@ -321,10 +354,8 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 }
             }
             //新路径赋值，更新时间，然后返回
-            acklet.pathId = newPath.pathId;
-            acklet.activeTime = Simulator::Now ();
-
-            m_acklets[flowId] = acklet;
+            acklet->value = newPath.pathId;
+            acklet->activeTime = Simulator::Now ();
 
             return newPath.pathId;
         }
@@ -344,55 +375,84 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     {
         newPath = Ipv4TLB::SelectRandomPath (destTor);
     }
-    //更新acklet信息 
-    acklet.pathId = newPath.pathId;
-    acklet.activeTime = Simulator::Now ();
-
-    m_acklets[flowId] = acklet;
+    //更新acklet信息，冲突时可能不缓存
+    if (acklet == 0)
+    {
+        acklet = m_acklets.Insert (flowId, m_ackletTimeout);
+    }
+    if (acklet != 0)
+    {
+        acklet->value = newPath.pathId;
+        acklet->activeTime = Simulator::Now ();
+    }
     //然后返回
     return newPath.pathId;
 }
 
+const FlowletTable<uint32_t> &
+Ipv4TLB::GetAckletTable (void) const
+{
+    return m_acklets;
+}
+
+void
+Ipv4TLB::SetAckletTableSize (uint32_t size)
+{
+    m_acklets.SetSize (size);
+}
+
+uint32_t
+Ipv4TLB::GetAckletTableSize (void) const
+{
+    return m_acklets.GetSize ();
+}
+
+void
+Ipv4TLB::SetAckletCollisionPolicy (FlowletCollisionPolicy policy)
+{
+    m_acklets.SetCollisionPolicy (policy);
+}
+
+FlowletCollisionPolicy
+Ipv4TLB::GetAckletCollisionPolicy (void) const
+{
+    return m_acklets.GetCollisionPolicy ();
+}
+
 //从路径上移除一条流,更新相应的TLBPathInfo中的flowCounter
 void
 Ipv4TLB::RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBDestTorInfo *tor = 0;
+    uint32_t slot = 0;
+    if (!Ipv4TLB::FindPathInfo (destTor, path, tor, slot))
     {
         NS_LOG_ERROR ("Cannot remove flow from a non-existing path");
         return;
     }
-    if ((itr->second).flowCounter == 0)
+    if (tor->pathInfo[slot].flowCounter == 0)
     {
         NS_LOG_ERROR ("Cannot decrease from counter while it has reached 0");
         return;
     }
     //将flowCounter减一
-    (itr->second).flowCounter --;
-
+    tor->pathInfo[slot].flowCounter --;
+    Ipv4TLB::RefreshPath (*tor, slot);
 }
 
 //分配流到路径，得到TLBPahtInfo，然后增加其上的流数，即flowCounter值
 void
 Ipv4TLB::AssignFlowToPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
+    TLBDestTorInfo &tor = Ipv4TLB::GetDestTor (destTor);
+    uint32_t slot = Ipv4TLB::GetSlot (tor, path);
+    if (!tor.hasInfo[slot])
     {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
-    {
-        pathInfo = itr->second;
+        Ipv4TLB::InitPathInfo (tor, slot);
     }
 
-    pathInfo.flowCounter ++;
-    m_pathInfo[key] = pathInfo;
+    tor.pathInfo[slot].flowCounter ++;
+    Ipv4TLB::RefreshPath (tor, slot);
 }
 
 //根据flowId还有源地址与目的地址得到一个路径，返回路径ID值
@@ -434,12 +494,18 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         struct PathInfo newPath;
         if (Ipv4TLB::WhereToChange (destTor, newPath, false, 0))
         {
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            if (!m_pathSelectTrace.IsEmpty ())
+            {
+                m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            }
         }
         else //如果不行，则随机选择一条路径
         {
             newPath = Ipv4TLB::SelectRandomPath (destTor);
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            if (!m_pathSelectTrace.IsEmpty ())
+            {
+                m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            }
         }
         //初始化一个TLBFlowInfo对象并且将其添加到m_flowInfo中
         Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
@@ -468,7 +534,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
             {
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    if (!m_pathChangeTrace.IsEmpty ())
+                    {
+                        m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    }
                 }
             }
             else
@@ -476,7 +545,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 newPath = Ipv4TLB::SelectRandomPath (destTor);
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    if (!m_pathChangeTrace.IsEmpty ())
+                    {
+                        m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    }
                 }
             }
 
@@ -500,7 +572,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 && Simulator::Now() - (flowItr->second).tryChangePath > MicroSeconds (100))
         {
             //以m_pathChangePoss的概率重路由
-            if (rand () % RANDOM_BASE < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
+            if (static_cast<int> (m_rand->GetInteger (0, RANDOM_BASE - 1)) < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
             {
                 (flowItr->second).tryChangePath = Simulator::Now ();
                 return oldPath;
@@ -514,7 +586,10 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                     return oldPath;
                 }
 
-                m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                if (!m_pathChangeTrace.IsEmpty ())
+                {
+                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                }
 
                 // Calculate the pause time
                 Time pauseTime = oldPathInfo.rttMin - newPath.rttMin;
@@ -599,19 +674,18 @@ Ipv4TLB::SendFlow (uint32_t flowId, uint32_t path, uint32_t size)
 void
 Ipv4TLB::SendPath (uint32_t destTor, uint32_t path, uint32_t size)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
+    TLBDestTorInfo *tor = 0;
+    uint32_t slot = 0;
+    if (!Ipv4TLB::FindPathInfo (destTor, path, tor, slot))
     {
         NS_LOG_ERROR ("Cannot send a non-existing path");
         return;
     }
 
-    (itr->second).dreValue += size;
+    tor->pathInfo[slot].dreValue += size;
+    Ipv4TLB::RefreshPath (*tor, slot);
 }
 
-
 //更改TLBFlowInfo中retransmissionSize值
 bool
 Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needRetranPath, bool &needHighRetransPath)
@@ -648,18 +722,19 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 void
 Ipv4TLB::RetransPath (uint32_t destTor, uint32_t path, bool needHighRetransPath)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBDestTorInfo *tor = 0;
+    uint32_t slot = 0;
+    if (!Ipv4TLB::FindPathInfo (destTor, path, tor, slot))
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
-    (itr->second).isRetransmission = true;
+    tor->pathInfo[slot].isRetransmission = true;
     if (needHighRetransPath)
     {
-        (itr->second).isHighRetransmission = true;
+        tor->pathInfo[slot].isHighRetransmission = true;
     }
+    Ipv4TLB::RefreshPath (*tor, slot);
 }
 
 //流发送时调用，主要更新流信息等，还有路径信息，如果是重传还有更新相应的变量
@@ -729,25 +804,26 @@ Ipv4TLB::TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout)
 void
 Ipv4TLB::TimeoutPath (uint32_t destTor, uint32_t path, bool isProbing, bool isVeryTimeout)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBDestTorInfo *tor = 0;
+    uint32_t slot = 0;
+    if (!Ipv4TLB::FindPathInfo (destTor, path, tor, slot))
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
     if (!isProbing)
     {
-        (itr->second).isTimeout = true;
+        tor->pathInfo[slot].isTimeout = true;
         if (isVeryTimeout)
         {
-            (itr->second).isVeryTimeout = true;
+            tor->pathInfo[slot].isVeryTimeout = true;
         }
     }
     else
     {
-        (itr->second).isProbingTimeout = true;
+        tor->pathInfo[slot].isProbingTimeout = true;
     }
+    Ipv4TLB::RefreshPath (*tor, slot);
 }
 
 //流超时后调用，主要更新相应的TLBPathInfo与TLBFlowInfo
@@ -834,13 +910,14 @@ Ipv4TLB::ProbeSend (Ipv4Address daddr, uint32_t path)
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    TLBDestTorInfo &tor = Ipv4TLB::GetDestTor (destTor);
+    uint32_t slot = Ipv4TLB::GetSlot (tor, path);
 
-    //如果没有找到就初始化一个并加入m_pathInfo
-    if (itr == m_pathInfo.end ())
+    //如果没有找到就初始化一个
+    if (!tor.hasInfo[slot])
     {
-        m_pathInfo[key] = Ipv4TLB::GetInitPathInfo (path);
+        Ipv4TLB::InitPathInfo (tor, slot);
+        Ipv4TLB::RefreshPath (tor, slot);
     }
 
 }
@@ -880,6 +957,14 @@ Ipv4TLB::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+int64_t
+Ipv4TLB::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 
 //根据是否是探测更新相应信息
 void
@@ -964,18 +1049,14 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 void
 Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool withECN, Time rtt)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    TLBDestTorInfo &tor = Ipv4TLB::GetDestTor (destTor);
+    uint32_t slot = Ipv4TLB::GetSlot (tor, path);
     //如果找不到就初始化一个
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
-    {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
+    if (!tor.hasInfo[slot])
     {
-        pathInfo = itr->second;
+        Ipv4TLB::InitPathInfo (tor, slot);
     }
+    TLBPathInfo &pathInfo = tor.pathInfo[slot];
     //更新收到的量和ECN量还有时间
     pathInfo.size += size;
     if (withECN)
@@ -997,31 +1078,9 @@ Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool wi
     //更新路径信息时会亲更新timeStamp3
     pathInfo.timeStamp3 = Simulator::Now ();
 
-    // Added Jan 11st
-    /*
-    pathInfo.epAckSize += size;
-    if (withECN)
-    {
-        pathInfo.epEcnSize += size;
-    }
-    if (Simulator::Now () - pathInfo.epTimeStamp > m_epCheckTime)
-    {
-        double originalEcnPortion = pathInfo.epEcnPortion;
-        double newEcnPortition = static_cast<double> (pathInfo.epEcnSize) / pathInfo.epAckSize;
-        pathInfo.epAckSize = 1;
-        pathInfo.epEcnSize = 0;
-        pathInfo.epEcnPortion = m_epAlpha * originalEcnPortion + (1.0 - m_epAlpha) * newEcnPortition;
-        pathInfo.epTimeStamp = Simulator::Now ();
-    }
-    */
-    // --
-
-    m_pathInfo[key] = pathInfo;
+    Ipv4TLB::RefreshPath (tor, slot);
 }
 
-
-
-
 //初始化一个TLBFlowInfo并返回
 void
 Ipv4TLB::UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor)
@@ -1063,125 +1122,40 @@ bool
 Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, uint32_t oldPath)
 {
     //找到到达目的Tor的路径
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    TLBDestTorInfo *tor = Ipv4TLB::FindDestTor (destTor);
     //如果找不到则返回错误
-    if (itr == m_availablePath.end ())
+    if (tor == 0 || tor->availSlots.empty ())
     {
         NS_LOG_ERROR ("Cannot find available paths");
         return false;
     }
 
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
-
     // Firstly, checking good path
-    uint32_t minCounter = std::numeric_limits<uint32_t>::max ();
-    Time minRTT = Seconds (666);
-    uint32_t minRTTLevel = 5;
-    uint32_t minDre = std::pow (2, m_dreQ);
-    std::vector<PathInfo> candidatePaths;
-    //遍历所有可以到destTor的路径
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    // 好路径的候选集合只在某条好路径的状态变化之后才重新计算
+    if (!tor->goodValid)
     {
-        uint32_t pathId = *vectorItr;
-        //判断路径得到路径的具体信息
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GoodPath)
-        {
-            if (m_runMode == TLB_RUNMODE_COUNTER) //选择counter值最小的路径
-            {
-                //如果等于则直接加入候选，如果小于则清空候选，然后加入
-                if (pathInfo.counter <= minCounter)
-                {
-                    if (pathInfo.counter < minCounter)
-                    {
-                        candidatePaths.clear ();
-                        minCounter = pathInfo.counter;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_MINRTT) //选择minRTT最小的路径
-            {
-                 //如果等于则直接加入候选，如果小于则清空候选，然后加入
-                if (pathInfo.rttMin <= minRTT)
-                {
-                    if (pathInfo.rttMin < minRTT)
-                    {
-                        candidatePaths.clear ();
-                        minRTT = pathInfo.rttMin;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-            {
-                //将这条路径的pathInfo中的rttMin量化分级
-                uint32_t RTTLevel = Ipv4TLB::QuantifyRtt (pathInfo.rttMin);
-                //下面的代码是寻找RTTLevel和counter都小于当前，如果等于则直接push进去，而不clear，优先比较RTT
-                //如果RTTLevel就比较大则直接不比较了，如果RTTLevel小则会直接push,也即优先考虑RTT
-                if (RTTLevel < minRTTLevel)
-                {
-                    minRTTLevel = RTTLevel;
-                    minCounter = std::numeric_limits<uint32_t>::max ();
-                    candidatePaths.clear (); //TODO
-                }
-                if (RTTLevel == minRTTLevel)
-                {
-                    if (m_runMode == TLB_RUNMODE_RTT_COUNTER)
-                    {
-                        if (pathInfo.counter < minCounter)
-                        {
-                            minCounter = pathInfo.counter;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.counter == minCounter)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                    else if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.quantifiedDre < minDre)
-                        {
-                            minDre = pathInfo.quantifiedDre;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.quantifiedDre == minDre)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                }
-            }
-            else//其它RunMode直接返回
-            {
-                candidatePaths.push_back (pathInfo);
-            }
-        }
+        struct PathInfo noPath;
+        tor->goodMinRttLevel = 5;
+        Ipv4TLB::CollectCandidates (*tor, GoodPath, false, noPath,
+                                    tor->goodCandidates, tor->goodMinCounter, tor->goodMinRttLevel);
+        tor->goodValid = true;
     }
+    uint32_t minRTTLevel = tor->goodMinRttLevel;
 
     //如果候选路径非空， 即good路径非空
-    if (!candidatePaths.empty ())
+    if (!tor->goodCandidates.empty ())
     {
         if (m_runMode == TLB_RUNMODE_COUNTER)
         {
             //如是数量小于等于m_K,则随机选择一个
-            if (minCounter <= m_K) //TODO
+            if (tor->goodMinCounter <= m_K) //TODO
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = tor->goodCandidates[m_rand->GetInteger (0, tor->goodCandidates.size () - 1)];
             }
         }
-        else if (m_runMode == TLB_RUNMODE_MINRTT)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = tor->goodCandidates[m_rand->GetInteger (0, tor->goodCandidates.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Good Path: " << newPath.pathId);
         return true;
@@ -1206,87 +1180,10 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         originalPath.quantifiedDre = std::pow (2, m_dreQ);
     }
 
-    minCounter = std::numeric_limits<uint32_t>::max ();
-    minRTT = Seconds (666);
-    minDre = std::pow (2, m_dreQ);
-    candidatePaths.clear ();
-    vectorItr = (itr->second).begin ();
-    //然后同上面一样遍历所有路径，选择一条最好的grey路径，其它同上
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
-    {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GreyPath
-            && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
-        {
-            if (m_runMode == TLB_RUNMODE_COUNTER)
-            {
-                if (pathInfo.counter <= minCounter)
-                {
-                    if (pathInfo.counter < minCounter)
-                    {
-                        candidatePaths.clear ();
-                        minCounter = pathInfo.counter;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_MINRTT)
-            {
-                if (pathInfo.rttMin <= minRTT)
-                {
-                    if (pathInfo.rttMin < minRTT)
-                    {
-                        candidatePaths.clear ();
-                        minRTT = pathInfo.rttMin;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-            {
-                uint32_t RTTLevel = Ipv4TLB::QuantifyRtt (pathInfo.rttMin);
-                if (RTTLevel < minRTTLevel)
-                {
-                    minRTTLevel = RTTLevel;
-                    minCounter = std::numeric_limits<uint32_t>::max ();
-                    candidatePaths.clear ();
-                }
-                if (RTTLevel == minRTTLevel)
-                {
-
-                    if (m_runMode == TLB_RUNMODE_RTT_COUNTER)
-                    {
-                        if (pathInfo.counter < minCounter)
-                        {
-                            minCounter = pathInfo.counter;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.counter == minCounter)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                    else if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.quantifiedDre < minDre)
-                        {
-                            minDre = pathInfo.quantifiedDre;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.quantifiedDre == minDre)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                candidatePaths.push_back (pathInfo);
-            }
-        }
-    }
+    //然后同上面一样遍历grey路径，选择比原来路径好的路径
+    std::vector<PathInfo> candidatePaths;
+    uint32_t minCounter = std::numeric_limits<uint32_t>::max ();
+    Ipv4TLB::CollectCandidates (*tor, GreyPath, true, originalPath, candidatePaths, minCounter, minRTTLevel);
 
     if (!candidatePaths.empty ()) //注释同上
     {
@@ -1294,21 +1191,12 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         {
             if (minCounter <= m_K)
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
             }
         }
-        else if (m_runMode == TLB_RUNMODE_MINRTT)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Grey Path: " << newPath.pathId);
         return true;
@@ -1316,13 +1204,11 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
 
    // Thirdly, checking bad path
    //如果连grey路径都没有，选择bad路径中比原来好的，选到即返回
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    const TLBPathSet &badPaths = tor->classes[BadPath];
+    for (uint32_t pos = badPaths.FindNext (0); pos != TLBPathSet::NONE; pos = badPaths.FindNext (pos + 1))
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == BadPath
-            && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
+        const PathInfo &pathInfo = tor->judged[tor->availSlots[pos]];
+        if (Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
         {
             newPath = pathInfo;
             NS_LOG_LOGIC ("Find Bad Path: " << newPath.pathId);
@@ -1335,14 +1221,107 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
     return false;
 }
 
+//在某一类路径中按运行模式选出候选路径，mustBeBetter表示只考虑比originalPath好的路径
+//minRTTLevel由调用者传入，grey路径沿用good路径中得到的值
+void
+Ipv4TLB::CollectCandidates (const TLBDestTorInfo &tor, PathType type, bool mustBeBetter, const PathInfo &originalPath,
+                            std::vector<PathInfo> &candidatePaths, uint32_t &minCounter, uint32_t &minRTTLevel)
+{
+    candidatePaths.clear ();
+    minCounter = std::numeric_limits<uint32_t>::max ();
+    Time minRTT = Seconds (666);
+    uint32_t minDre = std::pow (2, m_dreQ);
+
+    //只遍历这一类的路径，顺序与可用路径的顺序一致
+    const TLBPathSet &paths = tor.classes[type];
+    for (uint32_t pos = paths.FindNext (0); pos != TLBPathSet::NONE; pos = paths.FindNext (pos + 1))
+    {
+        const PathInfo &pathInfo = tor.judged[tor.availSlots[pos]];
+        if (mustBeBetter && !Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
+        {
+            continue;
+        }
+        if (m_runMode == TLB_RUNMODE_COUNTER) //选择counter值最小的路径
+        {
+            //如果等于则直接加入候选，如果小于则清空候选，然后加入
+            if (pathInfo.counter <= minCounter)
+            {
+                if (pathInfo.counter < minCounter)
+                {
+                    candidatePaths.clear ();
+                    minCounter = pathInfo.counter;
+                }
+                candidatePaths.push_back (pathInfo);
+            }
+        }
+        else if (m_runMode == TLB_RUNMODE_MINRTT) //选择minRTT最小的路径
+        {
+             //如果等于则直接加入候选，如果小于则清空候选，然后加入
+            if (pathInfo.rttMin <= minRTT)
+            {
+                if (pathInfo.rttMin < minRTT)
+                {
+                    candidatePaths.clear ();
+                    minRTT = pathInfo.rttMin;
+                }
+                candidatePaths.push_back (pathInfo);
+            }
+        }
+        else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
+        {
+            //将这条路径的pathInfo中的rttMin量化分级
+            uint32_t RTTLevel = Ipv4TLB::QuantifyRtt (pathInfo.rttMin);
+            //下面的代码是寻找RTTLevel和counter都小于当前，如果等于则直接push进去，而不clear，优先比较RTT
+            //如果RTTLevel就比较大则直接不比较了，如果RTTLevel小则会直接push,也即优先考虑RTT
+            if (RTTLevel < minRTTLevel)
+            {
+                minRTTLevel = RTTLevel;
+                minCounter = std::numeric_limits<uint32_t>::max ();
+                candidatePaths.clear (); //TODO
+            }
+            if (RTTLevel == minRTTLevel)
+            {
+                if (m_runMode == TLB_RUNMODE_RTT_COUNTER)
+                {
+                    if (pathInfo.counter < minCounter)
+                    {
+                        minCounter = pathInfo.counter;
+                        candidatePaths.clear ();
+                    }
+                    if (pathInfo.counter == minCounter)
+                    {
+                        candidatePaths.push_back (pathInfo);
+                    }
+                }
+                else if (m_runMode == TLB_RUNMODE_RTT_DRE)
+                {
+                    if (pathInfo.quantifiedDre < minDre)
+                    {
+                        minDre = pathInfo.quantifiedDre;
+                        candidatePaths.clear ();
+                    }
+                    if (pathInfo.quantifiedDre == minDre)
+                    {
+                        candidatePaths.push_back (pathInfo);
+                    }
+                }
+            }
+        }
+        else//其它RunMode直接加入
+        {
+            candidatePaths.push_back (pathInfo);
+        }
+    }
+}
+
 //随机选择一条路径
 struct PathInfo
 Ipv4TLB::SelectRandomPath (uint32_t destTor)
 {
     //查询可行路径
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    TLBDestTorInfo *tor = Ipv4TLB::FindDestTor (destTor);
     //如果没有则直接返回其中pathId=0
-    if (itr == m_availablePath.end ())
+    if (tor == 0 || tor->availSlots.empty ())
     {
         NS_LOG_ERROR ("Cannot find available paths");
         PathInfo pathInfo;
@@ -1350,49 +1329,64 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
         return pathInfo;
     }
 
-    //否则遍历所有数组
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
-    std::vector<PathInfo> availablePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
-    {
-        //判断路径
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GoodPath || pathInfo.pathType == GreyPath || pathInfo.pathType == BadPath)
-        {
-            //合全部加入
-            availablePaths.push_back (pathInfo);
-        }
-    }
-    
-    //如果候选非空，则在候选随机选择一条路径
+    //Good，Grey与Bad路径都是候选，没有Fail路径时直接按位置随机选择
+    uint32_t pathCount = tor->availSlots.size ();
+    const TLBPathSet &failPaths = tor->classes[FailPath];
     struct PathInfo newPath;
-    if (!availablePaths.empty ())
+    if (!failPaths.Any ())
     {
-        newPath = availablePaths[rand() % availablePaths.size ()];
+        newPath = tor->judged[tor->availSlots[m_rand->GetInteger (0, pathCount - 1)]];
     }
     else
     {
-        //否则随机选一个候选路径
-        uint32_t pathId = (itr->second)[rand() % (itr->second).size ()];
-        newPath = Ipv4TLB::JudgePath (destTor, pathId);
+        std::vector<PathInfo> availablePaths;
+        for (uint32_t pos = 0; pos < pathCount; ++pos)
+        {
+            if (!failPaths.Test (pos))
+            {
+                availablePaths.push_back (tor->judged[tor->availSlots[pos]]);
+            }
+        }
+
+        //如果候选非空，则在候选随机选择一条路径
+        if (!availablePaths.empty ())
+        {
+            newPath = availablePaths[m_rand->GetInteger (0, availablePaths.size () - 1)];
+        }
+        else
+        {
+            //否则随机选一个候选路径
+            newPath = tor->judged[tor->availSlots[m_rand->GetInteger (0, pathCount - 1)]];
+        }
     }
     NS_LOG_LOGIC ("Random selection return path: " << newPath.pathId);
     return newPath;
 }
 
-//判断路径是什么类型的
+//判断路径是什么类型的，结果在路径信息变化时由RefreshPath缓存
 struct PathInfo
 Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
 {
-    //查询TLBPathInfo
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, pathId);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    TLBDestTorInfo *tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor != 0)
+    {
+        std::map<uint32_t, uint32_t>::iterator itr = tor->slots.find (pathId);
+        if (itr != tor->slots.end ())
+        {
+            return tor->judged[itr->second];
+        }
+    }
+    return Ipv4TLB::JudgePathInfo (pathId, 0);
+}
 
+//根据TLBPathInfo判断路径类型，pathInfo为0表示还没有这条路径的信息
+struct PathInfo
+Ipv4TLB::JudgePathInfo (uint32_t pathId, const TLBPathInfo *info)
+{
     struct PathInfo path;
     path.pathId = pathId;
     //如果没找到，则直接返回，返回类型为greyPath
-    if (itr == m_pathInfo.end ())
+    if (info == 0)
     {
         path.pathType = GreyPath;
         /*path.pathType = GoodPath;*/
@@ -1404,7 +1398,7 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
         path.quantifiedDre = 0;
         return path;
     }
-    TLBPathInfo pathInfo = itr->second;
+    const TLBPathInfo &pathInfo = *info;
     path.rttMin = pathInfo.minRtt;
     path.size = pathInfo.size;
     //ECN的比例
@@ -1447,6 +1441,97 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
     return path;
 }
 
+//找到目的Tor的路径状态，不存在则返回0
+TLBDestTorInfo *
+Ipv4TLB::FindDestTor (uint32_t destTor)
+{
+    if (destTor >= m_destTors.size ())
+    {
+        return 0;
+    }
+    return &m_destTors[destTor];
+}
+
+//得到目的Tor的路径状态，不存在则创建
+TLBDestTorInfo &
+Ipv4TLB::GetDestTor (uint32_t destTor)
+{
+    if (destTor >= m_destTors.size ())
+    {
+        m_destTors.resize (destTor + 1);
+    }
+    return m_destTors[destTor];
+}
+
+//得到路径在目的Tor中的槽位，不存在则分配一个新的槽位
+uint32_t
+Ipv4TLB::GetSlot (TLBDestTorInfo &tor, uint32_t path)
+{
+    std::map<uint32_t, uint32_t>::iterator itr = tor.slots.find (path);
+    if (itr != tor.slots.end ())
+    {
+        return itr->second;
+    }
+    uint32_t slot = tor.pathIds.size ();
+    tor.slots[path] = slot;
+    tor.pathIds.push_back (path);
+    tor.pathInfo.push_back (TLBPathInfo ());
+    tor.hasInfo.push_back (false);
+    tor.judged.push_back (Ipv4TLB::JudgePathInfo (path, 0));
+    tor.position.push_back (TLBPathSet::NONE);
+    return slot;
+}
+
+//查找已经初始化的路径信息，找不到返回false
+bool
+Ipv4TLB::FindPathInfo (uint32_t destTor, uint32_t path, TLBDestTorInfo *&tor, uint32_t &slot)
+{
+    tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor == 0)
+    {
+        return false;
+    }
+    std::map<uint32_t, uint32_t>::iterator itr = tor->slots.find (path);
+    if (itr == tor->slots.end () || !tor->hasInfo[itr->second])
+    {
+        return false;
+    }
+    slot = itr->second;
+    return true;
+}
+
+//初始化槽位上的路径信息，调用者负责随后调用RefreshPath
+void
+Ipv4TLB::InitPathInfo (TLBDestTorInfo &tor, uint32_t slot)
+{
+    tor.pathInfo[slot] = Ipv4TLB::GetInitPathInfo (tor.pathIds[slot]);
+    tor.hasInfo[slot] = true;
+    tor.agingDeadline = std::min (tor.agingDeadline, Simulator::Now () + std::min (m_T1, m_T2));
+}
+
+//路径信息变化之后刷新JudgePath的缓存结果与路径分类
+void
+Ipv4TLB::RefreshPath (TLBDestTorInfo &tor, uint32_t slot)
+{
+    struct PathInfo path = Ipv4TLB::JudgePathInfo (tor.pathIds[slot], &tor.pathInfo[slot]);
+    uint32_t pos = tor.position[slot];
+    if (pos != TLBPathSet::NONE)
+    {
+        PathType oldType = tor.judged[slot].pathType;
+        //只有好路径的变化会影响好路径的候选集合
+        if (oldType == GoodPath || path.pathType == GoodPath)
+        {
+            tor.goodValid = false;
+        }
+        if (oldType != path.pathType)
+        {
+            tor.classes[oldType].Reset (pos);
+            tor.classes[path.pathType].Set (pos);
+        }
+    }
+    tor.judged[slot] = path;
+}
+
 //对比两个路径，第一个路径是否比第二个路径好
 bool
 Ipv4TLB::PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR)
@@ -1481,89 +1566,98 @@ void
 Ipv4TLB::PathAging (void)
 {
     NS_LOG_LOGIC (this << " Path Info: " << (Simulator::Now ()));
-    //第一个是destTor，第二个是pathId
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
-    {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        NS_LOG_LOGIC ("\t" << " Size: " << (itr->second).size
-                           << " ECN Size: " << (itr->second).ecnSize
-                           << " Min RTT: " << (itr->second).minRtt
-                           << " Is Retransmission: " << (itr->second).isRetransmission
-                           << " Is HRetransmission: " << (itr->second).isHighRetransmission
-                           << " Is Timeout: " << (itr->second).isTimeout
-                           << " Is VTimeout: " << (itr->second).isVeryTimeout
-                           << " Is ProbingTimeout: " << (itr->second).isProbingTimeout
-                           << " Flow Counter: " << (itr->second).flowCounter);
-        //如果当前时间距离上次超过m_T1,则会老化超时等变量
-        if (Simulator::Now() - (itr->second).timeStamp1 > m_T1)
+    Time now = Simulator::Now ();
+    for (uint32_t destTor = 0; destTor < m_destTors.size (); ++destTor)
+    {
+        TLBDestTorInfo &tor = m_destTors[destTor];
+        //在最早的老化时间之前，这个Tor上没有路径需要老化
+        if (now <= tor.agingDeadline)
         {
-            //gj 更新一些参数
-            (itr->second).size = 1;
-            (itr->second).ecnSize = 0;
-            (itr->second).isTimeout = false;
-            (itr->second).timeStamp1 = Simulator::Now ();
+            continue;
         }
-        //如果超过m_T2则老化重传等变量
-        if (Simulator::Now () - (itr->second).timeStamp2 > m_T2)
+        Time deadline = Time::Max ();
+        for (uint32_t slot = 0; slot < tor.pathIds.size (); ++slot)
         {
-            (itr->second).isRetransmission = false;
-            (itr->second).isHighRetransmission = false;
-            (itr->second).isVeryTimeout = false;
-            (itr->second).isProbingTimeout = false;
-            (itr->second).timeStamp2 = Simulator::Now ();
-        }//如果超过则更新 TODO
-        if (Simulator::Now () - (itr->second).timeStamp3 > m_T1)
-        {
-            if (m_isSmooth)
+            if (!tor.hasInfo[slot])
+            {
+                continue;
+            }
+            TLBPathInfo &pathInfo = tor.pathInfo[slot];
+            NS_LOG_LOGIC ("<" << destTor << "," << tor.pathIds[slot] << ">");
+            NS_LOG_LOGIC ("\t" << " Size: " << pathInfo.size
+                               << " ECN Size: " << pathInfo.ecnSize
+                               << " Min RTT: " << pathInfo.minRtt
+                               << " Is Retransmission: " << pathInfo.isRetransmission
+                               << " Is HRetransmission: " << pathInfo.isHighRetransmission
+                               << " Is Timeout: " << pathInfo.isTimeout
+                               << " Is VTimeout: " << pathInfo.isVeryTimeout
+                               << " Is ProbingTimeout: " << pathInfo.isProbingTimeout
+                               << " Flow Counter: " << pathInfo.flowCounter);
+            bool changed = false;
+            //如果当前时间距离上次超过m_T1,则会老化超时等变量
+            if (now - pathInfo.timeStamp1 > m_T1)
             {
-                Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
-                if ((itr->second).minRtt < desiredRtt)
+                //gj 更新一些参数
+                pathInfo.size = 1;
+                pathInfo.ecnSize = 0;
+                pathInfo.isTimeout = false;
+                pathInfo.timeStamp1 = now;
+                changed = true;
+            }
+            //如果超过m_T2则老化重传等变量
+            if (now - pathInfo.timeStamp2 > m_T2)
+            {
+                pathInfo.isRetransmission = false;
+                pathInfo.isHighRetransmission = false;
+                pathInfo.isVeryTimeout = false;
+                pathInfo.isProbingTimeout = false;
+                pathInfo.timeStamp2 = now;
+                changed = true;
+            }//如果超过则更新 TODO
+            if (now - pathInfo.timeStamp3 > m_T1)
+            {
+                if (m_isSmooth)
                 {
-                    (itr->second).minRtt = std::min (desiredRtt, (itr->second).minRtt * m_smoothBeta1 / SMOOTH_BASE);
+                    Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
+                    if (pathInfo.minRtt < desiredRtt)
+                    {
+                        pathInfo.minRtt = std::min (desiredRtt, pathInfo.minRtt * m_smoothBeta1 / SMOOTH_BASE);
+                    }
+                    else
+                    {
+                        pathInfo.minRtt = std::max (desiredRtt, pathInfo.minRtt * m_smoothBeta2 / SMOOTH_BASE);
+                    }
                 }
                 else
                 {
-                    (itr->second).minRtt = std::max (desiredRtt, (itr->second).minRtt * m_smoothBeta2 / SMOOTH_BASE);
+                    pathInfo.minRtt = Seconds (666);
                 }
+                pathInfo.timeStamp3 = now;
+                changed = true;
             }
-            else
+            if (changed)
             {
-                (itr->second).minRtt = Seconds (666);
+                Ipv4TLB::RefreshPath (tor, slot);
             }
-            (itr->second).timeStamp3 = Simulator::Now ();
-        }
-
-        /*
-        if (Simulator::Now () - (itr->second).epTimeStamp > m_epAgingTime)
-        {
-            (itr->second).epAckSize = 1;
-            (itr->second).epEcnSize = 0;
-            (itr->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr->second).epTimeStamp = Simulator::Now ();
+            deadline = std::min (deadline, std::min (pathInfo.timeStamp1 + m_T1,
+                                                     std::min (pathInfo.timeStamp2 + m_T2, pathInfo.timeStamp3 + m_T1)));
         }
-        */
+        tor.agingDeadline = deadline;
     }
 
     //如果一个流的时间超过m_flowDieTime,则从路径上移除
     std::map<uint32_t, TLBFlowInfo>::iterator itr2 = m_flowInfo.begin ();
-    for ( ; itr2 != m_flowInfo.end (); ++itr2)
+    while (itr2 != m_flowInfo.end ())
     {
-        if (Simulator::Now () - (itr2->second).liveTime >= m_flowDieTime)
+        if (now - (itr2->second).liveTime >= m_flowDieTime)
         {
             Ipv4TLB::RemoveFlowFromPath ((itr2->second).flowId, (itr2->second).destTor, (itr2->second).path);
-            m_flowInfo.erase (itr2);
+            m_flowInfo.erase (itr2++);
         }
-
-        /*
-        else if (Simulator::Now () - (itr2->second).epTimeStamp > m_epAgingTime)
+        else
         {
-            (itr2->second).epAckSize = 1;
-            (itr2->second).epEcnSize = 0;
-            (itr2->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr2->second).epTimeStamp = Simulator::Now ();
+            ++itr2;
         }
-        */
     }
 
     m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
@@ -1575,16 +1669,16 @@ Ipv4TLB::GatherParallelPaths (uint32_t destTor)
 {
     std::vector<PathInfo> paths;
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    TLBDestTorInfo *tor = Ipv4TLB::FindDestTor (destTor);
+    if (tor == 0)
     {
         return paths;
     }
 
-    std::vector<uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr )
+    std::vector<uint32_t>::iterator itr = tor->availSlots.begin ();
+    for ( ; itr != tor->availSlots.end (); ++itr)
     {
-        paths.push_back(Ipv4TLB::JudgePath ((itr->first), *innerItr));
+        paths.push_back (tor->judged[*itr]);
     }
 
     return paths;
@@ -1594,12 +1688,24 @@ Ipv4TLB::GatherParallelPaths (uint32_t destTor)
 void
 Ipv4TLB::DreAging (void)
 {
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
+    for (uint32_t destTor = 0; destTor < m_destTors.size (); ++destTor)
     {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        (itr->second).dreValue *= (1 - m_dreAlpha);
-        NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre ((itr->second).dreValue));
+        TLBDestTorInfo &tor = m_destTors[destTor];
+        for (uint32_t slot = 0; slot < tor.pathIds.size (); ++slot)
+        {
+            if (!tor.hasInfo[slot])
+            {
+                continue;
+            }
+            NS_LOG_LOGIC ("<" << destTor << "," << tor.pathIds[slot] << ">");
+            uint32_t oldDre = tor.pathInfo[slot].dreValue;
+            tor.pathInfo[slot].dreValue *= (1 - m_dreAlpha);
+            NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre (tor.pathInfo[slot].dreValue));
+            if (tor.pathInfo[slot].dreValue != oldDre)
+            {
+                Ipv4TLB::RefreshPath (tor, slot);
+            }
+        }
     }
 
     m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
@@ -9,8 +9,11 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 #include "tlb-flow-info.h"
 #include "tlb-path-info.h"
+#include "tlb-path-set.h"
 
 #include <vector>
 #include <map>
@@ -43,10 +46,25 @@ struct PathInfo {
     uint32_t quantifiedDre;
 };
 
-//记录pathId与激活时间
-struct TLBAcklet {
-    uint32_t pathId; //路径ID
-    Time activeTime; //上次活动的时间 
+//到某个目的Tor的全部路径状态，按槽位(slot)连续存放
+struct TLBDestTorInfo {
+    TLBDestTorInfo ();
+
+    std::map<uint32_t, uint32_t> slots; /* <PathId, Slot> */
+    std::vector<uint32_t> pathIds; // 槽位对应的路径ID
+    std::vector<TLBPathInfo> pathInfo; // 槽位对应的路径信息
+    std::vector<bool> hasInfo; // 槽位上的路径信息是否已经初始化
+    std::vector<PathInfo> judged; // JudgePath的缓存结果，路径信息每次变化后刷新
+    std::vector<uint32_t> position; // 槽位在可用路径中的位置，不可用为TLBPathSet::NONE
+    std::vector<uint32_t> availSlots; // 按AddAvailPath的顺序排列的可用路径槽位
+    TLBPathSet classes[FailPath + 1]; // 每种路径类型对应的可用路径位置集合
+    Time agingDeadline; // 在这个时间之前PathAging不需要检查这个Tor
+
+    // 好路径的候选集合，在好路径的状态变化前一直有效
+    bool goodValid;
+    std::vector<PathInfo> goodCandidates;
+    uint32_t goodMinCounter;
+    uint32_t goodMinRttLevel;
 };
 
 class Node;
@@ -93,12 +111,23 @@ public:
     // Node
     void SetNode (Ptr<Node> node);
 
+    //指定路径选择所用随机变量的流编号，返回使用的流数量
+    int64_t AssignStreams (int64_t stream);
+
+    //acklet表的命中、未命中与冲突计数
+    const FlowletTable<uint32_t> &GetAckletTable (void) const;
+
     static std::string GetPathType (PathType type);
 
     static std::string GetLogo (void);
 
 private:
 
+    void SetAckletTableSize (uint32_t size);
+    uint32_t GetAckletTableSize (void) const;
+    void SetAckletCollisionPolicy (FlowletCollisionPolicy policy);
+    FlowletCollisionPolicy GetAckletCollisionPolicy (void) const;
+
     void PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
                         uint32_t size, bool withECN, Time rtt, bool isProbing);
 
@@ -132,6 +161,23 @@ private:
 
     struct PathInfo JudgePath (uint32_t destTor, uint32_t path);
 
+    struct PathInfo JudgePathInfo (uint32_t path, const TLBPathInfo *pathInfo);
+
+    void CollectCandidates (const TLBDestTorInfo &tor, PathType type, bool mustBeBetter, const PathInfo &originalPath,
+                            std::vector<PathInfo> &candidatePaths, uint32_t &minCounter, uint32_t &minRTTLevel);
+
+    TLBDestTorInfo *FindDestTor (uint32_t destTor);
+
+    TLBDestTorInfo &GetDestTor (uint32_t destTor);
+
+    uint32_t GetSlot (TLBDestTorInfo &tor, uint32_t path);
+
+    bool FindPathInfo (uint32_t destTor, uint32_t path, TLBDestTorInfo *&tor, uint32_t &slot);
+
+    void InitPathInfo (TLBDestTorInfo &tor, uint32_t slot);
+
+    void RefreshPath (TLBDestTorInfo &tor, uint32_t slot);
+
     bool PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR);
 
     bool FindTorId (Ipv4Address daddr, uint32_t &destTorId);
@@ -234,14 +280,11 @@ private:
 
     // Variables
     std::map<uint32_t, TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo> m_pathInfo; /* <DestTorId, PathId>, TLBPathInfo> */
+    std::vector<TLBDestTorInfo> m_destTors; /* 以DestTorId为下标的路径状态 */
 
-    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+    FlowletTable<uint32_t> m_acklets; /* FlowId -> PathId, 表项过期后仍保留到被其他流占用 */
     // 服务器地址到与其相连的ToRId的映射
     std::map<Ipv4Address, uint32_t> m_ipTorMap; /* <DestAddress, DestTorId> */
-    // 可以到达某个地址的路径
-    std::map<uint32_t, std::vector<uint32_t> > m_availablePath; /* <DestTorId, List<PathId>> */
-
     std::map<uint32_t, Ipv4Address> m_probingAgent; /* <DestTorId, ProbingAgentAddress>*/
 
     EventId m_agingEvent;
@@ -250,6 +293,9 @@ private:
 
     Ptr<Node> m_node;
 
+    //候选路径中的随机选择以及重路由的概率判断
+    Ptr<UniformRandomVariable> m_rand;
+
     std::map<uint32_t, Time> m_pauseTime; // Used in the TCP pause, not mandatory
 
     typedef void (* TLBPathCallback) (uint32_t flowId, uint32_t fromTor,
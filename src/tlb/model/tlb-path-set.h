@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_PATH_SET_H
+#define TLB_PATH_SET_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A growable bitset over the path positions of one destination ToR.
+ *
+ * Ipv4TLB keeps one set per path class so that the selection loops only
+ * visit the paths of the class they are interested in, in the order the
+ * paths were made available.
+ */
+class TLBPathSet
+{
+public:
+  static const uint32_t NONE = 0xffffffff;
+
+  void Resize (uint32_t size)
+  {
+    m_words.resize ((size + 63) / 64, 0);
+  }
+
+  void Set (uint32_t pos)
+  {
+    m_words[pos >> 6] |= static_cast<uint64_t> (1) << (pos & 63);
+  }
+
+  void Reset (uint32_t pos)
+  {
+    m_words[pos >> 6] &= ~(static_cast<uint64_t> (1) << (pos & 63));
+  }
+
+  bool Test (uint32_t pos) const
+  {
+    return (m_words[pos >> 6] >> (pos & 63)) & 1;
+  }
+
+  bool Any (void) const
+  {
+    for (std::vector<uint64_t>::const_iterator itr = m_words.begin (); itr != m_words.end (); ++itr)
+      {
+        if (*itr != 0)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /**
+   * \param pos the first position to look at
+   * \returns the lowest position >= pos in the set, or NONE
+   */
+  uint32_t FindNext (uint32_t pos) const
+  {
+    uint32_t word = pos >> 6;
+    if (word >= m_words.size ())
+      {
+        return NONE;
+      }
+    uint64_t bits = m_words[word] & (~static_cast<uint64_t> (0) << (pos & 63));
+    while (bits == 0)
+      {
+        if (++word >= m_words.size ())
+          {
+            return NONE;
+          }
+        bits = m_words[word];
+      }
+    return (word << 6) + __builtin_ctzll (bits);
+  }
+
+private:
+  std::vector<uint64_t> m_words;
+};
+
+}
+
+#endif
@@ -17,6 +17,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/event-trace.h"
 #include "cache.h"
 #include "ns3/flow-id-tag.h"
 #include <algorithm>
@@ -87,7 +88,7 @@ Cache::Cache() : m_flows(),
 Cache::~Cache()
 {
   NS_LOG_FUNCTION(this);
-  std::cout<<"CacheNumber:"<<m_cacheNumber<<'\n';
+  NS_LOG_INFO("CacheNumber:" << m_cacheNumber);
 }
 
 void Cache::SetDataRate(DataRate bps)
@@ -312,11 +313,10 @@ Cache::GetFlowCacheNumber(uint32_t discId, uint32_t flowid)
   DiscCacheI itr = m_flows.find(discId);
   if (itr != m_flows.end())
   {
-    FlowCache fc_tmp = itr->second;
-    FlowCacheI fc_itr = fc_tmp.find(flowid);
-    if (fc_itr != fc_tmp.end())
+    FlowCacheI fc_itr = itr->second.find(flowid);
+    if (fc_itr != itr->second.end())
     {
-      num = m_flows[discId][flowid].size();
+      num = fc_itr->second.size();
     }
   }
   return num;
@@ -328,7 +328,8 @@ Cache::GetDiscCacheNumber(uint32_t discId)
   NS_LOG_FUNCTION(this << discId);
   if (m_fifo)
   {
-    return m_fifoFlows[discId].size();
+    FlowCacheI itr = m_fifoFlows.find(discId);
+    return itr != m_fifoFlows.end() ? itr->second.size() : 0;
   }
   else
   {
@@ -336,9 +337,8 @@ Cache::GetDiscCacheNumber(uint32_t discId)
     DiscCacheI itr = m_flows.find(discId);
     if (itr != m_flows.end())
     {
-      FlowCache fc = itr->second;
-      FlowCacheI iter = fc.begin();
-      for (; iter != fc.end(); iter++)
+      FlowCacheI iter = itr->second.begin();
+      for (; iter != itr->second.end(); iter++)
       {
         num += (iter->second).size();
       }
@@ -361,8 +361,7 @@ bool Cache::DoEnqueue(uint32_t discId, Ptr<QueueItem> item)
     }
     m_fifoFlows[discId].push(item);
     m_cacheNumber++;
-    NS_LOG_LOGIC("FIFO: Cached " << this << " Packet number is " << m_cacheNumber
-                                 << "\t Disc " << discId << " have number packets is " << m_fifoFlows[discId].size());
+    NS_EVENT_TRACE("Cache", "Enqueue", discId, 0, m_cacheNumber, GetDiscCacheNumber(discId));
     return true;
   }
   else
@@ -375,8 +374,7 @@ bool Cache::DoEnqueue(uint32_t discId, Ptr<QueueItem> item)
       flowid = flowIdTag.GetFlowId();
     m_flows[discId][flowid].push(item);
     m_cacheNumber++;
-    NS_LOG_LOGIC("Flow: Cached " << this << " Packet number is " << m_cacheNumber
-                                 << "\t Disc " << discId << " have number packets is " << m_flows[discId].size());
+    NS_EVENT_TRACE("Cache", "Enqueue", discId, flowid, m_cacheNumber, GetDiscCacheNumber(discId));
     if(m_enableCacheLog) RecordLog();
     return true;
   }
@@ -397,8 +395,7 @@ Cache::DoDequeue(uint32_t discId)
       if (item != 0)
         m_cacheNumber--;
     }
-    NS_LOG_LOGIC("FIFO: Poped Pakcet from Cache " << this << ", leave number is " << m_cacheNumber
-                                                  << "\t Disc " << discId << " have number packets is " << m_fifoFlows[discId].size());
+    NS_EVENT_TRACE("Cache", "Dequeue", discId, m_cacheNumber, GetDiscCacheNumber(discId));
   }
   else
   {
@@ -418,11 +415,9 @@ Cache::DoDequeue(uint32_t discId)
       for (; fc_itr != fc_tmp.end();)
       {
 
-        NS_LOG_DEBUG("For");
         flowid = fc_itr->first;
         while (m_flows[discId][flowid].size() > 0)
         {
-          NS_LOG_DEBUG("MTRAP");
           item = m_flows[discId][flowid].front();
           m_flows[discId][flowid].pop();
           if (item != 0)
@@ -451,8 +446,7 @@ Cache::DoDequeue(uint32_t discId)
       }
     }
 
-    NS_LOG_LOGIC("Flow: Poped Pakcet from Cache " << this << ", leave number is " << m_cacheNumber
-                                                  << "\t Disc " << discId << " have number packets is " << m_flows[discId].size());
+    NS_EVENT_TRACE("Cache", "Dequeue", discId, m_cacheNumber, GetDiscCacheNumber(discId));
   }
   if(m_enableCacheLog) RecordLog();
   return item;
@@ -515,7 +509,6 @@ Cache::DoDequeue(uint32_t discId, uint32_t flowid)
     {
       while (m_flows[discId][flowid].size() > 0)
       {
-        NS_LOG_DEBUG("MTRAP2");
         item = m_flows[discId][flowid].front();
         m_flows[discId][flowid].pop();
         if (item != 0)
@@ -536,8 +529,7 @@ Cache::DoDequeue(uint32_t discId, uint32_t flowid)
         m_dequeueIte.erase(discId);
     }
   }
-  NS_LOG_LOGIC("Poped Pakcet from Cache " << this << ", leave number is " << m_cacheNumber
-                                          << "\n\t Disc " << discId << " have number packets is " << m_flows[discId].size());
+  NS_EVENT_TRACE("Cache", "DequeueFlow", discId, flowid, m_cacheNumber, GetDiscCacheNumber(discId));
   if(m_enableCacheLog) RecordLog();
   return item;
 }
@@ -565,7 +557,7 @@ Cache::DoPeek(uint32_t discId, uint32_t flowid)
     }
   }
   NS_LOG_LOGIC("Poped Pakcet from Cache " << this << ", leave number is " << m_cacheNumber
-                                          << "\n\t Disc " << discId << " have number packets is " << m_flows[discId].size());
+                                          << "\n\t Disc " << discId << " have number packets is " << GetDiscCacheNumber(discId));
   return item;
 }
 
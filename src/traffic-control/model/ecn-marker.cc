@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ecn-marker.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EcnMarker");
+
+NS_OBJECT_ENSURE_REGISTERED (EcnMarker);
+
+TypeId
+EcnMarker::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::EcnMarker")
+    .SetParent<Object> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<EcnMarker> ()
+    .AddAttribute ("Mode",
+                   "Whether the band thresholds are in packets or bytes",
+                   EnumValue (Queue::QUEUE_MODE_PACKETS),
+                   MakeEnumAccessor (&EcnMarker::m_mode),
+                   MakeEnumChecker (Queue::QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                                    Queue::QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+    .AddAttribute ("MarkOnDequeue",
+                   "Mark on the sojourn time of the packets at dequeue instead of the band occupancy at enqueue",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&EcnMarker::m_markOnDequeue),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SojournThreshold",
+                   "Packets queued for longer than this are marked at dequeue",
+                   TimeValue (MicroSeconds (80)),
+                   MakeTimeAccessor (&EcnMarker::m_sojournThreshold),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+EcnMarker::EcnMarker ()
+  : m_mode (Queue::QUEUE_MODE_PACKETS),
+    m_markOnDequeue (false),
+    m_sojournThreshold (MicroSeconds (80))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EcnMarker::~EcnMarker ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+EcnMarker::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_discs.size (); i++)
+    {
+      if (m_discs[i])
+        {
+          m_discs[i]->TraceDisconnectWithoutContext (m_mode == Queue::QUEUE_MODE_BYTES ? "BytesInQueue" : "PacketsInQueue",
+                                                     m_callbacks[i]);
+        }
+    }
+  m_discs.clear ();
+  m_callbacks.clear ();
+  Object::DoDispose ();
+}
+
+void
+EcnMarker::SetNBands (uint32_t nBands)
+{
+  NS_LOG_FUNCTION (this << nBands);
+  NS_ASSERT_MSG (m_discs.empty (), "Cannot change the bands once they are attached");
+  BandThreshold none = { false, 0, 0, 0 };
+  m_thresholds.assign (nBands, none);
+  m_prefix.assign (nBands + 1, 0);
+}
+
+uint32_t
+EcnMarker::GetNBands (void) const
+{
+  return m_thresholds.size ();
+}
+
+void
+EcnMarker::AttachBand (uint32_t band, Ptr<QueueDisc> qd)
+{
+  NS_LOG_FUNCTION (this << band << qd);
+  NS_ASSERT_MSG (band < m_thresholds.size (), "Band out of range");
+  if (m_discs.size () < m_thresholds.size ())
+    {
+      m_discs.resize (m_thresholds.size ());
+      m_callbacks.resize (m_thresholds.size ());
+    }
+  NS_ASSERT_MSG (!m_discs[band], "Band " << band << " is already attached");
+
+  m_discs[band] = qd;
+  m_callbacks[band] = MakeCallback (&EcnMarker::UpdateBand, this).Bind (band);
+  bool bytes = m_mode == Queue::QUEUE_MODE_BYTES;
+  qd->TraceConnectWithoutContext (bytes ? "BytesInQueue" : "PacketsInQueue", m_callbacks[band]);
+  // 接入时队列中已有的包也要计入
+  UpdateBand (band, 0, bytes ? qd->GetNBytes () : qd->GetNPackets ());
+}
+
+void
+EcnMarker::SetBandThreshold (uint32_t band, uint32_t firstBand, uint32_t lastBand, uint32_t threshold)
+{
+  NS_LOG_FUNCTION (this << band << firstBand << lastBand << threshold);
+  NS_ASSERT_MSG (band < m_thresholds.size (), "Band out of range");
+  NS_ASSERT_MSG (firstBand <= lastBand && lastBand <= m_thresholds.size (), "Occupancy range out of range");
+  m_thresholds[band].enabled = true;
+  m_thresholds[band].firstBand = firstBand;
+  m_thresholds[band].lastBand = lastBand;
+  m_thresholds[band].threshold = threshold;
+}
+
+void
+EcnMarker::SetBandThreshold (uint32_t band, uint32_t threshold)
+{
+  SetBandThreshold (band, 0, band + 1, threshold);
+}
+
+void
+EcnMarker::ClearBandThreshold (uint32_t band)
+{
+  NS_LOG_FUNCTION (this << band);
+  NS_ASSERT_MSG (band < m_thresholds.size (), "Band out of range");
+  m_thresholds[band].enabled = false;
+}
+
+uint32_t
+EcnMarker::GetOccupancy (uint32_t firstBand, uint32_t lastBand) const
+{
+  return m_prefix[lastBand] - m_prefix[firstBand];
+}
+
+void
+EcnMarker::UpdateBand (uint32_t band, uint32_t oldValue, uint32_t newValue)
+{
+  // 前缀和按无符号数回绕相加，减少时同样正确
+  uint32_t delta = newValue - oldValue;
+  for (uint32_t i = band + 1; i < m_prefix.size (); i++)
+    {
+      m_prefix[i] += delta;
+    }
+}
+
+bool
+EcnMarker::MarkOnEnqueue (uint32_t band, Ptr<QueueDiscItem> item)
+{
+  if (m_markOnDequeue || band >= m_thresholds.size ())
+    {
+      return false;
+    }
+  const BandThreshold &k = m_thresholds[band];
+  if (k.enabled && GetOccupancy (k.firstBand, k.lastBand) > k.threshold)
+    {
+      NS_LOG_LOGIC ("Marking on enqueue in band " << band);
+      return item->Mark ();
+    }
+  return false;
+}
+
+bool
+EcnMarker::MarkOnDequeue (Ptr<QueueDiscItem> item)
+{
+  if (m_markOnDequeue && Simulator::Now () - item->GetTimeStamp () > m_sojournThreshold)
+    {
+      NS_LOG_LOGIC ("Marking on dequeue after " << Simulator::Now () - item->GetTimeStamp ());
+      return item->Mark ();
+    }
+  return false;
+}
+
+} // namespace ns3
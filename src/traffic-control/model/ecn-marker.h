@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ECN_MARKER_H
+#define ECN_MARKER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/queue.h"
+#include "ns3/callback.h"
+#include "queue-disc.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ * \brief ECN marking stage for the bands of a classful queue disc
+ *
+ * Every band has its own threshold K, compared against the occupancy of a
+ * range of bands: by default the band and every band of higher priority,
+ * i.e. what a packet of the band waits behind, but e.g. the bands sharing
+ * the buffer with a cache band can share one range.  The occupancies are
+ * kept as prefix sums over the bands, updated from the PacketsInQueue or
+ * BytesInQueue trace of the queue disc of each band, so the marking
+ * decision at enqueue is a subtraction and a comparison.
+ *
+ * With MarkOnDequeue the packets are instead marked as they leave, when
+ * their sojourn time exceeds SojournThreshold, as in TCN.  The owner then
+ * has to stamp the items with the enqueue time.
+ */
+class EcnMarker : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  EcnMarker ();
+  virtual ~EcnMarker ();
+
+  /**
+   * \brief Set the number of bands, clearing thresholds and occupancies
+   * \param nBands the number of bands
+   */
+  void SetNBands (uint32_t nBands);
+
+  /**
+   * \returns the number of bands
+   */
+  uint32_t GetNBands (void) const;
+
+  /**
+   * \brief Follow the occupancy of a band
+   *
+   * The queue disc is followed in the unit of the Mode attribute, which
+   * must not change afterwards.
+   *
+   * \param band the band
+   * \param qd the queue disc of the band
+   */
+  void AttachBand (uint32_t band, Ptr<QueueDisc> qd);
+
+  /**
+   * \brief Mark the packets enqueued in a band that find more than
+   *        threshold packets or bytes in bands firstBand..lastBand-1
+   * \param band the band
+   * \param firstBand the first band of the occupancy range
+   * \param lastBand one past the last band of the occupancy range
+   * \param threshold the marking threshold K
+   */
+  void SetBandThreshold (uint32_t band, uint32_t firstBand, uint32_t lastBand, uint32_t threshold);
+
+  /**
+   * \brief Mark the packets enqueued in a band that find more than
+   *        threshold packets or bytes in the band and the bands before it
+   * \param band the band
+   * \param threshold the marking threshold K
+   */
+  void SetBandThreshold (uint32_t band, uint32_t threshold);
+
+  /**
+   * \brief Never mark the packets enqueued in a band
+   * \param band the band
+   */
+  void ClearBandThreshold (uint32_t band);
+
+  /**
+   * \param firstBand the first band of the range
+   * \param lastBand one past the last band of the range
+   * \returns the packets or bytes queued in the range
+   */
+  uint32_t GetOccupancy (uint32_t firstBand, uint32_t lastBand) const;
+
+  /**
+   * \brief Marking decision for a packet about to be enqueued in a band
+   * \param band the band
+   * \param item the packet
+   * \returns true if the packet was marked
+   */
+  bool MarkOnEnqueue (uint32_t band, Ptr<QueueDiscItem> item);
+
+  /**
+   * \brief Marking decision for a packet leaving the queue disc
+   * \param item the packet, stamped with its enqueue time
+   * \returns true if the packet was marked
+   */
+  bool MarkOnDequeue (Ptr<QueueDiscItem> item);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Follow a change of the occupancy of a band
+   * \param band the band
+   * \param oldValue the previous occupancy
+   * \param newValue the new occupancy
+   */
+  void UpdateBand (uint32_t band, uint32_t oldValue, uint32_t newValue);
+
+  /**
+   * \brief Marking threshold of a band
+   */
+  struct BandThreshold
+  {
+    bool enabled;       //!< Whether the band is marked at all
+    uint32_t firstBand; //!< First band of the occupancy range
+    uint32_t lastBand;  //!< One past the last band of the occupancy range
+    uint32_t threshold; //!< Marking threshold K
+  };
+
+  Queue::QueueMode m_mode;                 //!< Unit of the occupancies
+  bool m_markOnDequeue;                    //!< Mark on sojourn time at dequeue
+  Time m_sojournThreshold;                 //!< Sojourn time marking threshold
+  std::vector<BandThreshold> m_thresholds; //!< Marking threshold of each band
+  std::vector<uint32_t> m_prefix;          //!< m_prefix[i] is the occupancy of bands 0..i-1
+  std::vector<Ptr<QueueDisc> > m_discs;    //!< Queue disc followed for each band
+  std::vector<Callback<void, uint32_t, uint32_t> > m_callbacks; //!< Trace sinks of the bands
+};
+
+} // namespace ns3
+
+#endif /* ECN_MARKER_H */
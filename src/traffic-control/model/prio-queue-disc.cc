@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/event-trace.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
 #include "ns3/socket.h"
@@ -26,8 +27,6 @@
 #include "ns3/prio-queue-disc-filter.h"
 #include <algorithm>
 #include <iterator>
-#include "ns3/ipv4-header.h"
-#include "ns3/ipv4-queue-disc-item.h"
 #include "prio-subqueue-disc.h"
 
 //#include "ns3/cache.h"
@@ -126,7 +125,27 @@ TypeId PrioQueueDisc::GetTypeId(void)
                           .AddAttribute("MarkCacheThre", "Cache Band",
                                         UintegerValue(240),
                                         MakeUintegerAccessor(&PrioQueueDisc::m_markCacheThre),
-                                        MakeUintegerChecker<uint32_t>());
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MarkBandThre",
+                                        "ECN marking threshold K, in Mode units, on the shared occupancy of the bands before CacheBand",
+                                        UintegerValue(65),
+                                        MakeUintegerAccessor(&PrioQueueDisc::m_markBandThre),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MarkCacheBandThre",
+                                        "ECN marking threshold K, in Mode units, on the occupancy of CacheBand",
+                                        UintegerValue(150),
+                                        MakeUintegerAccessor(&PrioQueueDisc::m_markCacheBandThre),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MarkOnDequeue",
+                                        "Mark packets whose sojourn time exceeds MarkSojournThre at dequeue, instead of on the band occupancy at enqueue",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&PrioQueueDisc::m_markOnDequeue),
+                                        MakeBooleanChecker())
+                          .AddAttribute("MarkSojournThre",
+                                        "Sojourn time marking threshold of MarkOnDequeue",
+                                        TimeValue(MicroSeconds(80)),
+                                        MakeTimeAccessor(&PrioQueueDisc::m_markSojournThre),
+                                        MakeTimeChecker());
   return tid;
 }
 
@@ -141,6 +160,10 @@ PrioQueueDisc::PrioQueueDisc()
       m_cacheThre(0.7),
       m_alertThre(0.5),
       m_uncacheThre(0.3),
+      m_markBandThre(65),
+      m_markCacheBandThre(150),
+      m_markOnDequeue(false),
+      m_markSojournThre(MicroSeconds(80)),
       m_scheduler(0)
 {
   NS_LOG_FUNCTION(this);
@@ -151,6 +174,17 @@ PrioQueueDisc::~PrioQueueDisc()
   NS_LOG_FUNCTION(this);
 }
 
+void PrioQueueDisc::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  if (m_marker)
+  {
+    m_marker->Dispose();
+    m_marker = 0;
+  }
+  QueueDisc::DoDispose();
+}
+
 void PrioQueueDisc::SetBandForPriority(uint8_t prio, uint16_t band)
 {
   NS_LOG_FUNCTION(this << prio << band);
@@ -216,17 +250,13 @@ bool PrioQueueDisc::DoEnqueue(uint32_t band, Ptr<QueueDiscItem> item)
     if (GetDiscClassSize(m_cacheBand) > 0)
     {
       Ptr<QueueDiscItem> ite = DoDequeue(m_cacheBand);
-      uint32_t num = GetNPackets();
-      if (num <= 0)
-        printf("Drop 1, Pkt num %d\n", num);
+      NS_EVENT_TRACE("PrioQueueDisc", "Drop", m_discId, 1, GetNPackets());
       Drop(ite);
     }
     else
     {
       NS_LOG_LOGIC("Queue disc limit exceeded -- dropping packet");
-      uint32_t num = GetNPackets();
-      if (num <= 0)
-        printf("Drop 2, Pkt num %d\n", num);
+      NS_EVENT_TRACE("PrioQueueDisc", "Drop", m_discId, 2, GetNPackets());
       Drop(item);
       return false;
     }
@@ -279,7 +309,7 @@ void PrioQueueDisc::CachePacket()
     }
     else
     {
-      printf("ERROR:1\n\n\n");
+      NS_LOG_ERROR("Band " << m_cacheBand << " is not empty but nothing was dequeued to cache");
       m_cache->SetWriteSignal(false);
     }
   }
@@ -310,7 +340,7 @@ void PrioQueueDisc::UnCachePacket()
     }
     else
     {
-      printf("ERROR:2\n\n");
+      NS_LOG_ERROR("The cache of disc " << m_discId << " is not empty but nothing was read back");
       m_cache->SetReadSignal(false);
     }
   }
@@ -336,7 +366,7 @@ void PrioQueueDisc::UrgeCachePacket(uint32_t flowid, uint32_t urgeNum)
     }
     else
     {
-      printf("Item from Cache 1 is NULL\n\n\n");
+      NS_LOG_ERROR("The cache holds packets of flow " << flowid << " but nothing was read back");
       m_cache->SetReadSignal(false);
     }
   }
@@ -386,7 +416,7 @@ bool PrioQueueDisc::CheckEncache()
     }
     else
     {
-      printf("ERROR:4\n\n");
+      NS_LOG_ERROR("Band " << m_cacheBand << " is not empty but has no packet to cache");
       return false;
     }
   }
@@ -409,7 +439,7 @@ bool PrioQueueDisc::CheckDecache()
     }
     else
     {
-      printf("ERROR:5\n\n");
+      NS_LOG_ERROR("The cache of disc " << m_discId << " is not empty but has no packet to read back");
       return false;
     }
   }
@@ -436,7 +466,7 @@ bool PrioQueueDisc::CheckUrge()
         }
         else
         {
-          printf("ERROR:6\n\n");
+          NS_LOG_ERROR("The cache holds packets of flow " << *ite << " but has none to urge");
         }
       }
     }
@@ -449,7 +479,7 @@ bool PrioQueueDisc::CheckUrge()
 bool PrioQueueDisc::CacheIdle(Cache::Operation operation)
 {
   NS_LOG_FUNCTION(this);
-  std::cout << "CacheIdle is trigger" << std::endl;
+  NS_EVENT_TRACE("PrioQueueDisc", "CacheIdle", m_discId, operation);
   if (operation == Cache::WRITE)
     return CheckEncache();
   else if (operation == Cache::READ)
@@ -475,7 +505,7 @@ bool PrioQueueDisc::CheckEncache2()
     }
     else
     {
-      printf("ERROR:4\n\n");
+      NS_LOG_ERROR("Band " << m_cacheBand + 1 << " is not empty but has no packet to cache");
       return false;
     }
   }
@@ -502,7 +532,7 @@ void PrioQueueDisc::CacheNewPacket()
     }
     else
     {
-      printf("ERROR:1\n\n\n");
+      NS_LOG_ERROR("Band " << m_cacheBand + 1 << " is not empty but nothing was dequeued to cache");
       m_cache->SetWriteSignal(false);
     }
   }
@@ -540,8 +570,7 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     }
     else
     {
-      //NS_LOG_DEBUG(
-      printf("Illegal band %d, use the default band 0\n",ret);
+      NS_LOG_WARN("Illegal band " << ret << ", using the default band 0");
     }
   }
 
@@ -574,7 +603,7 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
         //NS_LOG_DEBUG(
         //std::cout<<"Urge Packet\n";
         uint32_t flowid = flowIdTag.GetFlowId();
-        std::cout << "Found Urge Packet! " << flowIdTag.GetFlowId() << ' ' << m_cache->GetFlowCacheNumber(m_discId, flowid) << '\n';
+        NS_EVENT_TRACE("PrioQueueDisc", "UrgePacket", m_discId, flowid, m_cache->GetFlowCacheNumber(m_discId, flowid));
         if (m_cache->GetFlowCacheNumber(m_discId, flowid) > 0)
         {
           if (m_UrgeEvent.IsExpired() && m_cache->IsIdleNow(Cache::URGE, m_discId)) //必须这个顺序
@@ -588,7 +617,7 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
             }
             else
             {
-              printf("ERROR:6\n\n");
+              NS_LOG_ERROR("The cache holds packets of flow " << flowid << " but has none to urge");
             }
           }
           else
@@ -600,54 +629,9 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     }
   } //*/
 
-  if (m_EnableMarking)
+  if (m_marker)
   {
-    //std::cout<<"Mark Thre is:" <<m_markingThre<<'\n';
-    if (m_cache->GetLocation() == 0)
-    {
-      if (OverThre(m_markingThre))
-      {
-        Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem>(item);
-        Ipv4Header header;
-        if (ipv4Item)
-        {
-          header = ipv4Item->GetHeader();
-          //NS_LOG_DEBUG("\t Header: " << header);
-        }
-        //NS_LOG_DEBUG("\t Dropping\\Marking due to Hard Mark ");
-        if (ipv4Item && header.GetEcn() == Ipv4Header::ECN_ECT1)
-        {
-          //NS_LOG_DEBUG("\t Marking CE Due to DTYPE_FORCED");
-          header.SetEcn(Ipv4Header::ECN_CE);
-          ipv4Item->SetHeader(header);
-          //if ((rand() % 100) < 10)
-          //band = m_cacheBand - 2;
-        }
-      }
-    }
-    else
-    {
-      //if ((band == m_cacheBand - 1 && DiscClassOverThre(m_cacheBand - 1, m_markingThre)) || (band == m_cacheBand && m_cache->GetDiscCacheNumber(m_discId) > m_markCacheThre))
-      if ((band < m_cacheBand  && GetDiscClassSizeSum(0,m_cacheBand) > 65) || (band == m_cacheBand && GetDiscClassSize(m_cacheBand)>150))
-      {
-        Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem>(item);
-        Ipv4Header header;
-        if (ipv4Item)
-        {
-          header = ipv4Item->GetHeader();
-          //NS_LOG_DEBUG("\t Header: " << header);
-        }
-        //NS_LOG_DEBUG("\t Dropping\\Marking due to Hard Mark ");
-        if (ipv4Item && header.GetEcn() == Ipv4Header::ECN_ECT1)
-        {
-          //NS_LOG_DEBUG("\t Marking CE Due to DTYPE_FORCED");
-          header.SetEcn(Ipv4Header::ECN_CE);
-          ipv4Item->SetHeader(header);
-          //if ((rand() % 100) < 10)
-          //band = m_cacheBand - 2;
-        }
-      }
-    }
+    m_marker->MarkOnEnqueue(band, item);
   }
 
   if (OverThre(1.0))
@@ -655,17 +639,13 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     if (band < m_cacheBand && GetDiscClassSize(m_cacheBand) > 0)
     {
       Ptr<QueueDiscItem> ite = DoDequeue(m_cacheBand);
-      uint32_t num = GetNPackets();
-      if (num <= 0)
-        printf("Drop 3, Pkt num %d\n", num);
+      NS_EVENT_TRACE("PrioQueueDisc", "Drop", m_discId, 3, GetNPackets());
       Drop(ite); //Not use DequeuePktCache, Drop will decrease
     }
     else
     {
       NS_LOG_LOGIC("Queue disc limit exceeded -- dropping packet");
-      uint32_t num = GetNPackets();
-      if (num <= 0)
-        printf("Drop 4, Pkt num %d\n", num);
+      NS_EVENT_TRACE("PrioQueueDisc", "Drop", m_discId, 4, GetNPackets());
       Drop(item);
       return false;
     }
@@ -674,6 +654,7 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
   /**************************************add by myself***************************/
 
   NS_ASSERT_MSG(band < GetNQueueDiscClasses(), "Selected band out of range");
+  item->SetTimeStamp(Simulator::Now());
   bool retval = GetQueueDiscClass(band)->GetQueueDisc()->Enqueue(item);
   if (m_EnableCache && m_cache->GetLocation())
   {
@@ -681,7 +662,7 @@ bool PrioQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
       CheckEncache2();
   }
 
-  NS_LOG_LOGIC("RTORank[" << band << "] has " << GetDiscClassSize(band) << " packets!");
+  NS_EVENT_TRACE("PrioQueueDisc", "Enqueue", m_discId, band, GetDiscClassSize(band), retval);
 
   return retval;
 }
@@ -704,8 +685,11 @@ PrioQueueDisc::DoDequeue(void)
   {
     if ((item = GetQueueDiscClass(i)->GetQueueDisc()->Dequeue()) != 0)
     {
-      NS_LOG_LOGIC("Popped from band " << i << ": " << item);
-      NS_LOG_LOGIC("Number packets band " << i << ": " << GetDiscClassSize(i));
+      NS_EVENT_TRACE("PrioQueueDisc", "Dequeue", m_discId, i, GetDiscClassSize(i));
+      if (m_marker)
+      {
+        m_marker->MarkOnDequeue(item);
+      }
       return item;
     }
   }
@@ -774,6 +758,53 @@ bool PrioQueueDisc::CheckConfig(void)
 void PrioQueueDisc::InitializeParams(void)
 {
   NS_LOG_FUNCTION(this);
+  if (!m_EnableMarking)
+  {
+    return;
+  }
+
+  uint32_t nBands = GetNQueueDiscClasses();
+  m_marker = CreateObject<EcnMarker>();
+  m_marker->SetAttribute("Mode", EnumValue(m_mode));
+  m_marker->SetAttribute("MarkOnDequeue", BooleanValue(m_markOnDequeue));
+  m_marker->SetAttribute("SojournThreshold", TimeValue(m_markSojournThre));
+  m_marker->SetNBands(nBands);
+  for (uint32_t i = 0; i < nBands; i++)
+  {
+    m_marker->AttachBand(i, GetQueueDiscClass(i)->GetQueueDisc());
+  }
+  SetMarkThresholds();
+}
+
+void PrioQueueDisc::SetMarkThresholds(void)
+{
+  NS_LOG_FUNCTION(this);
+  uint32_t nBands = m_marker->GetNBands();
+  if (!m_cache || m_cache->GetLocation())
+  {
+    //缓存带之前的各带共享一个阀值，缓存带单独一个阀值，缓存带之后的带不标记
+    for (uint32_t i = 0; i < nBands && i < m_cacheBand; i++)
+    {
+      m_marker->SetBandThreshold(i, 0, m_cacheBand, m_markBandThre);
+    }
+    if (m_cacheBand < nBands)
+    {
+      m_marker->SetBandThreshold(m_cacheBand, m_cacheBand, m_cacheBand + 1, m_markCacheBandThre);
+    }
+    for (uint32_t i = m_cacheBand + 1; i < nBands; i++)
+    {
+      m_marker->ClearBandThreshold(i);
+    }
+  }
+  else
+  {
+    //位置为0的缓存按整个队列的占用标记
+    uint32_t limit = m_mode == Queue::QUEUE_MODE_PACKETS ? m_PktsLimit : m_BytesLimit;
+    for (uint32_t i = 0; i < nBands; i++)
+    {
+      m_marker->SetBandThreshold(i, 0, nBands, limit * m_markingThre);
+    }
+  }
 }
 
 /******************************************************************/
@@ -781,6 +812,11 @@ void PrioQueueDisc::SetCache(Ptr<Cache> cache)
 {
   NS_LOG_FUNCTION(this);
   m_cache = cache;
+  //缓存可能在初始化之后才设置，标记阀值随缓存位置而定
+  if (m_marker)
+  {
+    SetMarkThresholds();
+  }
 }
 
 void PrioQueueDisc::SetDiscId(uint32_t id)
@@ -26,6 +26,7 @@
 #include <array>
 
 #include "ns3/cache.h" //add by myself
+#include "ecn-marker.h"
 
 namespace ns3
 {
@@ -113,12 +114,19 @@ public:
   //void SetName(StringValue name);
 
   /******************************************************************************/
+protected:
+  virtual void DoDispose(void);
+
 private:
   virtual bool DoEnqueue(Ptr<QueueDiscItem> item);
   virtual Ptr<QueueDiscItem> DoDequeue(void);
   virtual Ptr<const QueueDiscItem> DoPeek(void) const;
   virtual bool CheckConfig(void);
   virtual void InitializeParams(void);
+  /**
+   * Set the ECN marking thresholds of the bands, which depend on the cache
+   */
+  void SetMarkThresholds(void);
 
   Priomap m_prio2band; //!< Priority to band mapping
 
@@ -144,6 +152,11 @@ private:
   double m_uncacheThre;
   double m_markingThre;
   uint32_t m_markCacheThre;
+  uint32_t m_markBandThre;      //缓存带之前的各带共享的ECN标记阀值
+  uint32_t m_markCacheBandThre; //缓存带的ECN标记阀值
+  bool m_markOnDequeue;         //按出队时的逗留时间标记
+  Time m_markSojournThre;       //逗留时间标记阀值
+  Ptr<EcnMarker> m_marker;
   uint32_t m_scheduler;
   /************************************************************/
 };
@@ -43,11 +43,17 @@ TypeId PrioSubqueueDisc::GetTypeId(void)
                                         "The maximum number of packets accepted by this queue disc.",
                                         UintegerValue(1000),
                                         MakeUintegerAccessor(&PrioSubqueueDisc::m_limit),
-                                        MakeUintegerChecker<uint32_t>());
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("Bands",
+                                        "The number of size rank sub-bands; ranks beyond the last band go to the last band.",
+                                        UintegerValue(8),
+                                        MakeUintegerAccessor(&PrioSubqueueDisc::m_bands),
+                                        MakeUintegerChecker<uint32_t>(1));
   return tid;
 }
 
 PrioSubqueueDisc::PrioSubqueueDisc()
+    : m_bands(8)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -77,11 +83,16 @@ bool PrioSubqueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
     band = 0;
     // NS_LOG_DEBUG ("The filter was unable to classify; using default band of " << band);
   }
-  else if (ret < 0 || ret > 8)
+  else if (ret < 0)
   {
     band = 0;
     //  NS_LOG_DEBUG ("The filter returned an invalid value; using default band of " << band);
   }
+  else if (static_cast<uint32_t>(ret) >= m_bands)
+  {
+    //超出子队列数的size rank进入最低优先级的子队列
+    band = m_bands - 1;
+  }
   else
   {
     band = ret;
@@ -186,21 +197,21 @@ bool PrioSubqueueDisc::CheckConfig(void)
     factory.SetTypeId("ns3::DropTailQueue");
     factory.Set("Mode", EnumValue(Queue::QUEUE_MODE_PACKETS));
     factory.Set("MaxPackets", UintegerValue(m_limit));
-    for (int i = 0; i < 8; i++)
+    for (uint32_t i = 0; i < m_bands; i++)
       AddInternalQueue(factory.Create<Queue>());
   }
 
-  if (GetNInternalQueues() != 8)
+  if (GetNInternalQueues() != m_bands)
   {
-    NS_LOG_ERROR("PrioSubqueueDisc needs 8 internal queues");
+    NS_LOG_ERROR("PrioSubqueueDisc needs " << m_bands << " internal queues");
     return false;
   }
 
-  for (uint8_t i = 0; i < 8; i++)
+  for (uint32_t i = 0; i < m_bands; i++)
   {
     if (GetInternalQueue(i)->GetMode() != Queue::QUEUE_MODE_PACKETS)
     {
-      NS_LOG_ERROR("PrioSubqueueDisc needs 8 internal queues operating in packet mode");
+      NS_LOG_ERROR("PrioSubqueueDisc needs " << m_bands << " internal queues operating in packet mode");
       return false;
     }
     if (GetInternalQueue(i)->GetMaxPackets() < m_limit)
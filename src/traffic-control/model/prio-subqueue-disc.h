@@ -81,6 +81,7 @@ private:
   virtual void InitializeParams (void);
 
   uint32_t m_limit;    //!< Maximum number of packets that can be stored
+  uint32_t m_bands;    //!< Number of size rank sub-bands
 };
 
 } // namespace ns3
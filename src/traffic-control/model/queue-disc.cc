@@ -25,6 +25,7 @@
 #include "ns3/packet.h"
 #include "ns3/unused.h"
 #include "queue-disc.h"
+#include <algorithm>
 
 namespace ns3
 {
@@ -67,6 +68,21 @@ void QueueDiscItem::SetTxQueueIndex(uint8_t txq)
   m_txq = txq;
 }
 
+Time QueueDiscItem::GetTimeStamp(void) const
+{
+  return m_tstamp;
+}
+
+void QueueDiscItem::SetTimeStamp(Time t)
+{
+  m_tstamp = t;
+}
+
+bool QueueDiscItem::Mark(void)
+{
+  return false;
+}
+
 void QueueDiscItem::Print(std::ostream &os) const
 {
   os << GetPacket() << " "
@@ -465,6 +481,13 @@ void QueueDisc::Run(void)
   if (RunBegin())
   {
     uint32_t quota = m_quota;
+    // 设备支持突发时一次取出多个包，整体交给设备
+    if (m_device->SupportsTxBurst() && m_devQueueIface->GetTxQueuesN() == 1)
+    {
+      TransmitBurst(std::min(quota, m_device->GetTxBurstRoom()));
+      RunEnd();
+      return;
+    }
     while (Restart())
     {
       quota -= 1;
@@ -599,4 +622,44 @@ bool QueueDisc::Transmit(Ptr<QueueDiscItem> item)
   return ret;
 }
 
+bool QueueDisc::TransmitBurst(uint32_t maxPackets)
+{
+  NS_LOG_FUNCTION(this << maxPackets);
+  NS_ASSERT(m_devQueueIface);
+
+  std::vector<Ptr<QueueDiscItem> > items;
+  std::vector<NetDevice::TxBurstPacket> burst;
+  while (items.size() < maxPackets)
+  {
+    Ptr<QueueDiscItem> item = DequeuePacket();
+    if (item == 0)
+    {
+      break;
+    }
+    // send a copy of the packet because the device might add the
+    // MAC header even if the transmission is unsuccessful (see BUG 2284)
+    NetDevice::TxBurstPacket packet = {item->GetPacket()->Copy(), item->GetAddress(), item->GetProtocol()};
+    items.push_back(item);
+    burst.push_back(packet);
+  }
+
+  if (items.empty())
+  {
+    NS_LOG_LOGIC("No packet to send");
+    return false;
+  }
+
+  uint32_t sent = m_device->SendBurst(burst);
+  NS_LOG_LOGIC("Sent " << sent << " of a burst of " << items.size() << " packets");
+  if (sent < items.size())
+  {
+    // only one packet can wait to be requeued
+    NS_ABORT_MSG_IF(sent + 1 < items.size(), "The device refused more than the last packet of a burst");
+    Requeue(items[sent]);
+    return false;
+  }
+
+  return !m_devQueueIface->GetTxQueue(0)->IsStopped();
+}
+
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include <vector>
 #include "packet-filter.h"
 #include "ns3/timer.h"
+#include "ns3/nstime.h"
 
 //#include "ns3/cache.h"
 
@@ -80,6 +81,28 @@ public:
    */
   void SetTxQueueIndex (uint8_t txq);
 
+  /**
+   * \brief Get the time the item was enqueued in the queue disc
+   * \return the enqueue time stored in this item.
+   */
+  Time GetTimeStamp (void) const;
+
+  /**
+   * \brief Set the time the item was enqueued in the queue disc
+   * \param t the enqueue time to store in this item.
+   */
+  void SetTimeStamp (Time t);
+
+  /**
+   * \brief Mark the packet as having experienced congestion, in place
+   *
+   * Subclasses that know the header of the packet set its ECN field to CE.
+   * The default implementation marks nothing.
+   *
+   * \return true if the packet is ECN capable and now carries the mark.
+   */
+  virtual bool Mark (void);
+
   /**
    * \brief Add the header to the packet
    *
@@ -119,6 +142,7 @@ private:
   Address m_address;      //!< MAC destination address
   uint16_t m_protocol;    //!< L3 Protocol number
   uint8_t m_txq;          //!< Transmission queue index
+  Time m_tstamp;          //!< Enqueue time
 };
 
 
@@ -337,7 +361,8 @@ public:
   /**
    * Modelled after the Linux function __qdisc_run (net/sched/sch_generic.c)
    * Dequeues multiple packets, until a quota is exceeded or sending a packet
-   * to the device failed.
+   * to the device failed.  If the device supports bursts, the packets are
+   * dequeued up to the room of the device and sent in a single burst.
    */
   void Run (void);
 
@@ -537,6 +562,17 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> p);
 
+  /**
+   * Modelled after the bulk dequeue of Linux (try_bulk_dequeue_skb in
+   * net/sched/sch_generic.c) followed by sch_direct_xmit with xmit_more.
+   * Dequeues up to maxPackets packets and sends them to the device in a
+   * single burst.  The device must accept at least all the packets but the
+   * last, which is requeued if the device refuses it.
+   * \param maxPackets the maximum number of packets of the burst
+   * \return true if the whole burst was sent and the queue is not stopped
+   */
+  bool TransmitBurst (uint32_t maxPackets);
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
 
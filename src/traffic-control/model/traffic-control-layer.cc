@@ -19,9 +19,11 @@
 
 #include "traffic-control-layer.h"
 #include "ns3/log.h"
+#include "ns3/event-trace.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
 #include "ns3/queue-disc.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -63,7 +65,7 @@ TrafficControlLayer::DoDispose (void)
   m_node = 0;
   m_rootQueueDiscs.clear ();
   m_handlers.clear ();
-  m_netDeviceQueueToQueueDiscMap.clear ();
+  m_netDevices.clear ();
   Object::DoDispose ();
 }
 
@@ -81,9 +83,8 @@ TrafficControlLayer::DoInitialize (void)
           // ensure that the device has completed initialization
           device->Initialize ();
 
-          std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator qdMap = m_netDeviceQueueToQueueDiscMap.find (device);
-          NS_ASSERT (qdMap != m_netDeviceQueueToQueueDiscMap.end ());
-          Ptr<NetDeviceQueueInterface> devQueueIface = qdMap->second.first;
+          NetDeviceInfo &info = GetNetDeviceInfo (device);
+          Ptr<NetDeviceQueueInterface> devQueueIface = info.devQueueIface;
           NS_ASSERT (devQueueIface);
 
           devQueueIface->SetQueueDiscInstalled (true);
@@ -94,7 +95,7 @@ TrafficControlLayer::DoInitialize (void)
               for (uint32_t i = 0; i < devQueueIface->GetTxQueuesN (); i++)
                 {
                   devQueueIface->GetTxQueue (i)->SetWakeCallback (MakeCallback (&QueueDisc::Run, m_rootQueueDiscs[j]));
-                  qdMap->second.second.push_back (m_rootQueueDiscs[j]);
+                  info.queueDiscs.push_back (m_rootQueueDiscs[j]);
                 }
             }
           else if (m_rootQueueDiscs[j]->GetWakeMode () == QueueDisc::WAKE_CHILD)
@@ -105,7 +106,7 @@ TrafficControlLayer::DoInitialize (void)
                 {
                   devQueueIface->GetTxQueue (i)->SetWakeCallback (MakeCallback (&QueueDisc::Run,
                                                                   m_rootQueueDiscs[j]->GetQueueDiscClass (i)->GetQueueDisc ()));
-                  qdMap->second.second.push_back (m_rootQueueDiscs[j]->GetQueueDiscClass (i)->GetQueueDisc ());
+                  info.queueDiscs.push_back (m_rootQueueDiscs[j]->GetQueueDiscClass (i)->GetQueueDisc ());
                 }
             }
 
@@ -113,6 +114,17 @@ TrafficControlLayer::DoInitialize (void)
           m_rootQueueDiscs[j]->Initialize ();
         }
     }
+
+  // the number of transmission queues is settled once the devices are
+  // initialized, so devices with a single queue can skip queue selection
+  for (std::vector<NetDeviceInfo>::iterator it = m_netDevices.begin (); it != m_netDevices.end (); ++it)
+    {
+      if (it->device)
+        {
+          it->device->Initialize ();
+          it->singleQueue = it->devQueueIface->GetTxQueuesN () == 1;
+        }
+    }
   Object::DoInitialize ();
 }
 
@@ -133,10 +145,18 @@ TrafficControlLayer::SetupDevice (Ptr<NetDevice> device)
   device->AggregateObject (devQueueIface);
 
   // store a pointer to the created queue interface
-  NS_ASSERT_MSG (m_netDeviceQueueToQueueDiscMap.find (device) == m_netDeviceQueueToQueueDiscMap.end (),
+  uint32_t index = device->GetIfIndex ();
+  if (index >= m_netDevices.size ())
+    {
+      m_netDevices.resize (index + 1);
+    }
+  NS_ASSERT_MSG (m_netDevices[index].device == 0,
                  "This is a bug: SetupDevice should be called only once per device");
 
-  m_netDeviceQueueToQueueDiscMap[device] = NetDeviceInfo (devQueueIface, QueueDiscVector ());
+  NetDeviceInfo &info = m_netDevices[index];
+  info.device = device;
+  info.devQueueIface = devQueueIface;
+  info.singleQueue = false;
 }
 
 void
@@ -235,9 +255,21 @@ uint32_t
 TrafficControlLayer::GetDeviceIndex (Ptr<NetDevice> device)
 {
   NS_LOG_FUNCTION (this << device);
-  uint32_t i;
-  for (i = 0; i < m_node->GetNDevices () && device != m_node->GetDevice (i); i++);
-  return i;
+  uint32_t i = device->GetIfIndex ();
+  if (i < m_node->GetNDevices () && device == m_node->GetDevice (i))
+    {
+      return i;
+    }
+  return m_node->GetNDevices ();
+}
+
+TrafficControlLayer::NetDeviceInfo &
+TrafficControlLayer::GetNetDeviceInfo (Ptr<NetDevice> device)
+{
+  uint32_t index = device->GetIfIndex ();
+  NS_ASSERT_MSG (index < m_netDevices.size () && m_netDevices[index].device == device,
+                 "Device " << device << " has not been set up");
+  return m_netDevices[index];
 }
 
 void
@@ -274,43 +306,73 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
     }
 }
 
-void
-TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
+Ptr<QueueDisc>
+TrafficControlLayer::Enqueue (const NetDeviceInfo &info, Ptr<QueueDiscItem> item)
 {
-  NS_LOG_FUNCTION (this << device << item);
+  NS_EVENT_TRACE ("TrafficControlLayer", "Send", info.device->GetIfIndex (), item->GetProtocol (),
+                  item->GetPacket ()->GetUid (), item->GetPacket ()->GetSize ());
 
-  NS_LOG_DEBUG ("Send packet to device " << device << " protocol number " <<
-               item->GetProtocol ()<<" packet uid " <<item->GetPacket()->GetUid()<<" packet size "<<item->GetPacket()->GetSize());
-
-  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator qdMap = m_netDeviceQueueToQueueDiscMap.find (device);
-  NS_ASSERT (qdMap != m_netDeviceQueueToQueueDiscMap.end ());
-  Ptr<NetDeviceQueueInterface> devQueueIface = qdMap->second.first;
+  Ptr<NetDeviceQueueInterface> devQueueIface = info.devQueueIface;
   NS_ASSERT (devQueueIface);
 
   // determine the transmission queue of the device where the packet will be enqueued
-  uint8_t txq = devQueueIface->GetSelectedQueue (item);
+  uint8_t txq = info.singleQueue ? 0 : devQueueIface->GetSelectedQueue (item);
   NS_ASSERT (txq < devQueueIface->GetTxQueuesN ());
 
-  if (qdMap->second.second.empty ())
+  if (info.queueDiscs.empty ())
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
       if (!devQueueIface->GetTxQueue (txq)->IsStopped ())
         {
           item->AddHeader ();
-          device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+          info.device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
         }
+      return 0;
     }
-  else
+
+  // Enqueue the packet in the queue disc associated with the netdevice queue
+  // selected for the packet
+  item->SetTxQueueIndex (txq);
+  Ptr<QueueDisc> qDisc = info.queueDiscs[txq];
+  NS_ASSERT (qDisc);
+  qDisc->Enqueue (item);
+  return qDisc;
+}
+
+void
+TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << device << item);
+
+  // try to dequeue packets from the queue disc the packet was enqueued in
+  Ptr<QueueDisc> qDisc = Enqueue (GetNetDeviceInfo (device), item);
+  if (qDisc)
     {
-      // Enqueue the packet in the queue disc associated with the netdevice queue
-      // selected for the packet and try to dequeue packets from such queue disc
-      item->SetTxQueueIndex (txq);
-      Ptr<QueueDisc> qDisc = qdMap->second.second[txq];
-      NS_ASSERT (qDisc);
-      qDisc->Enqueue (item);
       qDisc->Run ();
     }
 }
 
+void
+TrafficControlLayer::SendMany (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << device << items.size ());
+
+  const NetDeviceInfo &info = GetNetDeviceInfo (device);
+  // run every queue disc that got packets once, after the whole burst is enqueued
+  QueueDiscVector toRun;
+  for (std::vector<Ptr<QueueDiscItem> >::const_iterator it = items.begin (); it != items.end (); ++it)
+    {
+      Ptr<QueueDisc> qDisc = Enqueue (info, *it);
+      if (qDisc && std::find (toRun.begin (), toRun.end (), qDisc) == toRun.end ())
+        {
+          toRun.push_back (qDisc);
+        }
+    }
+  for (QueueDiscVector::iterator it = toRun.begin (); it != toRun.end (); ++it)
+    {
+      (*it)->Run ();
+    }
+}
+
 } // namespace ns3
@@ -24,7 +24,6 @@
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "queue-disc.h"
-#include <map>
 #include <vector>
 
 namespace ns3 {
@@ -187,6 +186,17 @@ public:
    */
   virtual void Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item);
 
+  /**
+   * \brief Called from upper layer to queue a burst of packets for the transmission.
+   *
+   * All the packets are enqueued before the queue discs they were enqueued
+   * in are run, once each, e.g. for the fragments of a packet.
+   *
+   * \param device the device the packets must be sent to
+   * \param items the queue items including the packets, in sending order
+   */
+  virtual void SendMany (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items);
+
 protected:
 
   virtual void DoDispose (void);
@@ -218,8 +228,15 @@ private:
   /// Typedef for protocol handlers container
   typedef std::vector<struct ProtocolHandlerEntry> ProtocolHandlerList;
 
-  /// Typedef for queue disc vector
-  typedef std::pair<Ptr<NetDeviceQueueInterface>, QueueDiscVector> NetDeviceInfo;
+  /**
+   * \brief Information on a device set up by SetupDevice
+   */
+  struct NetDeviceInfo {
+    Ptr<NetDevice> device;                     //!< the NetDevice
+    Ptr<NetDeviceQueueInterface> devQueueIface; //!< the queue interface aggregated to the device
+    QueueDiscVector queueDiscs;                //!< the queue disc of each transmission queue
+    bool singleQueue;                          //!< true if the device has a single transmission queue
+  };
 
   /**
    * \brief Lookup a given Ptr<NetDevice> in the node's list of devices
@@ -229,13 +246,30 @@ private:
    */
   uint32_t GetDeviceIndex (Ptr<NetDevice> device);
 
+  /**
+   * \brief Get the information on a device set up by SetupDevice
+   * \param device the device
+   * \return the information on the device
+   */
+  NetDeviceInfo &GetNetDeviceInfo (Ptr<NetDevice> device);
+
+  /**
+   * \brief Enqueue a packet in the queue disc of its transmission queue, or
+   *        send it to the device if there is no queue disc
+   * \param info the information on the device
+   * \param item the queue item including the packet
+   * \return the queue disc the packet was enqueued in, if any
+   */
+  Ptr<QueueDisc> Enqueue (const NetDeviceInfo &info, Ptr<QueueDiscItem> item);
+
   /// The node this TrafficControlLayer object is aggregated to
   Ptr<Node> m_node;
   /// This vector stores the root queue discs installed on all the devices of the node.
   /// Devices are sorted as in Node::m_devices
   QueueDiscVector m_rootQueueDiscs;
-  /// This map plays the role of the qdisc field of the netdev_queue struct in Linux
-  std::map<Ptr<NetDevice>, NetDeviceInfo> m_netDeviceQueueToQueueDiscMap;
+  /// This vector plays the role of the qdisc field of the netdev_queue struct in Linux.
+  /// Devices are indexed by their interface index, as in Node::m_devices
+  std::vector<NetDeviceInfo> m_netDevices;
   ProtocolHandlerList m_handlers;  //!< List of upper-layer handlers
 };
 
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/ecn-marker.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+class EcnMarkerTestItem : public QueueDiscItem {
+public:
+  EcnMarkerTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~EcnMarkerTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  bool IsMarked (void) const;
+
+private:
+  EcnMarkerTestItem ();
+  EcnMarkerTestItem (const EcnMarkerTestItem &);
+  EcnMarkerTestItem &operator = (const EcnMarkerTestItem &);
+  bool m_marked;
+};
+
+EcnMarkerTestItem::EcnMarkerTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol),
+    m_marked (false)
+{
+}
+
+EcnMarkerTestItem::~EcnMarkerTestItem ()
+{
+}
+
+void
+EcnMarkerTestItem::AddHeader (void)
+{
+}
+
+bool
+EcnMarkerTestItem::Mark (void)
+{
+  m_marked = true;
+  return true;
+}
+
+bool
+EcnMarkerTestItem::IsMarked (void) const
+{
+  return m_marked;
+}
+
+class EcnMarkerTestCase : public TestCase
+{
+public:
+  EcnMarkerTestCase ();
+  virtual void DoRun (void);
+private:
+  void RunOccupancyTest (Queue::QueueMode mode);
+  void RunSojournTest (void);
+  void CheckSojourn (Ptr<EcnMarker> marker, Ptr<EcnMarkerTestItem> item, bool marked);
+  Ptr<EcnMarkerTestItem> MakeItem (uint32_t size);
+};
+
+EcnMarkerTestCase::EcnMarkerTestCase ()
+  : TestCase ("Sanity check on the band thresholds and sojourn marking of EcnMarker")
+{
+}
+
+Ptr<EcnMarkerTestItem>
+EcnMarkerTestCase::MakeItem (uint32_t size)
+{
+  Address dest;
+  return Create<EcnMarkerTestItem> (Create<Packet> (size), dest, 0);
+}
+
+void
+EcnMarkerTestCase::RunOccupancyTest (Queue::QueueMode mode)
+{
+  // 1 for packets; pktSize for bytes
+  uint32_t pktSize = 500;
+  uint32_t modeSize = mode == Queue::QUEUE_MODE_PACKETS ? 1 : pktSize;
+
+  Ptr<EcnMarker> marker = CreateObject<EcnMarker> ();
+  marker->SetAttribute ("Mode", EnumValue (mode));
+  marker->SetNBands (3);
+  std::vector<Ptr<QueueDisc> > bands;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<QueueDisc> qd = CreateObject<FifoQueueDisc> ();
+      qd->Initialize ();
+      bands.push_back (qd);
+    }
+  // a packet already queued is counted when its band is attached
+  bands[1]->Enqueue (MakeItem (pktSize));
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      marker->AttachBand (i, bands[i]);
+    }
+  marker->SetBandThreshold (0, 2 * modeSize);
+  marker->SetBandThreshold (2, 1, 3, 1 * modeSize);
+
+  NS_TEST_EXPECT_MSG_EQ (marker->GetOccupancy (0, 3), 1 * modeSize, "The queued packet should be counted");
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (0, MakeItem (pktSize)), false, "Band 0 is below its threshold");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      bands[0]->Enqueue (MakeItem (pktSize));
+    }
+  NS_TEST_EXPECT_MSG_EQ (marker->GetOccupancy (0, 1), 3 * modeSize, "There should be three packets in band 0");
+  NS_TEST_EXPECT_MSG_EQ (marker->GetOccupancy (0, 3), 4 * modeSize, "There should be four packets in all");
+  Ptr<EcnMarkerTestItem> item = MakeItem (pktSize);
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (0, item), true, "Band 0 is above its threshold");
+  NS_TEST_EXPECT_MSG_EQ (item->IsMarked (), true, "The packet should carry the mark");
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (1, MakeItem (pktSize)), false, "Band 1 has no threshold");
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (2, MakeItem (pktSize)), false, "Bands 1 and 2 are not above the threshold of band 2");
+
+  bands[2]->Enqueue (MakeItem (pktSize));
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (2, MakeItem (pktSize)), true, "Bands 1 and 2 are above the threshold of band 2");
+
+  bands[0]->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (marker->GetOccupancy (0, 1), 2 * modeSize, "There should be two packets in band 0");
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (0, MakeItem (pktSize)), false, "Band 0 is back at its threshold");
+
+  marker->ClearBandThreshold (2);
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (2, MakeItem (pktSize)), false, "Band 2 has no threshold any more");
+
+  marker->Dispose ();
+  bands[1]->Dequeue ();
+  NS_TEST_EXPECT_MSG_EQ (marker->GetOccupancy (0, 3), 4 * modeSize, "A disposed marker follows no band");
+}
+
+void
+EcnMarkerTestCase::CheckSojourn (Ptr<EcnMarker> marker, Ptr<EcnMarkerTestItem> item, bool marked)
+{
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnDequeue (item), marked, "Unexpected marking decision at " << Simulator::Now ());
+}
+
+void
+EcnMarkerTestCase::RunSojournTest (void)
+{
+  Ptr<EcnMarker> marker = CreateObject<EcnMarker> ();
+  marker->SetAttribute ("MarkOnDequeue", BooleanValue (true));
+  marker->SetAttribute ("SojournThreshold", TimeValue (MicroSeconds (80)));
+  marker->SetNBands (1);
+  marker->SetBandThreshold (0, 0);
+
+  Ptr<EcnMarkerTestItem> item = MakeItem (500);
+  item->SetTimeStamp (Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (marker->MarkOnEnqueue (0, item), false, "No marking at enqueue when marking on dequeue");
+  Simulator::Schedule (MicroSeconds (50), &EcnMarkerTestCase::CheckSojourn, this, marker, item, false);
+  Simulator::Schedule (MicroSeconds (100), &EcnMarkerTestCase::CheckSojourn, this, marker, item, true);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (item->IsMarked (), true, "The packet should carry the mark");
+}
+
+void
+EcnMarkerTestCase::DoRun (void)
+{
+  RunOccupancyTest (Queue::QUEUE_MODE_PACKETS);
+  RunOccupancyTest (Queue::QUEUE_MODE_BYTES);
+  RunSojournTest ();
+  Simulator::Destroy ();
+}
+
+static class EcnMarkerTestSuite : public TestSuite
+{
+public:
+  EcnMarkerTestSuite ()
+    : TestSuite ("ecn-marker", UNIT)
+  {
+    AddTestCase (new EcnMarkerTestCase (), TestCase::QUICK);
+  }
+} g_ecnMarkerTestSuite;
@@ -74,9 +74,9 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  // 得到Ipv4XPathTag，同时去除了包中XpathTag也。
+  // 得到Ipv4XPathTag，转发前原地改写，不再移除后重新添加
   Ipv4XPathTag ipv4XPathTag;
-  bool found = packet->RemovePacketTag (ipv4XPathTag);
+  bool found = packet->PeekPacketTag (ipv4XPathTag);
   if (!found)
   {
     NS_LOG_ERROR (this << " Cannot perform XPath routing without knowing the Path ID");
@@ -87,9 +87,10 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   //得到pathId
   uint32_t pathId = ipv4XPathTag.GetPathId ();
   
-  //如果是最后一跳，则不处理
+  //如果是最后一跳，则去掉标签，不处理
   if (pathId == 0)
   {
+    packet->RemovePacketTag (ipv4XPathTag);
     NS_LOG_LOGIC (this << " Reaching final hop, XPath will not handle the final hop");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
@@ -102,10 +103,11 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   // std::cout << "Path: " << pathId << ", Current Port: " << currentPort << std::endl;
 
-  //如果端口号大于这个地址有的总端口，则报错
-  if (currentPort > m_ipv4->GetNInterfaces ())
+  //如果端口号超出这个地址有的总端口，则报错
+  if (currentPort >= m_ipv4->GetNInterfaces ())
   {
     NS_LOG_ERROR (this << " Port number error");
+    packet->RemovePacketTag (ipv4XPathTag);
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
@@ -113,20 +115,14 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   NS_LOG_LOGIC (this << " Forwarding packet: " << packet << " to port: " << currentPort);
   //将端口号组成了一个数字比如102030表示先从30端口再从20端口最后10端口，就是这样
   ipv4XPathTag.SetPathId (pathId / 100);
-  //在这里再将Tag加回
-  packet->AddPacketTag (ipv4XPathTag);
-
-  //创建路由对象并设置下一跳地址
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (currentPort);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress (nextIf, 0).GetLocal ();
+  packet->ReplacePacketTag (ipv4XPathTag);
+
+  //用该端口预先求出的下一跳创建路由对象
+  const XPathPort *port = GetPort (currentPort);
   Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (currentPort));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (currentPort, 0).GetLocal ());
+  route->SetOutputDevice (port->device);
+  route->SetGateway (port->gateway);
+  route->SetSource (port->source);
   route->SetDestination (destAddress);
 
   ucb (route, packet, header);
@@ -134,28 +130,52 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   return true;
 }
 
+//得到端口的下一跳，端口第一次被使用时从信道另一端求出
+const Ipv4XPathRouting::XPathPort *
+Ipv4XPathRouting::GetPort (uint32_t port)
+{
+  if (port >= m_ports.size ())
+  {
+    m_ports.resize (m_ipv4->GetNInterfaces ());
+  }
+  XPathPort &entry = m_ports[port];
+  if (entry.device == 0)
+  {
+    Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
+    Ptr<Channel> channel = dev->GetChannel ();
+    uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
+    Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
+    uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
+    entry.gateway = nextHop->GetObject<Ipv4>()->GetAddress (nextIf, 0).GetLocal ();
+    entry.source = m_ipv4->GetAddress (port, 0).GetLocal ();
+    entry.device = dev;
+  }
+  return &entry;
+}
+
+//接口或地址变化后，重新求出各端口的下一跳
 void
 Ipv4XPathRouting::NotifyInterfaceUp (uint32_t interface)
 {
-
+  m_ports.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyInterfaceDown (uint32_t interface)
 {
-
+  m_ports.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_ports.clear ();
 }
 
 void
 Ipv4XPathRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_ports.clear ();
 }
 
 void
@@ -176,6 +196,7 @@ void
 Ipv4XPathRouting::DoDispose (void)
 {
   m_ipv4 = 0;
+  m_ports.clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
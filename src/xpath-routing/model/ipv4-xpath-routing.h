@@ -4,7 +4,7 @@
 
 #include "ns3/ipv4-routing-protocol.h"
 
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -33,7 +33,18 @@ public:
 
 private:
 
+  //一个端口的下一跳，第一次经过该端口时求出
+  struct XPathPort
+  {
+    Ptr<NetDevice> device;
+    Ipv4Address gateway;
+    Ipv4Address source;
+  };
+
+  const XPathPort *GetPort (uint32_t port);
+
   Ptr<Ipv4> m_ipv4;
+  std::vector<XPathPort> m_ports; // 按端口号索引，device为0表示还未求出
 };
 
 }
@@ -0,0 +1,656 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Microbenchmarks of the DiffTREAT data path: the switch cache, the
+// PrioQueueDisc in front of it, the RtoPriTag classifiers and the
+// per-packet decisions of the load balancers.  Each benchmark reports
+// the wall-clock time and the heap allocations per operation, the
+// setup being left out of both; --json prints them for scripts that
+// compare two builds.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/traffic-control-module.h"
+#include "ns3/ipv4-conga-routing-helper.h"
+#include "ns3/ipv4-drill-routing-helper.h"
+#include "ns3/ipv4-letflow-routing-helper.h"
+#include "ns3/ipv4-conga-routing.h"
+#include "ns3/ipv4-drill-routing.h"
+#include "ns3/ipv4-letflow-routing.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/rto-pri-tag.h"
+#include "ns3/cache.h"
+#include "ns3/prio-queue-disc.h"
+#include "ns3/prio-queue-disc-filter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// 统计堆分配次数，共享库中的分配同样经过这里
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void *
+operator new[] (std::size_t size)
+{
+  return ::operator new (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+struct BenchParams
+{
+  uint32_t n;        // operations per benchmark
+  uint32_t discs;    // queue discs sharing the cache
+  uint32_t flows;    // flows per disc
+  uint32_t paths;    // parallel paths between the two leaves
+  uint32_t burst;    // packets per PrioQueueDisc enqueue burst
+};
+
+// Times the measured sections of one benchmark run, which may be
+// entered several times around setup work that is not measured.
+class BenchClock
+{
+public:
+  BenchClock ()
+    : m_ns (0),
+      m_allocations (0),
+      m_ops (0)
+  {
+  }
+  void Start (void)
+  {
+    m_startAllocations = g_allocations;
+    m_start = std::chrono::steady_clock::now ();
+  }
+  void Stop (uint64_t ops)
+  {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+    m_ns += std::chrono::duration_cast<std::chrono::nanoseconds> (end - m_start).count ();
+    m_allocations += g_allocations - m_startAllocations;
+    m_ops += ops;
+  }
+  uint64_t m_ns;
+  uint64_t m_allocations;
+  uint64_t m_ops;
+private:
+  std::chrono::steady_clock::time_point m_start;
+  uint64_t m_startAllocations;
+};
+
+struct BenchResult
+{
+  std::string name;
+  uint64_t ops;
+  double nsPerOp;
+  double allocationsPerOp;
+};
+
+static Ptr<Packet>
+MakePacket (uint32_t flowId, uint8_t rtoRank, uint8_t sizeRank)
+{
+  Ptr<Packet> p = Create<Packet> (1400);
+  p->AddPacketTag (FlowIdTag (flowId));
+  p->AddPacketTag (RtoPriTag (rtoRank, sizeRank));
+  return p;
+}
+
+static Ipv4Header
+MakeHeader (Ipv4Address src, Ipv4Address dst)
+{
+  Ipv4Header header;
+  header.SetSource (src);
+  header.SetDestination (dst);
+  header.SetProtocol (6);
+  header.SetTtl (64);
+  header.SetPayloadSize (1400);
+  return header;
+}
+
+/*
+ * Cache
+ */
+
+static std::vector<Ptr<QueueItem> >
+MakeCacheItems (const BenchParams &params)
+{
+  std::vector<Ptr<QueueItem> > items;
+  items.reserve (params.n);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      items.push_back (Create<QueueItem> (MakePacket ((i / params.discs) % params.flows, 2, 0)));
+    }
+  return items;
+}
+
+static void
+benchCacheEnqueue (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Cache> cache = CreateObject<Cache> ();
+  std::vector<Ptr<QueueItem> > items = MakeCacheItems (params);
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoEnqueue (i % params.discs, items[i]);
+    }
+  clock.Stop (params.n);
+}
+
+static void
+benchCachePeek (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Cache> cache = CreateObject<Cache> ();
+  std::vector<Ptr<QueueItem> > items = MakeCacheItems (params);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoEnqueue (i % params.discs, items[i]);
+    }
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoPeek (i % params.discs, (i / params.discs) % params.flows);
+    }
+  clock.Stop (params.n);
+}
+
+static void
+benchCacheDequeue (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Cache> cache = CreateObject<Cache> ();
+  std::vector<Ptr<QueueItem> > items = MakeCacheItems (params);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoEnqueue (i % params.discs, items[i]);
+    }
+  items.clear ();
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoDequeue (i % params.discs);
+    }
+  clock.Stop (params.n);
+}
+
+static void
+benchCacheDequeueFlow (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Cache> cache = CreateObject<Cache> ();
+  std::vector<Ptr<QueueItem> > items = MakeCacheItems (params);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoEnqueue (i % params.discs, items[i]);
+    }
+  items.clear ();
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      cache->DoDequeue (i % params.discs, (i / params.discs) % params.flows);
+    }
+  clock.Stop (params.n);
+}
+
+/*
+ * PrioQueueDisc in front of the cache
+ */
+
+static void
+benchPrioCache (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Cache> cache = CreateObject<Cache> ();
+  Ptr<PrioQueueDisc> disc = CreateObjectWithAttributes<PrioQueueDisc> (
+      "Mode", StringValue ("QUEUE_MODE_PACKETS"),
+      "EnableCache", BooleanValue (true),
+      "EnCacheFirst", BooleanValue (true));
+  disc->AddPacketFilter (CreateObject<PrioQueueDiscFilter> ());
+  cache->AddQueueDisc (disc);
+  disc->Initialize ();
+
+  Ipv4Header header = MakeHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.1.1"));
+  std::vector<Ptr<QueueDiscItem> > items;
+  uint32_t stuck = 0;
+  for (uint32_t sent = 0; sent < params.n; sent += params.burst)
+    {
+      uint32_t burst = std::min (params.burst, params.n - sent);
+      items.clear ();
+      for (uint32_t i = 0; i < burst; i++)
+        {
+          // 四个RTO等级轮流，缓存带(2)及其后的带占一半
+          uint32_t flow = (sent + i) % params.flows;
+          items.push_back (Create<Ipv4QueueDiscItem> (MakePacket (flow, flow % 4, 0), Address (), 0x0800, header));
+        }
+
+      clock.Start ();
+      for (uint32_t i = 0; i < burst; i++)
+        {
+          disc->Enqueue (items[i]);
+        }
+      // 写入缓存的事件跑完后再排空，缓存中的包由出队触发读回
+      Simulator::Run ();
+      while (disc->GetNPackets () > 0 || cache->GetCacheNumber () > 0)
+        {
+          if (disc->Dequeue () == 0)
+            {
+              Simulator::Run ();
+              if (disc->GetNPackets () == 0 && Simulator::IsFinished ())
+                {
+                  stuck += cache->GetCacheNumber ();
+                  break;
+                }
+            }
+        }
+      clock.Stop (burst);
+    }
+  if (stuck > 0)
+    {
+      std::cerr << "prio-cache: " << stuck << " packets left in the cache" << std::endl;
+    }
+  Simulator::Destroy ();
+}
+
+/*
+ * RtoPriTag classifiers
+ */
+
+static void
+benchClassify (Ptr<PacketFilter> filter, const BenchParams &params, BenchClock &clock)
+{
+  Ipv4Header header = MakeHeader (Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.1.1"));
+  std::vector<Ptr<QueueDiscItem> > items;
+  items.reserve (params.n);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      items.push_back (Create<Ipv4QueueDiscItem> (MakePacket (i, i % 4, i % 8), Address (), 0x0800, header));
+    }
+  int32_t sum = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      sum += filter->Classify (items[i]);
+    }
+  clock.Stop (params.n);
+  if (sum < 0)
+    {
+      std::cerr << "classify: unclassified packets" << std::endl;
+    }
+}
+
+static void
+benchClassifyRto (const BenchParams &params, BenchClock &clock)
+{
+  benchClassify (CreateObject<PrioQueueDiscFilter> (), params, clock);
+}
+
+static void
+benchClassifySize (const BenchParams &params, BenchClock &clock)
+{
+  benchClassify (CreateObject<PrioSubqueueDiscFilter> (), params, clock);
+}
+
+/*
+ * Load balancers, on the first leaf of a two-leaf fabric
+ */
+
+struct Fabric
+{
+  NodeContainer servers;
+  NodeContainer leaves;
+  NodeContainer spines;
+  Ptr<NetDevice> ingress;          // leaf 0 towards server 0
+  std::vector<uint32_t> uplinks;   // interfaces of leaf 0 towards the spines
+  Ipv4Address src;                 // server 0
+  Ipv4Address dst;                 // server 1
+  Ipv4Address dstNetwork;          // network of server 1
+};
+
+// server 0 - leaf 0 - paths x spine - leaf 1 - server 1
+static Fabric
+BuildFabric (uint32_t paths, const Ipv4RoutingHelper *routing)
+{
+  Fabric fabric;
+  fabric.servers.Create (2);
+  fabric.leaves.Create (2);
+  fabric.spines.Create (paths);
+
+  InternetStackHelper internet;
+  if (routing != 0)
+    {
+      internet.SetRoutingHelper (*routing);
+    }
+  internet.Install (fabric.servers);
+  internet.Install (fabric.leaves);
+  internet.Install (fabric.spines);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("10us"));
+  Ipv4AddressHelper address;
+
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  NetDeviceContainer devices = p2p.Install (fabric.servers.Get (0), fabric.leaves.Get (0));
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  fabric.src = interfaces.GetAddress (0);
+  fabric.ingress = devices.Get (1);
+
+  address.SetBase ("10.0.1.0", "255.255.255.0");
+  devices = p2p.Install (fabric.servers.Get (1), fabric.leaves.Get (1));
+  interfaces = address.Assign (devices);
+  fabric.dst = interfaces.GetAddress (0);
+  fabric.dstNetwork = Ipv4Address ("10.0.1.0");
+
+  address.SetBase ("10.1.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i < paths; i++)
+    {
+      for (uint32_t leaf = 0; leaf < 2; leaf++)
+        {
+          devices = p2p.Install (fabric.leaves.Get (leaf), fabric.spines.Get (i));
+          address.Assign (devices);
+          address.NewNetwork ();
+          if (leaf == 0)
+            {
+              fabric.uplinks.push_back (devices.Get (0)->GetIfIndex ());
+            }
+        }
+    }
+  return fabric;
+}
+
+static uint64_t g_routed = 0;
+
+static void
+Forward (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  g_routed++;
+}
+
+static void
+Drop (Ptr<const Packet> p, const Ipv4Header &header, Socket::SocketErrno err)
+{
+}
+
+static void
+benchRouteInput (const char *name, Ptr<Ipv4RoutingProtocol> routing, const Fabric &fabric,
+                 const BenchParams &params, BenchClock &clock)
+{
+  Ipv4Header header = MakeHeader (fabric.src, fabric.dst);
+  std::vector<Ptr<Packet> > packets;
+  packets.reserve (params.n);
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      packets.push_back (MakePacket (i % params.flows, 0, 0));
+    }
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Forward);
+  Ipv4RoutingProtocol::MulticastForwardCallback mcb;
+  Ipv4RoutingProtocol::LocalDeliverCallback lcb;
+  Ipv4RoutingProtocol::ErrorCallback ecb = MakeCallback (&Drop);
+
+  g_routed = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      routing->RouteInput (packets[i], header, fabric.ingress, ucb, mcb, lcb, ecb);
+    }
+  clock.Stop (params.n);
+  if (g_routed != params.n)
+    {
+      std::cerr << name << ": routed " << g_routed << " of " << params.n << " packets" << std::endl;
+    }
+}
+
+static void
+benchGlobalEcmp (const BenchParams &params, BenchClock &clock)
+{
+  Config::SetDefault ("ns3::Ipv4GlobalRouting::PerflowEcmpRouting", BooleanValue (true));
+  Fabric fabric = BuildFabric (params.paths, 0);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (fabric.leaves.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  Ptr<Ipv4GlobalRouting> global;
+  for (uint32_t i = 0; list != 0 && i < list->GetNRoutingProtocols (); i++)
+    {
+      int16_t priority;
+      global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+      if (global != 0)
+        {
+          break;
+        }
+    }
+  NS_ABORT_MSG_IF (global == 0, "No global routing on the leaf");
+  benchRouteInput ("global-ecmp", global, fabric, params, clock);
+  Simulator::Destroy ();
+  Config::Reset ();
+}
+
+static void
+benchConga (const BenchParams &params, BenchClock &clock)
+{
+  Ipv4CongaRoutingHelper helper;
+  Fabric fabric = BuildFabric (params.paths, &helper);
+  Ptr<Ipv4CongaRouting> conga = helper.GetCongaRouting (fabric.leaves.Get (0)->GetObject<Ipv4> ());
+  conga->SetLeafId (0);
+  conga->SetTDre (MicroSeconds (30));
+  conga->SetAlpha (0.2);
+  conga->SetLinkCapacity (DataRate ("10Gbps"));
+  conga->AddAddressToLeafIdMap (fabric.dst, 1);
+  for (uint32_t i = 0; i < fabric.uplinks.size (); i++)
+    {
+      conga->AddRoute (fabric.dstNetwork, Ipv4Mask ("255.255.255.0"), fabric.uplinks[i]);
+    }
+  benchRouteInput ("conga", conga, fabric, params, clock);
+  Simulator::Destroy ();
+}
+
+static void
+benchDrill (const BenchParams &params, BenchClock &clock)
+{
+  Ipv4DrillRoutingHelper helper;
+  Fabric fabric = BuildFabric (params.paths, &helper);
+  Ptr<Ipv4DrillRouting> drill = helper.GetDrillRouting (fabric.leaves.Get (0)->GetObject<Ipv4> ());
+  for (uint32_t i = 0; i < fabric.uplinks.size (); i++)
+    {
+      drill->AddRoute (fabric.dstNetwork, Ipv4Mask ("255.255.255.0"), fabric.uplinks[i]);
+    }
+  benchRouteInput ("drill", drill, fabric, params, clock);
+  Simulator::Destroy ();
+}
+
+static void
+benchLetFlow (const BenchParams &params, BenchClock &clock)
+{
+  Ipv4LetFlowRoutingHelper helper;
+  Fabric fabric = BuildFabric (params.paths, &helper);
+  Ptr<Ipv4LetFlowRouting> letflow = helper.GetLetFlowRouting (fabric.leaves.Get (0)->GetObject<Ipv4> ());
+  for (uint32_t i = 0; i < fabric.uplinks.size (); i++)
+    {
+      letflow->AddRoute (fabric.dstNetwork, Ipv4Mask ("255.255.255.0"), fabric.uplinks[i]);
+    }
+  benchRouteInput ("letflow", letflow, fabric, params, clock);
+  Simulator::Destroy ();
+}
+
+// TLB chooses the path at the sender instead of routing at the leaf:
+// one operation is the path lookup and the send accounting of a packet.
+static void
+benchTlb (const BenchParams &params, BenchClock &clock)
+{
+  Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+  Ipv4Address src ("10.0.0.1");
+  Ipv4Address dst ("10.0.1.1");
+  tlb->AddAddressWithTor (src, 0);
+  tlb->AddAddressWithTor (dst, 1);
+  for (uint32_t i = 0; i < params.paths; i++)
+    {
+      tlb->AddAvailPath (1, i);
+    }
+  clock.Start ();
+  for (uint32_t i = 0; i < params.n; i++)
+    {
+      uint32_t flowId = i % params.flows;
+      uint32_t path = tlb->GetPath (flowId, src, dst);
+      tlb->FlowSend (flowId, dst, path, 1400, false);
+    }
+  clock.Stop (params.n);
+  tlb->Dispose ();
+  Simulator::Destroy ();
+}
+
+static BenchResult
+runBench (void (*bench) (const BenchParams &, BenchClock &), const BenchParams &params,
+          uint32_t minIterations, const char *name)
+{
+  BenchResult result;
+  result.name = name;
+  result.ops = 0;
+  result.nsPerOp = std::numeric_limits<double>::max ();
+  result.allocationsPerOp = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      BenchClock clock;
+      (*bench) (params, clock);
+      double nsPerOp = clock.m_ops ? double (clock.m_ns) / clock.m_ops : 0;
+      if (nsPerOp < result.nsPerOp)
+        {
+          result.ops = clock.m_ops;
+          result.nsPerOp = nsPerOp;
+          result.allocationsPerOp = clock.m_ops ? double (clock.m_allocations) / clock.m_ops : 0;
+        }
+    }
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  BenchParams params;
+  params.n = 100000;
+  params.discs = 8;
+  params.flows = 64;
+  params.paths = 4;
+  params.burst = 500;
+  uint32_t minIterations = 1;
+  bool json = false;
+  std::string filter;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the DiffTREAT data path");
+  cmd.AddValue ("n", "number of operations per benchmark", params.n);
+  cmd.AddValue ("discs", "number of queue discs sharing the cache", params.discs);
+  cmd.AddValue ("flows", "number of flows per disc, and of flows through the load balancers", params.flows);
+  cmd.AddValue ("paths", "number of parallel paths of the load balancers", params.paths);
+  cmd.AddValue ("burst", "packets per PrioQueueDisc enqueue burst", params.burst);
+  cmd.AddValue ("min-iterations", "number of runs to keep the fastest of", minIterations);
+  cmd.AddValue ("filter", "only run the benchmarks whose name contains this", filter);
+  cmd.AddValue ("json", "print the results as JSON", json);
+  cmd.Parse (argc, argv);
+
+  if (params.n == 0 || params.discs == 0 || params.flows == 0 || params.paths == 0 || params.burst == 0)
+    {
+      std::cerr << "Error-- --n, --discs, --flows, --paths and --burst must be positive" << std::endl;
+      exit (1);
+    }
+
+  struct
+  {
+    const char *name;
+    void (*bench) (const BenchParams &, BenchClock &);
+  } benches[] = {
+    { "cache-enqueue", &benchCacheEnqueue },
+    { "cache-peek", &benchCachePeek },
+    { "cache-dequeue", &benchCacheDequeue },
+    { "cache-dequeue-flow", &benchCacheDequeueFlow },
+    { "prio-cache-enqueue-dequeue", &benchPrioCache },
+    { "classify-rto-rank", &benchClassifyRto },
+    { "classify-size-rank", &benchClassifySize },
+    { "global-ecmp-route-input", &benchGlobalEcmp },
+    { "conga-route-input", &benchConga },
+    { "drill-route-input", &benchDrill },
+    { "letflow-route-input", &benchLetFlow },
+    { "tlb-get-path", &benchTlb },
+  };
+
+  std::vector<BenchResult> results;
+  for (uint32_t i = 0; i < sizeof (benches) / sizeof (benches[0]); i++)
+    {
+      if (std::string (benches[i].name).find (filter) == std::string::npos)
+        {
+          continue;
+        }
+      results.push_back (runBench (benches[i].bench, params, minIterations, benches[i].name));
+      if (!json)
+        {
+          const BenchResult &r = results.back ();
+          printf ("%10.1f ns/op %8.2f allocs/op\t%s\n", r.nsPerOp, r.allocationsPerOp, r.name.c_str ());
+        }
+    }
+
+  if (json)
+    {
+      printf ("{\n  \"benchmark\": \"bench-difftreat\",\n");
+      printf ("  \"parameters\": {\"n\": %u, \"discs\": %u, \"flows\": %u, \"paths\": %u, \"burst\": %u},\n",
+              params.n, params.discs, params.flows, params.paths, params.burst);
+      printf ("  \"results\": [");
+      for (uint32_t i = 0; i < results.size (); i++)
+        {
+          printf ("%s\n    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f}",
+                  i ? "," : "", results[i].name.c_str (), (unsigned long long) results[i].ops,
+                  results[i].nsPerOp, results[i].allocationsPerOp);
+        }
+      printf ("\n  ]\n}\n");
+    }
+  return 0;
+}
@@ -302,6 +302,71 @@ benchByteTags (uint32_t n)
     }
 }
 
+// Per-hop work of Ipv4L3Protocol::Receive: private copy of the
+// received packet, then strip the IPv4 header.
+static Ptr<Packet>
+ReceiveHop (Ptr<const Packet> wire, BenchHeader<20> &ipv4)
+{
+  Ptr<Packet> p = wire->Copy ();
+  p->RemoveHeader (ipv4);
+  return p;
+}
+
+static void
+benchForwardCopy (uint32_t n)
+{
+  BenchHeader<20> ipv4;
+  BenchHeader<20> tcp;
+  BenchTag<4> flowId;
+  BenchTag<8> lbTag;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1400);
+    p->AddPacketTag (flowId);
+    p->AddPacketTag (lbTag);
+    p->AddHeader (tcp);
+    p->AddHeader (ipv4);
+    // three switch hops, each copying again in IpForward
+    for (uint32_t hop = 0; hop < 3; hop++) {
+      Ptr<Packet> rx = ReceiveHop (p, ipv4);
+      p = rx->Copy ();
+      p->AddHeader (ipv4);
+    }
+    // LocalDeliver copy, plus the copy kept for RX_ENDPOINT_UNREACH
+    Ptr<Packet> rx = ReceiveHop (p, ipv4);
+    Ptr<Packet> local = rx->Copy ();
+    Ptr<Packet> copy = local->Copy ();
+    local->RemoveHeader (tcp);
+  }
+}
+
+static void
+benchForwardTakeOver (uint32_t n)
+{
+  BenchHeader<20> ipv4;
+  BenchHeader<20> tcp;
+  BenchTag<4> flowId;
+  BenchTag<8> lbTag;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (1400);
+    p->AddPacketTag (flowId);
+    p->AddPacketTag (lbTag);
+    p->AddHeader (tcp);
+    p->AddHeader (ipv4);
+    // three switch hops, IpForward reuses the received copy
+    for (uint32_t hop = 0; hop < 3; hop++) {
+      p = ReceiveHop (p, ipv4);
+      p->AddHeader (ipv4);
+    }
+    // LocalDeliver reuses it too and only saves 8 bytes for ICMP
+    Ptr<Packet> local = ReceiveHop (p, ipv4);
+    uint8_t orgData[8];
+    local->CopyData (orgData, 8);
+    local->RemoveHeader (tcp);
+  }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -359,6 +424,8 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchForwardCopy, n, minIterations, "3-hop forward, copy per hop");
+  runBench (&benchForwardTakeOver, n, minIterations, "3-hop forward, take over received copy");
 
   return 0;
 }
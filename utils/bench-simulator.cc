@@ -23,6 +23,7 @@
 #include <fstream>
 #include <vector>
 #include <string.h>
+#include <stdlib.h>
 
 #include "ns3/core-module.h"
 
@@ -178,11 +179,138 @@ GetRandomStream (std::string filename)
 }
 
 
+/** One scheduler operation from a RecordingScheduler trace. */
+struct SchedulerOp
+{
+  char type;      //!< 'i' for Insert, 'r' for RemoveNext, 'x' for Remove
+  uint64_t ts;    //!< Event timestamp
+  uint32_t uid;   //!< Event uid
+};
+
+std::vector<SchedulerOp>
+ReadSchedulerOps (std::string filename)
+{
+  std::ifstream input (filename.c_str ());
+  if (!input)
+    {
+      LOGME ("could not open " << filename);
+      exit (1);
+    }
+  std::vector<SchedulerOp> ops;
+  SchedulerOp op;
+  while (input >> op.type)
+    {
+      op.ts = 0;
+      op.uid = 0;
+      if (op.type == 'i' || op.type == 'x')
+        {
+          input >> op.ts >> op.uid;
+        }
+      ops.push_back (op);
+    }
+  LOGME ("found " << ops.size () << " scheduler operations in " << filename);
+  return ops;
+}
+
+void
+Noop (void)
+{
+}
+
+double
+ReplaySchedulerOps (std::string schedulerType, const std::vector<SchedulerOp> &ops)
+{
+  ObjectFactory factory (schedulerType);
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  EventImpl *impl = MakeEvent (&Noop);
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<SchedulerOp>::const_iterator i = ops.begin (); i != ops.end (); ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = impl;
+      ev.key.m_ts = i->ts;
+      ev.key.m_uid = i->uid;
+      ev.key.m_context = 0;
+      switch (i->type)
+        {
+        case 'i':
+          scheduler->Insert (ev);
+          break;
+        case 'r':
+          scheduler->RemoveNext ();
+          break;
+        case 'x':
+          scheduler->Remove (ev);
+          break;
+        }
+    }
+  double elapsed = time.End ();
+  elapsed /= 1000;
+
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+    }
+  impl->Unref ();
+  return elapsed;
+}
+
+void
+RunReplay (std::string filename, uint32_t runs)
+{
+  std::vector<SchedulerOp> ops = ReadSchedulerOps (filename);
+  std::string schedulerTypes[] = {
+    "ns3::ListScheduler",
+    "ns3::HeapScheduler",
+    "ns3::MapScheduler",
+    "ns3::CalendarScheduler",
+    "ns3::AdaptiveCalendarScheduler"
+  };
+  uint32_t nTypes = sizeof (schedulerTypes) / sizeof (schedulerTypes[0]);
+
+  LOG ("");
+  LOG (std::left << std::setw (32) << "Scheduler" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (op/s)");
+  std::string best;
+  double bestTime = 0;
+  for (uint32_t i = 0; i < nTypes; ++i)
+    {
+      if (schedulerTypes[i] == "ns3::ListScheduler" && ops.size () > 1000000)
+        {
+          // quadratic on large populations, do not wait for it.
+          continue;
+        }
+      double minTime = 0;
+      for (uint32_t run = 0; run < runs; ++run)
+        {
+          double t = ReplaySchedulerOps (schedulerTypes[i], ops);
+          if (run == 0 || t < minTime)
+            {
+              minTime = t;
+            }
+        }
+      LOG (std::left << std::setw (32) << schedulerTypes[i] <<
+           std::left << std::setw (g_fwidth) << minTime <<
+           std::left << std::setw (g_fwidth) << (ops.size () / minTime));
+      if (best == "" || minTime < bestTime)
+        {
+          best = schedulerTypes[i];
+          bestTime = minTime;
+        }
+    }
+  LOG ("");
+  LOGME ("fastest scheduler for this trace: " << best);
+}
+
 
 int main (int argc, char *argv[])
 {
 
   bool schedCal  = false;
+  bool schedAcal = false;
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
@@ -191,6 +319,7 @@ int main (int argc, char *argv[])
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string replay = "";
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -200,8 +329,13 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --replay=\"<filename>\", the scheduler operations recorded\n"
+             "by ns3::RecordingScheduler are replayed against every scheduler\n"
+             "and the fastest one is reported.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
+  cmd.AddValue ("acal",  "use AdaptiveCalendarSheduler",  schedAcal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
@@ -211,12 +345,21 @@ int main (int argc, char *argv[])
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("replay", "file of recorded scheduler operations", replay);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
+  if (replay != "")
+    {
+      LOGME (std::setprecision (g_fwidth - 6));
+      RunReplay (replay, runs);
+      return 0;
+    }
+
   ObjectFactory factory ("ns3::MapScheduler");
   if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
+  if (schedAcal) { factory.SetTypeId ("ns3::AdaptiveCalendarScheduler"); }
   if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
   if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
   Simulator::SetScheduler (factory);
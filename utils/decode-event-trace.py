@@ -0,0 +1,78 @@
+#!/usr/bin/env python
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Decode the binary records written by NS_EVENT_TRACE (see
+# src/core/model/event-trace.h) into one line per event:
+#
+#   time(ns) thread context component event value...
+#
+# usage: decode-event-trace.py [--sort] [--filter component[:event]] file
+
+import struct
+import sys
+
+CHUNK_NAME = 1
+CHUNK_RECORDS = 2
+RECORD = struct.Struct('=qIHH4I')
+
+
+def read_events(f):
+    if f.read(8) != b'NS3EVTR1':
+        raise ValueError('not an event trace file')
+    names = {}
+    while True:
+        header = f.read(8)
+        if len(header) < 8:
+            return
+        kind, size = struct.unpack('=II', header)
+        payload = f.read(size)
+        if len(payload) < size:
+            return
+        if kind == CHUNK_NAME:
+            (event_id,) = struct.unpack_from('=I', payload)
+            component, event = payload[4:].decode('utf-8').split('\0')[:2]
+            names[event_id] = (component, event)
+        elif kind == CHUNK_RECORDS:
+            thread, count = struct.unpack_from('=II', payload)
+            for i in range(count):
+                time, context, event_id, n, a, b, c, d = \
+                    RECORD.unpack_from(payload, 8 + i * RECORD.size)
+                component, event = names.get(event_id, ('?', str(event_id)))
+                yield (time, thread, context, component, event, (a, b, c, d)[:n])
+
+
+def main(argv):
+    sort = False
+    wanted = None
+    args = []
+    i = 1
+    while i < len(argv):
+        if argv[i] == '--sort':
+            sort = True
+        elif argv[i] == '--filter' and i + 1 < len(argv):
+            i += 1
+            wanted = tuple(argv[i].split(':', 1))
+        else:
+            args.append(argv[i])
+        i += 1
+    if len(args) != 1:
+        sys.stderr.write('usage: %s [--sort] [--filter component[:event]] file\n' % argv[0])
+        return 1
+
+    with open(args[0], 'rb') as f:
+        events = read_events(f)
+        if wanted is not None:
+            events = (e for e in events if (e[3], e[4])[:len(wanted)] == wanted)
+        if sort:
+            # 各线程的缓冲区分块写出，按时间重排
+            events = sorted(events, key=lambda e: e[0])
+        context_none = 0xffffffff
+        for time, thread, context, component, event, values in events:
+            context = '-' if context == context_none else str(context)
+            sys.stdout.write('%d %d %s %s %s %s\n' % (time, thread, context, component, event,
+                                                      ' '.join(str(v) for v in values)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))